@@ -0,0 +1,193 @@
+#include "ai_driver.h"
+#include "driver.h" // getCenterlineSamples
+#include "sim_math.h" // M_PI, RAD_TO_DEG
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// --- Racing Line Settings ---
+#define LINE_RELAX_ITERATIONS 400   // Smoothing passes over the centerline
+#define LINE_RELAX_STEP 0.5f        // Fraction of the way each point moves towards its neighbours' midpoint per pass
+#define LINE_EDGE_MARGIN 0.8f       // Road kept clear beyond the car's corners
+#define LINE_CURVATURE_WINDOW 3     // Points either side averaged for the curvature
+#define LINE_TURN_MARGIN 0.8f       // Fraction of the car's turn rate the line may ask for
+#define LINE_BRAKE_MARGIN 0.7f      // Fraction of the braking rate used to plan braking points
+#define LINE_MIN_SPEED 4.0f
+#define LINE_SPEED_STEP 0.1f        // Resolution of the target speed search
+
+// --- Controller Settings ---
+#define AI_SEARCH_WINDOW 8           // Points searched either side of the hint
+#define AI_STEER_LOOKAHEAD 4         // Points ahead used as the steering target when stopped...
+#define AI_STEER_LOOKAHEAD_PER_SPEED 0.2f // ...plus this many per unit of speed
+#define AI_SPEED_LOOKAHEAD 2         // Points ahead whose target speed is driven to
+#define AI_STEER_DEADZONE 0.035f     // sin(2 degrees): heading error ignored to avoid oscillation
+#define AI_BRAKE_HYSTERESIS 0.5f     // Speed above the target before braking
+
+// Is the whole disc of 'radius' round (x, z) on the road? Checked at eight
+// points on its edge, which is enough for the road widths used.
+static int isDiscOnTrack(const SimTrack* track, float x, float z, float radius) {
+    float d = radius * 0.70710678f;
+    return isPositionOnTrack(track, x + radius, z) && isPositionOnTrack(track, x - radius, z) &&
+           isPositionOnTrack(track, x, z + radius) && isPositionOnTrack(track, x, z - radius) &&
+           isPositionOnTrack(track, x + d, z + d) && isPositionOnTrack(track, x + d, z - d) &&
+           isPositionOnTrack(track, x - d, z + d) && isPositionOnTrack(track, x - d, z - d);
+}
+
+// Fastest speed at which the car can turn at 'curvature' (radians per unit),
+// using the same speed-dependent turn rate as updateCar.
+static float getCornerSpeed(const Car* tuning, float curvature) {
+    for (float v = tuning->max_speed; v > LINE_MIN_SPEED; v -= LINE_SPEED_STEP) {
+        float turnRate = tuning->turn_speed; // Degrees per second
+        if (v > 1.0f) {
+            float factor = 1.0f - (fmaxf(0.0f, v - tuning->max_speed * 0.3f) / (tuning->max_speed * 0.7f));
+            turnRate *= fmaxf(0.15f, factor);
+        }
+        if (v * curvature * (float)RAD_TO_DEG(1.0f) <= turnRate * LINE_TURN_MARGIN) return v;
+    }
+    return LINE_MIN_SPEED;
+}
+
+// --- Racing Line Construction ---
+int buildRacingLine(RacingLine* line, const SimTrack* track, const Car* tuning) {
+    memset(line, 0, sizeof(*line));
+    int n = getCenterlineSamples(track, NULL, NULL, 0);
+    if (n < 3) return 0; // Custom track not loaded
+
+    float* block = (float*)malloc((size_t)n * 3 * sizeof(float));
+    float* scratch = (float*)malloc((size_t)n * 3 * sizeof(float)); // Centerline x/z, then per-point turn angle
+    if (!block || !scratch) { free(block); free(scratch); return 0; }
+    line->x = block;
+    line->z = block + n;
+    line->target_speed = block + 2 * n;
+    float* cx = scratch;
+    float* cz = scratch + n;
+    float* turn = scratch + 2 * n;
+    getCenterlineSamples(track, cx, cz, n);
+    memcpy(line->x, cx, (size_t)n * sizeof(float));
+    memcpy(line->z, cz, (size_t)n * sizeof(float));
+
+    // --- Shape: relax the centerline ---
+    // Pulling each point towards its neighbours' midpoint straightens the path,
+    // which moves it to the inside of corners and takes them wider. A move is
+    // only kept if the car would still fit on the road there.
+    float clearance = sqrtf(tuning->width * tuning->width + tuning->length * tuning->length) / 2.0f + LINE_EDGE_MARGIN;
+    SimTrack road; // The track with the default rules
+    initSimTrack(&road, track->type);
+    road.data = track->data;
+    for (int iter = 0; iter < LINE_RELAX_ITERATIONS; ++iter) {
+        for (int i = 0; i < n; ++i) {
+            int prev = (i + n - 1) % n, next = (i + 1) % n;
+            float mx = (line->x[prev] + line->x[next]) * 0.5f;
+            float mz = (line->z[prev] + line->z[next]) * 0.5f;
+            float nx = line->x[i] + (mx - line->x[i]) * LINE_RELAX_STEP;
+            float nz = line->z[i] + (mz - line->z[i]) * LINE_RELAX_STEP;
+            if (isDiscOnTrack(&road, nx, nz, clearance)) {
+                line->x[i] = nx;
+                line->z[i] = nz;
+            }
+        }
+    }
+
+    // --- Speed: corner limit from curvature ---
+    for (int i = 0; i < n; ++i) {
+        int prev = (i + n - 1) % n, next = (i + 1) % n;
+        float h1 = atan2f(line->x[i] - line->x[prev], line->z[i] - line->z[prev]);
+        float h2 = atan2f(line->x[next] - line->x[i], line->z[next] - line->z[i]);
+        float d = h2 - h1;
+        if (d > (float)M_PI) d -= 2.0f * (float)M_PI;
+        else if (d < -(float)M_PI) d += 2.0f * (float)M_PI;
+        turn[i] = fabsf(d);
+    }
+    for (int i = 0; i < n; ++i) {
+        float angle = 0.0f, length = 0.0f;
+        for (int k = -LINE_CURVATURE_WINDOW; k <= LINE_CURVATURE_WINDOW; ++k) {
+            int j = ((i + k) % n + n) % n, next = (j + 1) % n;
+            angle += turn[j];
+            length += hypotf(line->x[next] - line->x[j], line->z[next] - line->z[j]);
+        }
+        line->target_speed[i] = getCornerSpeed(tuning, length > 0.0f ? angle / length : 0.0f);
+    }
+
+    // --- Speed: braking points ---
+    // Walk backwards (twice, since the line is closed) so every point is slow
+    // enough to brake down to the limit of the points after it.
+    float decel = tuning->braking_rate * LINE_BRAKE_MARGIN;
+    for (int k = 2 * n - 1; k >= 0; --k) {
+        int i = k % n, next = (i + 1) % n;
+        float ds = hypotf(line->x[next] - line->x[i], line->z[next] - line->z[i]);
+        float reachable = sqrtf(line->target_speed[next] * line->target_speed[next] + 2.0f * decel * ds);
+        if (reachable < line->target_speed[i]) line->target_speed[i] = reachable;
+    }
+
+    free(scratch);
+    line->track = track->type;
+    line->count = n;
+    line->storage = block;
+    return 1;
+}
+
+void freeRacingLine(RacingLine* line) {
+    free(line->storage);
+    memset(line, 0, sizeof(*line));
+}
+
+
+// --- Controller ---
+void initAIDriver(AIDriver* driver, const RacingLine* line, float x, float z) {
+    int best = 0;
+    float bestDistSq = 1e30f;
+    for (int i = 0; i < line->count; ++i) {
+        float dx = line->x[i] - x, dz = line->z[i] - z;
+        float d = dx * dx + dz * dz;
+        if (d < bestDistSq) { bestDistSq = d; best = i; }
+    }
+    driver->lineIndex = best;
+}
+
+// Control bits for one car. Steering compares the direction to a point ahead
+// on the line with the car's heading through a cross product, using the
+// heading's sine and cosine the car already keeps (no trigonometry here).
+static unsigned char driveCar(int* lineIndex, const RacingLine* line, float x, float z,
+                              float sinA, float cosA, float speed) {
+    int n = line->count;
+    if (n == 0) return 0;
+
+    // Track the nearest point with a local search around the previous one.
+    int best = *lineIndex;
+    float bestDistSq = 1e30f;
+    for (int k = -AI_SEARCH_WINDOW; k <= AI_SEARCH_WINDOW; ++k) {
+        int i = ((*lineIndex + k) % n + n) % n;
+        float dx = line->x[i] - x, dz = line->z[i] - z;
+        float d = dx * dx + dz * dz;
+        if (d < bestDistSq) { bestDistSq = d; best = i; }
+    }
+    *lineIndex = best;
+
+    // --- Steering ---
+    int target = (best + AI_STEER_LOOKAHEAD + (int)(fabsf(speed) * AI_STEER_LOOKAHEAD_PER_SPEED)) % n;
+    float dx = line->x[target] - x, dz = line->z[target] - z;
+    float side = dx * cosA - dz * sinA;  // > 0: target is to the left (turning left increases the angle)
+    float ahead = dx * sinA + dz * cosA;
+    float deadzone = sqrtf(dx * dx + dz * dz) * AI_STEER_DEADZONE;
+    unsigned char bits = 0;
+    if (side > deadzone || (ahead < 0.0f && side >= 0.0f)) bits |= CAR_CONTROL_TURN_LEFT;
+    else if (side < -deadzone || ahead < 0.0f) bits |= CAR_CONTROL_TURN_RIGHT;
+
+    // --- Throttle ---
+    float targetSpeed = line->target_speed[(best + AI_SPEED_LOOKAHEAD) % n];
+    if (speed < targetSpeed) bits |= CAR_CONTROL_ACCELERATE;
+    else if (speed > targetSpeed + AI_BRAKE_HYSTERESIS) bits |= CAR_CONTROL_BRAKE;
+    return bits;
+}
+
+void updateAIDriver(AIDriver* driver, const RacingLine* line, Car* car) {
+    setCarControlBits(car, driveCar(&driver->lineIndex, line, car->x, car->z,
+                                    car->heading_sin, car->heading_cos, car->speed));
+}
+
+void updateAIDriverBatch(AIDriver* drivers, const RacingLine* line, CarBatch* batch) {
+    for (int i = 0; i < batch->count; ++i) {
+        batch->controls[i] = driveCar(&drivers[i].lineIndex, line, batch->x[i], batch->z[i],
+                                      batch->sin_a[i], batch->cos_a[i], batch->speed[i]);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef AI_DRIVER_H
+#define AI_DRIVER_H
+
+#include "sim.h"       // Car struct and SimTrack
+#include "car_batch.h" // CarBatch
+
+// --- Racing Line ---
+// A path round the track built once per track and car tuning: the centerline
+// relaxed towards the inside of the corners (as far as the road allows) and a
+// target speed at every point. The target speed is the fastest the car's
+// turn rate can follow the line's curvature, lowered ahead of each corner so
+// the car can brake down to it in time.
+typedef struct {
+    TrackType track;
+    int count;            // Points on the line (it is closed: the last connects to the first)
+    float* x;
+    float* z;
+    float* target_speed;  // Units per second at each point
+    void* storage;        // Single allocation backing the arrays above
+} RacingLine;
+
+// 'tuning' supplies the car's speed, braking, turn rate and dimensions (e.g.
+// a car set up by initCar). Returns 1 on success.
+int buildRacingLine(RacingLine* line, const SimTrack* track, const Car* tuning);
+void freeRacingLine(RacingLine* line);
+
+// --- AI Driver ---
+// Per-car controller state. The controller only sets the car's control flags
+// (accelerating/braking/turning_*); physics is still done by updateCar or
+// updateCarBatch. It costs a short local search and no trigonometry beyond
+// the car's heading, so hundreds of cars can be driven every tick.
+typedef struct {
+    int lineIndex; // Nearest racing line point (search hint)
+} AIDriver;
+
+void initAIDriver(AIDriver* driver, const RacingLine* line, float x, float z);
+void updateAIDriver(AIDriver* driver, const RacingLine* line, Car* car);
+// Drives every car in a batch (drivers[i] controls car i): writes batch->controls.
+void updateAIDriverBatch(AIDriver* drivers, const RacingLine* line, CarBatch* batch);
+
+#endif // AI_DRIVER_H
@@ -0,0 +1,348 @@
+// Microbenchmarks.
+// Times the hot paths of the simulation so performance changes to car.c, the
+// track collision code or the track files can be judged against a baseline:
+//   - calculateCarCorners, the analytic on-track tests and the distance grid
+//   - the four-corner collision kernel
+//   - track progress lookups
+//   - updateCar replaying a recorded autopilot input trace
+//   - full headless laps
+//   - car-to-car contacts for a 200-car field
+//   - standings updates for a 1000-car field
+// Each benchmark runs a few untimed warm-up repetitions, then a fixed number
+// of timed ones; the median and the fastest repetition are reported.
+// Run with 'make bench'.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim.h"
+#include "driver.h"
+#include "platform.h"          // getPlatformTimeSeconds
+#include "track_rect.h"
+#include "track_round.h"
+#include "track_grid.h"
+#include "track_progress.h"
+#include "corner_collision.h"
+#include "car_batch.h"
+#include "car_contact.h"
+#include "standings.h"
+#include "snapshot.h"
+#include "sim_math.h"        // getHeadingSinCos, for the precomputed headings
+
+#define BENCH_POINT_COUNT 4096       // Query points per repetition
+#define BENCH_POINT_PASSES 64        // Passes over the points per repetition
+#define BENCH_TRACE_TICKS (60 * 60)  // Recorded input trace: one minute at 60 Hz
+#define BENCH_TRACE_PASSES 16        // Trace replays per repetition
+#define BENCH_LAPS 20                // Laps per repetition of the lap benchmark
+#define BENCH_FIELD_CARS 200         // Cars in the contact benchmark
+#define BENCH_FIELD_PASSES 64        // Contact passes per repetition
+#define BENCH_STANDINGS_CARS 1000    // Cars in the standings benchmark
+#define BENCH_STANDINGS_TICKS 64     // Ticks of recorded positions per repetition
+#define BENCH_SNAPSHOT_PASSES 4096   // Save/restore pairs per repetition
+#define BENCH_WARMUP_REPS 2
+#define BENCH_DEFAULT_REPS 9
+#define BENCH_TICK_SEC (1.0f / SIM_DEFAULT_TICK_RATE)
+
+// --- Inputs ---
+static float pointX[BENCH_POINT_COUNT], pointZ[BENCH_POINT_COUNT];
+static float pointSin[BENCH_POINT_COUNT], pointCos[BENCH_POINT_COUNT]; // Heading, as a Car caches it
+static unsigned char traceControls[BENCH_TRACE_TICKS];
+static Car fieldCars[BENCH_FIELD_CARS]; // Spread round the rounded track, some overlapping
+static CarBatch fieldBatch;
+static CarContactGrid fieldContacts;
+static float standingsX[BENCH_STANDINGS_TICKS][BENCH_STANDINGS_CARS]; // Positions per tick
+static float standingsZ[BENCH_STANDINGS_TICKS][BENCH_STANDINGS_CARS];
+static SimTrack roundTrack;  // The rounded track with the default rules
+static SimContext snapshotSim;           // Race saved and restored with the contact field
+static unsigned char* snapshotBuffer;    // One snapshot of it
+static volatile double sink; // Keeps results live so the work is not optimized away
+
+// Fixed-seed generator so every run queries the same points.
+static unsigned int benchRandomState = 12345u;
+static float randomRange(float lo, float hi) {
+    benchRandomState = benchRandomState * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(benchRandomState >> 8) / 16777216.0f;
+}
+
+// Points over the track bounds plus a margin, so both on- and off-track
+// answers (and every branch of the analytic tests) are exercised.
+static void makePoints(void) {
+    for (int i = 0; i < BENCH_POINT_COUNT; ++i) {
+        pointX[i] = randomRange(RECT_OUTER_X_NEG - 5.0f, RECT_OUTER_X_POS + 5.0f);
+        pointZ[i] = randomRange(RECT_OUTER_Z_NEG - 5.0f, RECT_OUTER_Z_POS + 5.0f);
+        getHeadingSinCos(randomRange(0.0f, 360.0f), &pointSin[i], &pointCos[i]);
+    }
+}
+
+// Records the autopilot's controls for one minute on the rounded track.
+static void recordTrace(void) {
+    Car car;
+    initCar(&car, &roundTrack);
+    Autopilot pilot;
+    initAutopilot(&pilot, &roundTrack, &car);
+    for (int tick = 0; tick < BENCH_TRACE_TICKS; ++tick) {
+        updateAutopilot(&pilot, &car);
+        traceControls[tick] = getCarControlBits(&car);
+        updateCar(&car, &roundTrack, BENCH_TICK_SEC);
+    }
+}
+
+// Places the contact benchmark's field at random points along the rounded
+// track's centerline, a few units either side of it.
+static void makeField(void) {
+    float xs[1024], zs[1024];
+    int n = getCenterlineSamples(&roundTrack, xs, zs, 1024);
+    if (n > 1024) n = 1024;
+    Car car;
+    initCar(&car, &roundTrack);
+    for (int i = 0; i < BENCH_FIELD_CARS; ++i) {
+        int s = (int)randomRange(0.0f, (float)n) % n;
+        fieldCars[i] = car;
+        fieldCars[i].x = xs[s] + randomRange(-3.0f, 3.0f);
+        fieldCars[i].z = zs[s] + randomRange(-3.0f, 3.0f);
+        setCarAngle(&fieldCars[i], randomRange(0.0f, 360.0f));
+        fieldCars[i].speed = 20.0f;
+    }
+    initCarBatch(&fieldBatch, BENCH_FIELD_CARS, &roundTrack, &car);
+    for (int i = 0; i < BENCH_FIELD_CARS; ++i) addCarToBatch(&fieldBatch, &fieldCars[i]);
+    initCarContactGrid(&fieldContacts, BENCH_FIELD_CARS, &car);
+}
+
+// A field spread over one lap of the rounded track, driving at different
+// speeds so that some places change every tick.
+static void makeStandingsField(void) {
+    const TrackProgress* progress = getTrackProgress(&roundTrack);
+    for (int i = 0; i < BENCH_STANDINGS_CARS; ++i) {
+        float start = randomRange(0.0f, progress->length);
+        float perTick = randomRange(20.0f, 40.0f) * BENCH_TICK_SEC;
+        for (int t = 0; t < BENCH_STANDINGS_TICKS; ++t) {
+            getTrackProgressPoint(progress, start + perTick * t, &standingsX[t][i], &standingsZ[t][i]);
+        }
+    }
+}
+
+// --- Benchmarks ---
+// Each does one repetition of work and returns the number of operations done.
+static long long benchCarCorners(void) {
+    double sum = 0.0;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) {
+            float c[8];
+            calculateCarCorners(pointX[i], pointZ[i], pointSin[i], pointCos[i], 2.0f, 4.0f,
+                                &c[0], &c[1], &c[2], &c[3], &c[4], &c[5], &c[6], &c[7]);
+            sum += c[0] + c[7];
+        }
+    }
+    sink = sum;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchRectTrack(void) {
+    int hits = 0;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) hits += isPositionOnRectTrack(pointX[i], pointZ[i]);
+    }
+    sink = hits;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchRoundTrack(void) {
+    int hits = 0;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) hits += isPositionOnRoundTrack(pointX[i], pointZ[i]);
+    }
+    sink = hits;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchRoundGrid(void) {
+    const TrackGrid* grid = getTrackGrid(&roundTrack);
+    int hits = 0;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) hits += isPositionOnTrackGrid(grid, pointX[i], pointZ[i]);
+    }
+    sink = hits;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchTrackProgress(void) {
+    const TrackProgress* progress = getTrackProgress(&roundTrack);
+    float sum = 0.0f;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) sum += sampleTrackProgress(progress, pointX[i], pointZ[i]);
+    }
+    sink = sum;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchCornerKernel(void) {
+    int hits = 0;
+    for (int pass = 0; pass < BENCH_POINT_PASSES; ++pass) {
+        for (int i = 0; i < BENCH_POINT_COUNT; ++i) {
+            hits += areCarCornersOnTrack(&roundTrack, pointX[i], pointZ[i], pointSin[i], pointCos[i], 1.0f, 2.0f);
+        }
+    }
+    sink = hits;
+    return (long long)BENCH_POINT_PASSES * BENCH_POINT_COUNT;
+}
+
+static long long benchUpdateCarTrace(void) {
+    double sum = 0.0;
+    for (int pass = 0; pass < BENCH_TRACE_PASSES; ++pass) {
+        Car car;
+        initCar(&car, &roundTrack);
+        for (int tick = 0; tick < BENCH_TRACE_TICKS; ++tick) {
+            setCarControlBits(&car, traceControls[tick]);
+            updateCar(&car, &roundTrack, BENCH_TICK_SEC);
+        }
+        sum += car.x + car.z;
+    }
+    sink = sum;
+    return (long long)BENCH_TRACE_PASSES * BENCH_TRACE_TICKS;
+}
+
+static long long benchHeadlessLaps(void) {
+    SimContext sim;
+    initSimContext(&sim, TRACK_ROUNDED, SIM_DEFAULT_TICK_RATE);
+    initRace(&sim);
+    Autopilot pilot;
+    initAutopilot(&pilot, &sim.track, &sim.car);
+    long long maxTicks = (long long)BENCH_LAPS * 60 * SIM_DEFAULT_TICK_RATE;
+    while (sim.laps_completed < BENCH_LAPS && sim.ticks < maxTicks) {
+        updateAutopilot(&pilot, &sim.car);
+        updateRace(&sim);
+    }
+    sink = sim.best_lap_time_ms;
+    return sim.laps_completed;
+}
+
+// Ops are cars: the cost per car of one contact pass over the field.
+static long long benchCarContacts(void) {
+    int contacts = 0;
+    for (int pass = 0; pass < BENCH_FIELD_PASSES; ++pass) {
+        fieldBatch.count = 0;
+        for (int i = 0; i < BENCH_FIELD_CARS; ++i) addCarToBatch(&fieldBatch, &fieldCars[i]);
+        contacts += resolveCarContacts(&fieldContacts, &fieldBatch, NULL, 0);
+    }
+    sink = contacts;
+    return (long long)BENCH_FIELD_PASSES * BENCH_FIELD_CARS;
+}
+
+static long long benchStandings(void) {
+    Standings standings;
+    initStandings(&standings, BENCH_STANDINGS_CARS, getTrackProgress(&roundTrack));
+    for (int i = 0; i < BENCH_STANDINGS_CARS; ++i) addStandingsEntry(&standings, standingsX[0][i], standingsZ[0][i]);
+    sortStandings(&standings);
+    for (int t = 1; t < BENCH_STANDINGS_TICKS; ++t) {
+        updateStandingsEntries(&standings, 0, BENCH_STANDINGS_CARS, standingsX[t], standingsZ[t], t * 1000 / SIM_DEFAULT_TICK_RATE);
+        sortStandings(&standings);
+    }
+    sink = standings.order[0];
+    freeStandings(&standings);
+    return (long long)(BENCH_STANDINGS_TICKS - 1) * BENCH_STANDINGS_CARS;
+}
+
+// Ops are save/restore pairs of a race with the 200-car contact field.
+static long long benchSnapshot(void) {
+    SimState state = { &snapshotSim, &fieldBatch, NULL, NULL };
+    long long restored = 0;
+    for (int pass = 0; pass < BENCH_SNAPSHOT_PASSES; ++pass) {
+        saveSimSnapshot(&state, snapshotBuffer);
+        restored += restoreSimSnapshot(&state, snapshotBuffer);
+    }
+    sink = (double)restored;
+    return BENCH_SNAPSHOT_PASSES;
+}
+
+typedef struct {
+    const char* name;
+    long long (*run)(void);
+    int perSecond; // Report operations per second (laps) instead of ns per operation
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"calculateCarCorners",      benchCarCorners,     0},
+    {"isPositionOnRectTrack",    benchRectTrack,      0},
+    {"isPositionOnRoundTrack",   benchRoundTrack,     0},
+    {"isPositionOnTrackGrid",    benchRoundGrid,      0},
+    {"sampleTrackProgress",      benchTrackProgress,  0},
+    {"areCarCornersOnTrack",     benchCornerKernel,   0},
+    {"updateCar (input trace)",  benchUpdateCarTrace, 0},
+    {"headless laps (round)",    benchHeadlessLaps,   1},
+    {"resolveCarContacts (200)", benchCarContacts,    0},
+    {"standings tick (1000)",    benchStandings,      0},
+    {"snapshot save+restore (200)", benchSnapshot,    0},
+};
+#define BENCHMARK_COUNT ((int)(sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+static int compareDoubles(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Runs one benchmark and prints its line. Times are per operation.
+static void runBenchmark(const Benchmark* bench, int reps) {
+    double* perOp = (double*)malloc(sizeof(double) * reps);
+    if (!perOp) return;
+    for (int i = 0; i < BENCH_WARMUP_REPS; ++i) bench->run();
+    long long ops = 0;
+    for (int i = 0; i < reps; ++i) {
+        double start = getPlatformTimeSeconds();
+        ops = bench->run();
+        double seconds = getPlatformTimeSeconds() - start;
+        perOp[i] = (ops > 0) ? seconds / (double)ops : 0.0;
+    }
+    qsort(perOp, (size_t)reps, sizeof(double), compareDoubles);
+    double median = perOp[reps / 2], best = perOp[0];
+    if (bench->perSecond) {
+        printf("%-26s %12.1f laps/s  (best %.1f)\n", bench->name,
+               median > 0.0 ? 1.0 / median : 0.0, best > 0.0 ? 1.0 / best : 0.0);
+    } else {
+        printf("%-26s %12.2f ns/op   (best %.2f, %lld ops/rep)\n", bench->name, median * 1e9, best * 1e9, ops);
+    }
+    free(perOp);
+}
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [--reps N] [--filter TEXT]\n", prog);
+    printf("  --reps    Timed repetitions per benchmark (default: %d, after %d warm-up)\n",
+           BENCH_DEFAULT_REPS, BENCH_WARMUP_REPS);
+    printf("  --filter  Only run benchmarks whose name contains TEXT\n");
+}
+
+int main(int argc, char** argv) {
+    int reps = BENCH_DEFAULT_REPS;
+    const char* filter = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+            if (reps < 1) reps = 1;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    initSimTrack(&roundTrack, TRACK_ROUNDED);
+    makePoints();
+    recordTrace();
+    makeField();
+    initSimContext(&snapshotSim, TRACK_ROUNDED, SIM_DEFAULT_TICK_RATE);
+    initRace(&snapshotSim);
+    SimState snapshotState = { &snapshotSim, &fieldBatch, NULL, NULL };
+    snapshotBuffer = (unsigned char*)malloc(getSimSnapshotSize(&snapshotState)); // Sized for the full field
+    if (!snapshotBuffer) return 1;
+    getTrackGrid(&roundTrack); // Build the grid and progress table before timing anything
+    getTrackProgress(&roundTrack);
+    makeStandingsField();
+
+    printf("Benchmarks: median of %d repetitions (after %d warm-up)\n", reps, BENCH_WARMUP_REPS);
+    for (int b = 0; b < BENCHMARK_COUNT; ++b) {
+        if (filter && !strstr(benchmarks[b].name, filter)) continue;
+        runBenchmark(&benchmarks[b], reps);
+    }
+    return 0;
+}
@@ -1,43 +1,45 @@
 #include "car.h"      // Defines the Car struct and function prototypes
 #include "track_rect.h"  // Defines rectangle track boundaries
 #include "track_round.h" // Defines rounded track boundaries
-#include "game.h"     // Defines selectedTrackType and TrackType enum
-
-#include <GL/glew.h>     // For OpenGL types (indirectly used via GLUT)
-#include <GL/freeglut.h> // For rendering primitives like glutSolidCube
-#include <math.h>        // For sinf, cosf, fabsf, fmodf, fmaxf, fminf, powf, sqrtf
+#include "sim.h"      // Defines SimTrack and TrackType enum
+#include "corner_collision.h" // Four-corner track collision kernel
+#include "track_grid.h"  // Distance grid backend for isPositionOnTrack
+#include "track_file.h"  // Start position and collision grid of custom tracks
+#include "swept_collision.h" // Swept box test and wall sliding
+#include "sim_math.h"        // getHeadingSinCos (deterministic with SIM_DETERMINISTIC)
+
+// Note: this file is part of the GL-free simulation library (see the 'headless'
+// Makefile target). Car rendering lives in car_render.c.
+#include <math.h>        // For fabsf, fmodf, fmaxf, fminf
 #include <stdio.h>       // For optional debugging printf statements
 
-// Define M_PI if not already defined by math.h
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-// Macro for converting degrees to radians
-#define DEG_TO_RAD(angle) ((angle) * M_PI / 180.0f)
-
-// Forward declaration of our position on track function
-int isPositionOnTrack(float x, float z);
-
 // --- Car Initialization ---
-// Sets the initial state of the car based on the selected track.
-void initCar(Car* car) {
+// Sets the initial state of the car based on the given track.
+void initCar(Car* car, const SimTrack* track) {
     // Common initial state
     car->y = 0.25f;      // Half height, sitting on y=0 plane
-    car->angle = 0.0f;     // Facing positive Z (generally 'up' the track initially)
+    float angle = 0.0f;  // Facing positive Z (generally 'up' the track initially)
     car->speed = 0.0f;
 
     // --- Set start position based on track type ---
     // This ensures the car starts on a valid part of the chosen track,
     // typically on the starting straight behind the finish line.
-    if (selectedTrackType == TRACK_RECT) {
+    if (track->type == TRACK_RECT) {
         // Start on the right straight for the rectangular track
         car->x = (RECT_INNER_X_POS + RECT_OUTER_X_POS) / 2.0f; // Center of the right road lane
         car->z = FINISH_LINE_Z - 20.0f; // Start back from the finish line Z coordinate
-    } else { // TRACK_ROUNDED
+    } else if (track->type == TRACK_ROUNDED) {
         // Start on the right straight for the rounded track as well
         car->x = ROUND_TRACK_MAIN_WIDTH / 2.0f; // Center X of the right straight section
         car->z = FINISH_LINE_Z - 20.0f; // Start back from the finish line Z coordinate
+    } else { // TRACK_CUSTOM
+        // Track files store their own start position, behind the finish line.
+        const TrackData* custom = track->data;
+        car->x = custom ? custom->header->start_x : 0.0f;
+        car->z = custom ? custom->header->start_z : 0.0f;
+        angle = custom ? custom->header->start_angle : 0.0f;
     }
+    setCarAngle(car, angle);
 
 
     // Initialize previous position to the starting position
@@ -45,12 +47,10 @@ void initCar(Car* car) {
     car->prev_z = car->z;
 
     // --- Physics Parameters ---
-    // These values can be tuned to change the car's handling characteristics.
-    car->acceleration_rate = 7.0f;  // Units per second^2
-    car->braking_rate = 15.0f;      // Units per second^2 (force opposing motion)
-    car->friction = 2.0f;           // Drag factor applied when not accelerating/braking
-    car->turn_speed = 140.0f;       // Adjusted for sharp corners
-    car->max_speed = 40.0f;         // Maximum forward speed in units per second
+    // The handling values live in getDefaultCarTuning so tools can vary them.
+    CarTuning tuning;
+    getDefaultCarTuning(&tuning);
+    applyCarTuning(car, &tuning);
     car->max_reverse_speed = -10.0f; // Maximum reverse speed
 
     // --- Control State Initialization ---
@@ -68,20 +68,40 @@ void initCar(Car* car) {
 }
 
 
+// --- Handling Parameters ---
+// These values can be tuned to change the car's handling characteristics.
+void getDefaultCarTuning(CarTuning* tuning) {
+    tuning->acceleration_rate = 7.0f;  // Units per second^2
+    tuning->braking_rate = 15.0f;      // Units per second^2 (force opposing motion)
+    tuning->friction = 2.0f;           // Drag factor applied when not accelerating/braking
+    tuning->turn_speed = 140.0f;       // Adjusted for sharp corners
+    tuning->max_speed = 40.0f;         // Maximum forward speed in units per second
+}
+
+void applyCarTuning(Car* car, const CarTuning* tuning) {
+    car->acceleration_rate = tuning->acceleration_rate;
+    car->braking_rate = tuning->braking_rate;
+    car->friction = tuning->friction;
+    car->turn_speed = tuning->turn_speed;
+    car->max_speed = tuning->max_speed;
+}
+
+void setCarAngle(Car* car, float angleDeg) {
+    car->angle = angleDeg;
+    getHeadingSinCos(angleDeg, &car->heading_sin, &car->heading_cos);
+}
+
+
 // --- Corner Calculation Helper Function ---
 // Calculates the world X, Z coordinates of the car's four corners based on its center,
 // orientation, and dimensions. This is used for collision detection.
-void calculateCarCorners(float center_x, float center_z, float angle_deg,
+void calculateCarCorners(float center_x, float center_z, float sin_a, float cos_a,
                          float width, float length,
                          float* fl_x, float* fl_z, // Front-Left output pointers
                          float* fr_x, float* fr_z, // Front-Right
                          float* rl_x, float* rl_z, // Rear-Left
                          float* rr_x, float* rr_z) // Rear-Right
 {
-    float angle_rad = DEG_TO_RAD(angle_deg); // Convert angle to radians
-    float sin_a = sinf(angle_rad);
-    float cos_a = cosf(angle_rad);
-
     // Calculate half dimensions for convenience
     float half_width = width / 2.0f;
     float half_length = length / 2.0f;
@@ -113,8 +133,10 @@ void calculateCarCorners(float center_x, float center_z, float angle_deg,
 
 
 // --- Car Update Logic ---
-// Called every frame by updateGame() to calculate physics and collisions.
-void updateCar(Car* car, float deltaTime) {
+// Called every physics tick (by updateRace) to calculate physics and collisions.
+// Returns 1 if the car hit the track edge (and was stopped, or slid along it) this tick.
+int updateCar(Car* car, const SimTrack* track, float deltaTime) {
+    int collided = 0;
     // Store previous valid position *before* any updates. Used for collision response.
     car->prev_x = car->x;
     car->prev_z = car->z;
@@ -125,9 +147,11 @@ void updateCar(Car* car, float deltaTime) {
         float speed_factor = 1.0f - (fmaxf(0.0f, fabsf(car->speed) - car->max_speed * 0.3f) / (car->max_speed * 0.7f));
         current_turn_speed *= fmaxf(0.15f, speed_factor);
     }
-    if (car->turning_left && fabsf(car->speed) > 0.1f) car->angle += current_turn_speed * deltaTime;
-    if (car->turning_right && fabsf(car->speed) > 0.1f) car->angle -= current_turn_speed * deltaTime;
-    car->angle = fmodf(car->angle + 360.0f, 360.0f);
+    float angle = car->angle;
+    if (car->turning_left && fabsf(car->speed) > 0.1f) angle += current_turn_speed * deltaTime;
+    if (car->turning_right && fabsf(car->speed) > 0.1f) angle -= current_turn_speed * deltaTime;
+    angle = fmodf(angle + 360.0f, 360.0f);
+    if (angle != car->angle) setCarAngle(car, angle); // Sine/cosine only when the heading changed
 
     // --- 2. Apply Acceleration/Braking --- (Code as provided by user)
     float effective_accel = 0.0f;
@@ -153,31 +177,26 @@ void updateCar(Car* car, float deltaTime) {
 
     // --- 5. Calculate Potential New Position and Check Corner Collisions ---
     if (fabsf(car->speed) > 0.001f) {
-        float angle_rad = DEG_TO_RAD(car->angle);
-        float dx = car->speed * sinf(angle_rad) * deltaTime;
-        float dz = car->speed * cosf(angle_rad) * deltaTime;
+        float sin_a = car->heading_sin;
+        float cos_a = car->heading_cos;
+        float dx = car->speed * sin_a * deltaTime;
+        float dz = car->speed * cos_a * deltaTime;
 
         // Calculate potential new CENTER position
         float potential_x = car->x + dx;
         float potential_z = car->z + dz;
 
-        // Calculate potential CORNER positions based on the potential center
-        float pot_fl_x, pot_fl_z, pot_fr_x, pot_fr_z; // Front corners
-        float pot_rl_x, pot_rl_z, pot_rr_x, pot_rr_z; // Rear corners
-        calculateCarCorners(potential_x, potential_z, car->angle,
-                            car->width, car->length,
-                            &pot_fl_x, &pot_fl_z, &pot_fr_x, &pot_fr_z,
-                            &pot_rl_x, &pot_rl_z, &pot_rr_x, &pot_rr_z);
-
-        // Check if ANY potential corner is off the track
-        int collisionDetected = 0; // Use int for boolean (0 = false, 1 = true)
-        if (!isPositionOnTrack(pot_fl_x, pot_fl_z)) collisionDetected = 1;
-        if (!isPositionOnTrack(pot_fr_x, pot_fr_z)) collisionDetected = 1;
-        if (!isPositionOnTrack(pot_rl_x, pot_rl_z)) collisionDetected = 1;
-        if (!isPositionOnTrack(pot_rr_x, pot_rr_z)) collisionDetected = 1;
+        // Check if ANY potential corner is off the track. The kernel in corner_collision.c
+        // transforms all four corners (as calculateCarCorners does) and tests them in one pass.
+        int collisionDetected = !areCarCornersOnTrack(track, potential_x, potential_z,
+                                                      sin_a, cos_a, car->width / 2.0f, car->length / 2.0f);
 
         // --- 6. Collision Detection and Response ---
-        if (!collisionDetected) { // If collisionDetected is 0 (false)
+        if (track->collision_response == TRACK_COLLISION_SWEPT) {
+            // Stop at the first contact along the move and slide along the wall from there.
+            collided = sweepCarAgainstTrack(track, &car->x, &car->z, potential_x, potential_z, sin_a, cos_a,
+                                            car->width / 2.0f, car->length / 2.0f, &car->speed, !collisionDetected);
+        } else if (!collisionDetected) { // If collisionDetected is 0 (false)
             // Position is valid: Update the car's actual position.
             car->x = potential_x;
             car->z = potential_z;
@@ -187,6 +206,7 @@ void updateCar(Car* car, float deltaTime) {
             car->x = car->prev_x;
             car->z = car->prev_z;
             car->speed = 0.0f; // Bring car to a complete halt
+            collided = 1;
 
             // Optional: Add sound effect or visual feedback here later.
             // printf("Corner Collision! Pos:(%.2f, %.2f) Speed set to 0.\n", car->x, car->z); // Debug output
@@ -195,13 +215,21 @@ void updateCar(Car* car, float deltaTime) {
          // If speed is near zero, explicitly set it to zero to prevent potential drift.
          car->speed = 0.0f;
     }
+    return collided;
 }
 
 
 // --- Position on Track Check ---
 // Wraps the specific track type functions to determine if position is on track
-int isPositionOnTrack(float x, float z) {
-    if (selectedTrackType == TRACK_RECT) {
+int isPositionOnTrack(const SimTrack* track, float x, float z) {
+    TrackType type = track->type;
+    // Custom tracks have no analytic shape; they always use their file's grid.
+    if (track->query_backend == TRACK_QUERY_GRID || type == TRACK_CUSTOM) {
+        const TrackGrid* grid = getTrackGrid(track);
+        if (grid) return isPositionOnTrackGrid(grid, x, z);
+        if (type == TRACK_CUSTOM) return 0; // No track loaded
+    }
+    if (type == TRACK_RECT) {
         return isPositionOnRectTrack(x, z);
     } else { // TRACK_ROUNDED
         return isPositionOnRoundTrack(x, z);
@@ -209,70 +237,6 @@ int isPositionOnTrack(float x, float z) {
 }
 
 
-// --- Car Rendering --- (Code as provided by user)
-// Draws the car model (currently a composite cube structure) at its current position and orientation.
-void renderCar(const Car* car) {
-    glPushMatrix(); // Save the current OpenGL matrix state
-
-    // Apply transformations: Move to car's position and rotate to its angle.
-    glTranslatef(car->x, car->y, car->z);
-    glRotatef(car->angle, 0.0f, 1.0f, 0.0f); // Rotate around the Y-axis (vertical)
-
-    // --- Car Body (Red) ---
-    glPushMatrix();
-    glScalef(car->width, car->height, car->length);
-    glColor3f(1.0f, 0.0f, 0.0f); // Red color
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    // --- Wheels (Dark Grey Cubes) ---
-    float wheelRadius = 0.35f * car->height;
-    float wheelWidth = 0.15f * car->width;
-    float wheelDistX = (car->width / 2.0f) + wheelWidth * 0.5f;
-    float wheelDistZ = (car->length / 2.0f) * 0.7f;
-    glColor3f(0.1f, 0.1f, 0.1f);
-    // FL
-    glPushMatrix();
-    glTranslatef(-wheelDistX, 0.0f, wheelDistZ);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    glScalef(wheelWidth, wheelRadius * 2.0f, wheelRadius * 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-    // FR
-    glPushMatrix();
-    glTranslatef(wheelDistX, 0.0f, wheelDistZ);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    glScalef(wheelWidth, wheelRadius * 2.0f, wheelRadius * 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-    // RL
-    glPushMatrix();
-    glTranslatef(-wheelDistX, 0.0f, -wheelDistZ);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    glScalef(wheelWidth, wheelRadius * 2.0f, wheelRadius * 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-    // RR
-    glPushMatrix();
-    glTranslatef(wheelDistX, 0.0f, -wheelDistZ);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-    glScalef(wheelWidth, wheelRadius * 2.0f, wheelRadius * 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    // --- Driver Helmet Indicator (White Cube) ---
-    glPushMatrix();
-    glTranslatef(0.0f, car->height * 0.6f, -car->length * 0.1f);
-    float helmetSize = 0.15f;
-    glScalef(helmetSize, helmetSize, helmetSize);
-    glColor3f(1.0f, 1.0f, 1.0f); // White color
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    glPopMatrix(); // Restore the matrix state from before car transformations
-}
-
-
 // --- Car Control Input --- (Code as provided by user)
 // Updates the car's control state flags based on keyboard input.
 void setCarControls(Car* car, int key, int state) {
@@ -286,4 +250,39 @@ void setCarControls(Car* car, int key, int state) {
         case 'd': case 'D':
             car->turning_right = state; break;
     }
-}
\ No newline at end of file
+}
+
+// --- Control Bit Packing ---
+// Packs the four control flags into CAR_CONTROL_* bits.
+unsigned char getCarControlBits(const Car* car) {
+    unsigned char bits = 0;
+    if (car->accelerating) bits |= CAR_CONTROL_ACCELERATE;
+    if (car->braking) bits |= CAR_CONTROL_BRAKE;
+    if (car->turning_left) bits |= CAR_CONTROL_TURN_LEFT;
+    if (car->turning_right) bits |= CAR_CONTROL_TURN_RIGHT;
+    return bits;
+}
+
+// Sets the four control flags from CAR_CONTROL_* bits.
+void setCarControlBits(Car* car, unsigned char bits) {
+    car->accelerating = (bits & CAR_CONTROL_ACCELERATE) != 0;
+    car->braking = (bits & CAR_CONTROL_BRAKE) != 0;
+    car->turning_left = (bits & CAR_CONTROL_TURN_LEFT) != 0;
+    car->turning_right = (bits & CAR_CONTROL_TURN_RIGHT) != 0;
+}
+
+// --- Render Interpolation ---
+// Blends two physics states (e.g. the last two ticks) for drawing between
+// ticks. alpha = 0 gives 'from', 1 gives 'to'. The heading takes the short
+// way round through 0/360 degrees.
+void interpolateCar(const Car* from, const Car* to, float alpha, Car* out) {
+    *out = *to;
+    out->x = from->x + (to->x - from->x) * alpha;
+    out->y = from->y + (to->y - from->y) * alpha;
+    out->z = from->z + (to->z - from->z) * alpha;
+    float turn = to->angle - from->angle;
+    if (turn > 180.0f) turn -= 360.0f;
+    else if (turn < -180.0f) turn += 360.0f;
+    setCarAngle(out, fmodf(from->angle + turn * alpha + 360.0f, 360.0f));
+    out->speed = from->speed + (to->speed - from->speed) * alpha;
+}
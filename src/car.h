@@ -14,6 +14,11 @@ typedef struct {
 
     // Orientation (angle around Y-axis in degrees)
     float angle;
+    // Sine and cosine of angle (see getHeadingSinCos in sim_math.h), kept in
+    // step with it by setCarAngle so the physics, collision and camera reuse
+    // them instead of recomputing them every tick. Set angle only through setCarAngle.
+    float heading_sin;
+    float heading_cos;
 
     // Physics
     float speed;
@@ -37,15 +42,39 @@ typedef struct {
 
 } Car;
 
+// --- Control Bits ---
+// Packed form of the four control flags, used where controls are stored per
+// tick or per car in bulk (e.g. CarBatch in car_batch.h).
+#define CAR_CONTROL_ACCELERATE  0x01
+#define CAR_CONTROL_BRAKE       0x02
+#define CAR_CONTROL_TURN_LEFT   0x04
+#define CAR_CONTROL_TURN_RIGHT  0x08
+
+// --- Handling Parameters ---
+// The tunable part of the car's physics, as set by initCar. Tools that explore
+// handling (e.g. the sweep runner) apply their own values after initCar.
+typedef struct {
+    float acceleration_rate;
+    float braking_rate;
+    float friction;
+    float turn_speed;
+    float max_speed;
+} CarTuning;
+
 // Function declarations
-void initCar(Car* car);
-void updateCar(Car* car, float deltaTime);
-void renderCar(const Car* car);
+// (initCar and updateCar take the track, so they are declared in sim.h)
+void getDefaultCarTuning(CarTuning* tuning);                 // The values initCar uses
+void applyCarTuning(Car* car, const CarTuning* tuning);
+void setCarAngle(Car* car, float angleDeg);            // Sets the heading and its cached sine/cosine
 void setCarControls(Car* car, int key, int state); // 1 for down, 0 for up
+unsigned char getCarControlBits(const Car* car);       // Packs the control flags into CAR_CONTROL_* bits
+void setCarControlBits(Car* car, unsigned char bits);  // Unpacks CAR_CONTROL_* bits into the control flags
+void interpolateCar(const Car* from, const Car* to, float alpha, Car* out); // Render state between two ticks
 
 // --- New Helper Function Prototype ---
 // Calculates the world X, Z coordinates of the car's four corners
-void calculateCarCorners(float center_x, float center_z, float angle_deg,
+// (sin_a/cos_a of the heading, e.g. a Car's heading_sin/heading_cos)
+void calculateCarCorners(float center_x, float center_z, float sin_a, float cos_a,
                          float width, float length,
                          float* fl_x, float* fl_z, // Front-Left
                          float* fr_x, float* fr_z, // Front-Right
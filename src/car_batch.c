@@ -0,0 +1,203 @@
+#include "car_batch.h"
+#include "corner_collision.h"
+#include "swept_collision.h" // Same track collision response as updateCar
+#include "sim_math.h"        // Same heading trigonometry as updateCar
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Arrays are padded to a multiple of this many elements so each one starts on a 32-byte boundary
+#define BATCH_ARRAY_ALIGN 8
+
+#define GRID_ROW_SPACING 3.0f // Distance between grid rows
+#define GRID_STRAIGHT_ROWS 10 // Rows placed straight back from the pole (the start straight)
+
+// --- Batch Allocation ---
+int initCarBatch(CarBatch* batch, int capacity, const SimTrack* track, const Car* tuning) {
+    memset(batch, 0, sizeof(*batch));
+    if (capacity < 1) capacity = 1;
+    int padded = (capacity + BATCH_ARRAY_ALIGN - 1) / BATCH_ARRAY_ALIGN * BATCH_ARRAY_ALIGN;
+
+    // One block: ten float arrays followed by two byte arrays, plus slack for alignment.
+    size_t floatBytes = (size_t)padded * sizeof(float);
+    size_t total = 10 * floatBytes + 2 * (size_t)padded + 32;
+    unsigned char* block = (unsigned char*)malloc(total);
+    if (!block) return 0;
+    memset(block, 0, total);
+
+    unsigned char* p = block + ((32 - ((size_t)block & 31)) & 31);
+    batch->x = (float*)p;      p += floatBytes;
+    batch->z = (float*)p;      p += floatBytes;
+    batch->prev_x = (float*)p; p += floatBytes;
+    batch->prev_z = (float*)p; p += floatBytes;
+    batch->angle = (float*)p;  p += floatBytes;
+    batch->speed = (float*)p;  p += floatBytes;
+    batch->potential_x = (float*)p; p += floatBytes;
+    batch->potential_z = (float*)p; p += floatBytes;
+    batch->sin_a = (float*)p;  p += floatBytes;
+    batch->cos_a = (float*)p;  p += floatBytes;
+    batch->controls = p;       p += padded;
+    batch->on_track = p;
+
+    batch->storage = block;
+    batch->capacity = capacity;
+    batch->count = 0;
+    batch->track = *track;
+    batch->tuning = *tuning;
+    return 1;
+}
+
+void freeCarBatch(CarBatch* batch) {
+    free(batch->storage);
+    memset(batch, 0, sizeof(*batch));
+}
+
+
+// --- Moving Cars In and Out ---
+int addCarToBatch(CarBatch* batch, const Car* car) {
+    if (batch->count >= batch->capacity) return -1;
+    int i = batch->count++;
+    batch->x[i] = car->x;
+    batch->z[i] = car->z;
+    batch->prev_x[i] = car->prev_x;
+    batch->prev_z[i] = car->prev_z;
+    batch->angle[i] = car->angle;
+    batch->sin_a[i] = car->heading_sin;
+    batch->cos_a[i] = car->heading_cos;
+    batch->speed[i] = car->speed;
+    batch->controls[i] = getCarControlBits(car);
+    return i;
+}
+
+void getCarFromBatch(const CarBatch* batch, int index, Car* out) {
+    *out = batch->tuning;
+    out->x = batch->x[index];
+    out->z = batch->z[index];
+    out->prev_x = batch->prev_x[index];
+    out->prev_z = batch->prev_z[index];
+    out->angle = batch->angle[index];
+    out->heading_sin = batch->sin_a[index];
+    out->heading_cos = batch->cos_a[index];
+    out->speed = batch->speed[index];
+    setCarControlBits(out, batch->controls[index]);
+}
+
+
+// --- Starting Grid ---
+void placeCarOnGrid(const Car* pole, const TrackProgress* progress, int slot, Car* out) {
+    *out = *pole;
+    float lane = (slot % 2 == 0) ? 2.5f : -2.5f; // Left of the car is (-headingZ, headingX)
+    int row = slot / 2;
+    float back = (float)row * GRID_ROW_SPACING;
+    if (row < GRID_STRAIGHT_ROWS || !progress) {
+        float headingX = pole->heading_sin, headingZ = pole->heading_cos;
+        out->x += -headingZ * lane - headingX * back;
+        out->z += headingX * lane - headingZ * back;
+    } else {
+        // Past the start straight: the same offset from the centerline as the
+        // pole, at the centerline point 'back' behind it, facing along the road.
+        float poleDistance = sampleTrackProgress(progress, pole->x, pole->z);
+        float cx, cz, aheadX, aheadZ, behindX, behindZ;
+        getTrackProgressPoint(progress, poleDistance, &cx, &cz);
+        float poleOffset = (pole->x - cx) * -pole->heading_cos + (pole->z - cz) * pole->heading_sin;
+        float distance = poleDistance - back;
+        getTrackProgressPoint(progress, distance, &cx, &cz);
+        getTrackProgressPoint(progress, distance + 1.0f, &aheadX, &aheadZ);
+        getTrackProgressPoint(progress, distance - 1.0f, &behindX, &behindZ);
+        setCarAngle(out, getHeadingAngle(aheadX - behindX, aheadZ - behindZ));
+        float side = poleOffset + lane;
+        out->x = cx - out->heading_cos * side;
+        out->z = cz + out->heading_sin * side;
+    }
+    out->prev_x = out->x; out->prev_z = out->z;
+}
+
+
+// --- Batch Update ---
+// Mirrors updateCar() step for step, but runs each phase over the whole batch
+// before moving on so every loop touches only the arrays it needs.
+void updateCarBatch(CarBatch* batch, float deltaTime) {
+    const Car* t = &batch->tuning;
+    int n = batch->count;
+    float* x = batch->x;
+    float* z = batch->z;
+    float* angle = batch->angle;
+    float* sin_a = batch->sin_a;
+    float* cos_a = batch->cos_a;
+    float* speed = batch->speed;
+    const unsigned char* controls = batch->controls;
+
+    // Store previous valid positions *before* any updates.
+    memcpy(batch->prev_x, x, (size_t)n * sizeof(float));
+    memcpy(batch->prev_z, z, (size_t)n * sizeof(float));
+
+    // --- 1-4. Turning, Acceleration/Braking, Friction, Speed Clamp ---
+    for (int i = 0; i < n; ++i) {
+        unsigned char c = controls[i];
+        int accelerating = (c & CAR_CONTROL_ACCELERATE) != 0;
+        int braking = (c & CAR_CONTROL_BRAKE) != 0;
+        float s = speed[i];
+
+        float current_turn_speed = t->turn_speed;
+        if (fabsf(s) > 1.0f) {
+            float speed_factor = 1.0f - (fmaxf(0.0f, fabsf(s) - t->max_speed * 0.3f) / (t->max_speed * 0.7f));
+            current_turn_speed *= fmaxf(0.15f, speed_factor);
+        }
+        float a = angle[i];
+        if ((c & CAR_CONTROL_TURN_LEFT) && fabsf(s) > 0.1f) a += current_turn_speed * deltaTime;
+        if ((c & CAR_CONTROL_TURN_RIGHT) && fabsf(s) > 0.1f) a -= current_turn_speed * deltaTime;
+        a = fmodf(a + 360.0f, 360.0f);
+        if (a != angle[i]) { // Sine/cosine only when the heading changed
+            angle[i] = a;
+            getHeadingSinCos(a, &sin_a[i], &cos_a[i]);
+        }
+
+        float effective_accel = 0.0f;
+        if (accelerating) effective_accel = t->acceleration_rate;
+        if (braking) {
+            if (s > 0.01f) effective_accel -= t->braking_rate;
+            else if (s < -0.01f) effective_accel += t->braking_rate;
+        }
+        s += effective_accel * deltaTime;
+
+        if (!accelerating && !braking && fabsf(s) > 0.01f) {
+            float friction_force = t->friction * deltaTime;
+            if (s > 0.0f) {
+                s -= friction_force; if (s < 0.0f) s = 0.0f;
+            } else {
+                s += friction_force; if (s > 0.0f) s = 0.0f;
+            }
+        }
+
+        speed[i] = fmaxf(t->max_reverse_speed, fminf(t->max_speed, s));
+    }
+
+    // --- 5. Potential New Positions ---
+    float* potential_x = batch->potential_x;
+    float* potential_z = batch->potential_z;
+    for (int i = 0; i < n; ++i) {
+        potential_x[i] = x[i] + speed[i] * sin_a[i] * deltaTime;
+        potential_z[i] = z[i] + speed[i] * cos_a[i] * deltaTime;
+    }
+
+    // --- Corner Collisions for every car in one call ---
+    areCarCornersOnTrackBatch(&batch->track, n, potential_x, potential_z, sin_a, cos_a,
+                              t->width / 2.0f, t->length / 2.0f, batch->on_track);
+
+    // --- 6. Collision Response ---
+    const unsigned char* on_track = batch->on_track;
+    for (int i = 0; i < n; ++i) {
+        if (fabsf(speed[i]) <= 0.001f) {
+            speed[i] = 0.0f; // Prevent drift when nearly stopped
+        } else if (batch->track.collision_response == TRACK_COLLISION_SWEPT) {
+            sweepCarAgainstTrack(&batch->track, &x[i], &z[i], potential_x[i], potential_z[i], sin_a[i], cos_a[i],
+                                 t->width / 2.0f, t->length / 2.0f, &speed[i], on_track[i]);
+        } else if (on_track[i]) {
+            x[i] = potential_x[i];
+            z[i] = potential_z[i];
+        } else {
+            // Collision: stay at the previous position and stop, as updateCar does.
+            speed[i] = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CAR_BATCH_H
+#define CAR_BATCH_H
+
+#include "sim.h" // Car struct, CAR_CONTROL_* bits and SimTrack
+#include "track_progress.h" // TrackProgress for the starting grid
+
+// --- Car Batch ---
+// Structure-of-arrays storage for many cars on one track. The per-tick state
+// (position, heading, speed, control bits) is kept in separate contiguous
+// arrays so updateCarBatch() streams through memory, while the tuning
+// constants and dimensions are shared by every car and stored once.
+typedef struct {
+    int count;              // Number of cars in use
+    int capacity;           // Number of cars the arrays can hold
+    SimTrack track;         // Track (and collision rules) every car in the batch uses
+    Car tuning;             // Tuning constants and dimensions shared by all cars (state fields unused)
+
+    // Per-car state, one entry per car (same meaning as the Car fields)
+    float* x;
+    float* z;
+    float* prev_x;
+    float* prev_z;
+    float* angle;           // Degrees, same convention as Car.angle
+    float* sin_a;           // Sine/cosine of angle, as Car.heading_sin/heading_cos
+    float* cos_a;           //   (updated with it, so only turning cars recompute them)
+    float* speed;
+    unsigned char* controls; // CAR_CONTROL_* bits
+
+    // Per-car scratch used inside updateCarBatch (potential move and collision results)
+    float* potential_x;
+    float* potential_z;
+    unsigned char* on_track;
+
+    void* storage;          // Single allocation backing all of the arrays above
+} CarBatch;
+
+// Allocates room for 'capacity' cars. 'track' is copied into the batch;
+// 'tuning' supplies the shared physics constants and dimensions (e.g. a car
+// set up by initCar). Returns 1 on success.
+int initCarBatch(CarBatch* batch, int capacity, const SimTrack* track, const Car* tuning);
+void freeCarBatch(CarBatch* batch);
+
+// Appends a car's state to the batch. Returns its index, or -1 if the batch is full.
+int addCarToBatch(CarBatch* batch, const Car* car);
+// Fills a Car with the shared tuning plus the state of car 'index' (e.g. for rendering).
+void getCarFromBatch(const CarBatch* batch, int index, Car* out);
+
+// Starting grid: places 'out' (a copy of the pole car) in grid slot 'slot',
+// two lanes 2.5 units either side of the pole position and rows 3 units apart
+// going back. The first ten rows run straight back from the pole; further rows
+// follow the track's centerline ('progress', e.g. getTrackProgress) round the
+// corners behind the start, or carry on straight if it is NULL.
+void placeCarOnGrid(const Car* pole, const TrackProgress* progress, int slot, Car* out);
+
+// Advances every car by one step. Same semantics as calling updateCar() on
+// each car, with the batch's track used for collision.
+void updateCarBatch(CarBatch* batch, float deltaTime);
+
+#endif // CAR_BATCH_H
@@ -0,0 +1,220 @@
+#include "car_contact.h"
+#include "corner_collision.h" // areCarCornersOnTrack, to keep pushed cars on the road
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CONTACT_SEPARATION_SLOP 0.01f // Extra distance pushed apart so the pair does not touch again at once
+
+// --- Grid Allocation ---
+int initCarContactGrid(CarContactGrid* grid, int capacity, const Car* tuning) {
+    memset(grid, 0, sizeof(*grid));
+    if (capacity < 1) capacity = 1;
+    int tableSize = 16;
+    while (tableSize < 2 * capacity) tableSize *= 2;
+
+    size_t intBytes = (size_t)capacity * sizeof(int);
+    size_t total = (size_t)(tableSize + 1) * sizeof(int) + 3 * intBytes + (size_t)capacity * sizeof(unsigned int) +
+                   (size_t)capacity * 10 * sizeof(float);
+    unsigned char* block = (unsigned char*)malloc(total);
+    if (!block) return 0;
+
+    unsigned char* p = block;
+    grid->bucket_start = (int*)p; p += (size_t)(tableSize + 1) * sizeof(int);
+    grid->sorted = (int*)p;       p += intBytes;
+    grid->cell_x = (int*)p;       p += intBytes;
+    grid->cell_z = (int*)p;       p += intBytes;
+    grid->bucket = (unsigned int*)p; p += (size_t)capacity * sizeof(unsigned int);
+    grid->corners = (float*)p;    p += (size_t)capacity * 8 * sizeof(float);
+    grid->sin_a = (float*)p;      p += (size_t)capacity * sizeof(float);
+    grid->cos_a = (float*)p;
+
+    grid->storage = block;
+    grid->capacity = capacity;
+    grid->table_size = tableSize;
+    grid->cell_size = sqrtf(tuning->width * tuning->width + tuning->length * tuning->length); // Bounding circle diameter
+    return 1;
+}
+
+void freeCarContactGrid(CarContactGrid* grid) {
+    free(grid->storage);
+    memset(grid, 0, sizeof(*grid));
+}
+
+
+// --- Helpers ---
+static unsigned int hashCell(int cx, int cz, int tableSize) {
+    unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cz * 19349663u;
+    return h & (unsigned int)(tableSize - 1);
+}
+
+// Car k of the combined list: batch cars first, then the fixed cars.
+typedef struct {
+    CarBatch* batch;
+    const Car* fixed;
+} ContactCars;
+
+// The heading comes as its cached sine/cosine, the ones the track collision used.
+static void getContactCar(const ContactCars* cars, int k, float* x, float* z, float* sinA, float* cosA, float* halfWidth, float* halfLength) {
+    const CarBatch* batch = cars->batch;
+    if (k < batch->count) {
+        *x = batch->x[k]; *z = batch->z[k]; *sinA = batch->sin_a[k]; *cosA = batch->cos_a[k];
+        *halfWidth = batch->tuning.width / 2.0f; *halfLength = batch->tuning.length / 2.0f;
+    } else {
+        const Car* car = &cars->fixed[k - batch->count];
+        *x = car->x; *z = car->z; *sinA = car->heading_sin; *cosA = car->heading_cos;
+        *halfWidth = car->width / 2.0f; *halfLength = car->length / 2.0f;
+    }
+}
+
+static void updateCorners(CarContactGrid* grid, const ContactCars* cars, int k) {
+    float x, z, sinA, cosA, hw, hl;
+    getContactCar(cars, k, &x, &z, &sinA, &cosA, &hw, &hl);
+    float* c = &grid->corners[k * 8];
+    calculateCarCorners(x, z, sinA, cosA, hw * 2.0f, hl * 2.0f, &c[0], &c[1], &c[2], &c[3], &c[4], &c[5], &c[6], &c[7]);
+}
+
+// Projects a box's four corners on an axis.
+static void projectBox(const float* c, float ax, float az, float* lo, float* hi) {
+    *lo = *hi = c[0] * ax + c[1] * az;
+    for (int k = 1; k < 4; ++k) {
+        float d = c[k * 2] * ax + c[k * 2 + 1] * az;
+        if (d < *lo) *lo = d;
+        if (d > *hi) *hi = d;
+    }
+}
+
+// Separating-axis test of two boxes given by their corners (FL, FR, RL, RR).
+// On overlap returns 1 with the axis of least overlap (pointing from a to b)
+// and the overlap along it.
+static int overlapBoxes(const float* a, const float* b, float* axisX, float* axisZ, float* depth) {
+    float axes[4][2];
+    const float* boxes[2] = { a, b };
+    for (int i = 0; i < 2; ++i) {
+        const float* c = boxes[i];
+        float fx = c[0] - c[4], fz = c[1] - c[5]; // Rear-left to front-left: the car's forward edge
+        float rx = c[2] - c[0], rz = c[3] - c[1]; // Front-left to front-right: its side edge
+        float fl = sqrtf(fx * fx + fz * fz), rl = sqrtf(rx * rx + rz * rz);
+        axes[i * 2][0] = fx / fl;     axes[i * 2][1] = fz / fl;
+        axes[i * 2 + 1][0] = rx / rl; axes[i * 2 + 1][1] = rz / rl;
+    }
+    float best = 1e30f;
+    for (int i = 0; i < 4; ++i) {
+        float aLo, aHi, bLo, bHi;
+        projectBox(a, axes[i][0], axes[i][1], &aLo, &aHi);
+        projectBox(b, axes[i][0], axes[i][1], &bLo, &bHi);
+        float overlap = fminf(aHi, bHi) - fmaxf(aLo, bLo);
+        if (overlap <= 0.0f) return 0;
+        if (overlap < best) {
+            best = overlap;
+            // Point the axis from a's center towards b's.
+            float sign = ((bLo + bHi) - (aLo + aHi) >= 0.0f) ? 1.0f : -1.0f;
+            *axisX = axes[i][0] * sign;
+            *axisZ = axes[i][1] * sign;
+        }
+    }
+    *depth = best;
+    return 1;
+}
+
+// Moves batch car k by (dx, dz) if its corners stay on the track. Returns 1 if moved.
+static int tryPushCar(CarContactGrid* grid, const ContactCars* cars, int k, float dx, float dz) {
+    CarBatch* batch = cars->batch;
+    float nx = batch->x[k] + dx, nz = batch->z[k] + dz;
+    if (!areCarCornersOnTrack(&batch->track, nx, nz, grid->sin_a[k], grid->cos_a[k],
+                              batch->tuning.width / 2.0f, batch->tuning.length / 2.0f)) {
+        return 0;
+    }
+    batch->x[k] = nx;
+    batch->z[k] = nz;
+    updateCorners(grid, cars, k);
+    return 1;
+}
+
+// Slows batch car k if it is driving along (ax, az), i.e. into the other car.
+static void slowCarDrivingInto(CarContactGrid* grid, CarBatch* batch, int k, float ax, float az) {
+    float along = batch->speed[k] * (grid->sin_a[k] * ax + grid->cos_a[k] * az);
+    if (along > 0.0f) batch->speed[k] *= CAR_CONTACT_SPEED_KEEP;
+}
+
+static void resolvePair(CarContactGrid* grid, const ContactCars* cars, int a, int b, float ax, float az, float depth) {
+    CarBatch* batch = cars->batch;
+    int aMovable = (a < batch->count), bMovable = (b < batch->count);
+    float push = depth + CONTACT_SEPARATION_SLOP;
+    if (aMovable && bMovable) {
+        // Split the push; if either half is blocked by the track edge, the other car takes all of it.
+        if (!tryPushCar(grid, cars, a, -ax * push * 0.5f, -az * push * 0.5f)) {
+            tryPushCar(grid, cars, b, ax * push, az * push);
+        } else if (!tryPushCar(grid, cars, b, ax * push * 0.5f, az * push * 0.5f)) {
+            tryPushCar(grid, cars, a, -ax * push * 0.5f, -az * push * 0.5f);
+        }
+    } else if (aMovable) {
+        tryPushCar(grid, cars, a, -ax * push, -az * push);
+    } else if (bMovable) {
+        tryPushCar(grid, cars, b, ax * push, az * push);
+    }
+    if (aMovable) slowCarDrivingInto(grid, batch, a, ax, az);
+    if (bMovable) slowCarDrivingInto(grid, batch, b, -ax, -az);
+}
+
+
+// --- Contact Pass ---
+int resolveCarContacts(CarContactGrid* grid, CarBatch* batch, const Car* fixed, int fixedCount) {
+    ContactCars cars = { batch, fixed };
+    int total = batch->count + fixedCount;
+    if (total > grid->capacity) total = grid->capacity;
+    int tableSize = grid->table_size;
+    float invCell = 1.0f / grid->cell_size;
+    float reach = grid->cell_size; // Centers further apart than the bounding circle diameter cannot touch
+    grid->candidate_pairs = 0;
+    grid->contact_count = 0;
+
+    // --- Bucket every car by cell (counting sort) ---
+    memset(grid->bucket_start, 0, (size_t)(tableSize + 1) * sizeof(int));
+    for (int k = 0; k < total; ++k) {
+        float x, z, hw, hl;
+        getContactCar(&cars, k, &x, &z, &grid->sin_a[k], &grid->cos_a[k], &hw, &hl);
+        updateCorners(grid, &cars, k);
+        grid->cell_x[k] = (int)floorf(x * invCell);
+        grid->cell_z[k] = (int)floorf(z * invCell);
+        grid->bucket[k] = hashCell(grid->cell_x[k], grid->cell_z[k], tableSize);
+        grid->bucket_start[grid->bucket[k] + 1]++;
+    }
+    for (int b = 0; b < tableSize; ++b) grid->bucket_start[b + 1] += grid->bucket_start[b];
+    for (int k = 0; k < total; ++k) {
+        // bucket_start[b] is used as the fill cursor, then restored below.
+        grid->sorted[grid->bucket_start[grid->bucket[k]]++] = k;
+    }
+    for (int b = tableSize; b > 0; --b) grid->bucket_start[b] = grid->bucket_start[b - 1];
+    grid->bucket_start[0] = 0;
+
+    // --- Compare each car with later cars in its own and the 8 neighbouring cells ---
+    for (int a = 0; a < batch->count && a < total; ++a) { // Fixed cars never start a pair with each other
+        int cx = grid->cell_x[a], cz = grid->cell_z[a];
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                unsigned int bucket = hashCell(cx + dx, cz + dz, tableSize);
+                for (int s = grid->bucket_start[bucket]; s < grid->bucket_start[bucket + 1]; ++s) {
+                    int b = grid->sorted[s];
+                    // Fixed cars come after every batch car, so b > a covers them too.
+                    // Other cells can share the bucket; each car is only taken from its own cell.
+                    if (b <= a) continue;
+                    if (grid->cell_x[b] != cx + dx || grid->cell_z[b] != cz + dz) continue;
+                    grid->candidate_pairs++;
+
+                    const float* ca = &grid->corners[a * 8];
+                    const float* cb = &grid->corners[b * 8];
+                    float ax = (ca[0] + ca[6]) * 0.5f, az = (ca[1] + ca[7]) * 0.5f; // Box centers (FL/RR midpoint)
+                    float bx = (cb[0] + cb[6]) * 0.5f, bz = (cb[1] + cb[7]) * 0.5f;
+                    if ((bx - ax) * (bx - ax) + (bz - az) * (bz - az) >= reach * reach) continue;
+
+                    float axisX = 0.0f, axisZ = 0.0f, depth;
+                    if (!overlapBoxes(ca, cb, &axisX, &axisZ, &depth)) continue;
+                    grid->contact_count++;
+                    resolvePair(grid, &cars, a, b, axisX, axisZ, depth);
+                }
+            }
+        }
+    }
+    return grid->contact_count;
+}
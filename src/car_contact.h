@@ -0,0 +1,55 @@
+#ifndef CAR_CONTACT_H
+#define CAR_CONTACT_H
+
+#include "car_batch.h" // CarBatch, Car
+
+// --- Car-to-Car Contacts ---
+// Finds and resolves overlapping cars once per tick, after the cars have
+// moved. Broad phase: every car is bucketed by the track cell (x, z) its
+// center lies in, cells a car's length across, via a hash table rebuilt with
+// a counting sort each tick; only cars in the same or neighbouring cells are
+// compared. Narrow phase: a bounding circle test, then a separating-axis test
+// of the two oriented boxes (corners from calculateCarCorners). The cost
+// grows with the number of cars plus the number of close pairs, not with
+// the square of the field size.
+//
+// Response: overlapping cars are pushed apart along the axis of least
+// overlap, and a car that was driving into the other loses half its speed.
+// A push that would put a car's corners off the track is given to the other
+// car instead (or skipped), so no car is left where updateCar would refuse
+// every move.
+//
+// Fixed cars (e.g. a player whose race is being recorded) take part in the
+// test but are never moved or slowed; only the batch cars yield to them.
+
+#define CAR_CONTACT_SPEED_KEEP 0.5f // Speed kept by a car that drives into another
+
+typedef struct {
+    int capacity;         // Cars (batch + fixed) the grid has room for
+    int table_size;       // Hash buckets (power of two)
+    float cell_size;      // Grid cell edge, at least the car's bounding circle diameter
+    int* bucket_start;    // table_size + 1 offsets into sorted
+    int* sorted;          // Car numbers grouped by bucket
+    int* cell_x;          // Cell of each car
+    int* cell_z;
+    unsigned int* bucket;
+    float* corners;       // 8 floats per car: FL, FR, RL, RR corner x/z
+    float* sin_a;         // Heading sine/cosine per car
+    float* cos_a;
+    void* storage;
+
+    // Counts from the last resolveCarContacts call
+    int candidate_pairs;  // Pairs that passed the broad phase
+    int contact_count;    // Pairs found overlapping
+} CarContactGrid;
+
+// 'capacity' must cover the batch plus any fixed cars. 'tuning' gives the car
+// dimensions used for the cell size. Returns 1 on success.
+int initCarContactGrid(CarContactGrid* grid, int capacity, const Car* tuning);
+void freeCarContactGrid(CarContactGrid* grid);
+
+// Resolves contacts among the batch cars and between them and 'fixed'
+// (fixedCount cars, may be 0). Returns the number of overlapping pairs.
+int resolveCarContacts(CarContactGrid* grid, CarBatch* batch, const Car* fixed, int fixedCount);
+
+#endif // CAR_CONTACT_H
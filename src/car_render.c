@@ -0,0 +1,305 @@
+#include "car_render.h"  // Defines the renderer prototypes (and Car via car.h)
+#include "track_mesh.h"  // Mesh builder the car model is built with
+
+#include <GL/glew.h>     // For OpenGL types and the shader/instancing entry points
+#include <GL/freeglut.h> // For rendering primitives like glutSolidCube
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>     // offsetof
+
+// --- Car Model Layout ---
+// Shared by the immediate-mode path and the instanced model so both draw the
+// same car: a body box, four wheels and a helmet, relative to the car center.
+static const float WHEEL_COLOR[3] = {0.1f, 0.1f, 0.1f};
+static const float HELMET_COLOR[3] = {1.0f, 1.0f, 1.0f};
+static const float HELMET_SIZE = 0.15f;
+
+// --- Car Rendering --- (Code as provided by user)
+// Draws the car model (currently a composite cube structure) at its current position and orientation.
+static void renderCarColored(const Car* car, const float bodyColor[3]) {
+    glPushMatrix(); // Save the current OpenGL matrix state
+
+    // Apply transformations: Move to car's position and rotate to its angle.
+    // The rotation about the Y-axis is built from the heading's cached sine/cosine
+    // (the same matrix glRotatef(angle, 0, 1, 0) would make; column-major).
+    float s = car->heading_sin, c = car->heading_cos;
+    const GLfloat pose[16] = { c,      0.0f, -s,     0.0f,
+                               0.0f,   1.0f, 0.0f,   0.0f,
+                               s,      0.0f, c,      0.0f,
+                               car->x, car->y, car->z, 1.0f };
+    glMultMatrixf(pose);
+
+    // --- Car Body ---
+    glPushMatrix();
+    glScalef(car->width, car->height, car->length);
+    glColor3fv(bodyColor);
+    glutSolidCube(1.0f);
+    glPopMatrix();
+
+    // --- Wheels (Dark Grey Cubes) ---
+    float wheelRadius = 0.35f * car->height;
+    float wheelWidth = 0.15f * car->width;
+    float wheelDistX = (car->width / 2.0f) + wheelWidth * 0.5f;
+    float wheelDistZ = (car->length / 2.0f) * 0.7f;
+    glColor3fv(WHEEL_COLOR);
+    for (int wheel = 0; wheel < 4; ++wheel) { // FL, FR, RL, RR
+        glPushMatrix();
+        glTranslatef((wheel & 1) ? wheelDistX : -wheelDistX, 0.0f, (wheel & 2) ? -wheelDistZ : wheelDistZ);
+        glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+        glScalef(wheelWidth, wheelRadius * 2.0f, wheelRadius * 2.0f);
+        glutSolidCube(1.0f);
+        glPopMatrix();
+    }
+
+    // --- Driver Helmet Indicator (White Cube) ---
+    glPushMatrix();
+    glTranslatef(0.0f, car->height * 0.6f, -car->length * 0.1f);
+    glScalef(HELMET_SIZE, HELMET_SIZE, HELMET_SIZE);
+    glColor3fv(HELMET_COLOR);
+    glutSolidCube(1.0f);
+    glPopMatrix();
+
+    glPopMatrix(); // Restore the matrix state from before car transformations
+}
+
+void renderCar(const Car* car) {
+    static const float red[3] = {CAR_RENDER_COLOR_RED};
+    renderCarColored(car, red);
+}
+
+// --- Instanced Renderer ---
+// Per-vertex attributes: position, colour and 'tint' (1 on the body, which
+// takes the instance's colour). Per-instance: x, y, z and the heading's sine,
+// then the body colour and the heading's cosine (the cars' cached values, so
+// no trigonometry per vertex). The rotation matches glRotatef(angle, 0, 1, 0).
+static const char* CAR_VERTEX_SHADER =
+    "#version 120\n"
+    "attribute vec3 position;\n"
+    "attribute vec3 color;\n"
+    "attribute float tint;\n"
+    "attribute vec4 instancePose;\n"
+    "attribute vec4 instanceColor;\n"
+    "varying vec3 fragColor;\n"
+    "void main() {\n"
+    "    float s = instancePose.w, c = instanceColor.w;\n"
+    "    vec3 p = vec3(c * position.x + s * position.z, position.y, c * position.z - s * position.x);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p + instancePose.xyz, 1.0);\n"
+    "    fragColor = mix(color, instanceColor.rgb, tint);\n"
+    "}\n";
+static const char* CAR_FRAGMENT_SHADER =
+    "#version 120\n"
+    "varying vec3 fragColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(fragColor, 1.0);\n"
+    "}\n";
+
+enum { ATTRIB_POSITION, ATTRIB_COLOR, ATTRIB_TINT, ATTRIB_INSTANCE_POSE, ATTRIB_INSTANCE_COLOR };
+#define INSTANCE_FLOATS 8 // x, y, z, heading sine, r, g, b, heading cosine
+
+static int instancingReady = 0;
+static int useCoreInstancing = 0;  // GL 3.3 entry points, else the ARB ones
+static GLuint carProgram = 0;
+static GLuint modelVertexBuffer = 0, modelTintBuffer = 0, modelIndexBuffer = 0;
+static GLuint instanceBuffer = 0;
+static GLsizei modelIndexCount = 0;
+static float modelWidth = 0.0f, modelHeight = 0.0f, modelLength = 0.0f; // Dimensions the model was built for
+static float* instanceData = NULL;  // Staging copy of the instance buffer
+static int instanceCapacity = 0;
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Car shader compile failed: %s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint buildCarProgram() {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, CAR_VERTEX_SHADER);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, CAR_FRAGMENT_SHADER);
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, ATTRIB_POSITION, "position"); // Attribute 0 must be the position
+    glBindAttribLocation(program, ATTRIB_COLOR, "color");
+    glBindAttribLocation(program, ATTRIB_TINT, "tint");
+    glBindAttribLocation(program, ATTRIB_INSTANCE_POSE, "instancePose");
+    glBindAttribLocation(program, ATTRIB_INSTANCE_COLOR, "instanceColor");
+    glLinkProgram(program);
+    glDeleteShader(vs); // Flagged for deletion, freed with the program
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Car shader link failed: %s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// (Re)builds the model for the given car dimensions and uploads it. All cars
+// share one set of dimensions, so this normally runs once.
+static int uploadCarModel(const Car* car) {
+    TrackMesh mesh;
+    initTrackMesh(&mesh);
+    static const float white[3] = {1.0f, 1.0f, 1.0f}; // Body: replaced by the instance colour
+    addMeshBox(&mesh, 0.0f, 0.0f, 0.0f, car->width, car->height, car->length, white);
+    unsigned int bodyVertexCount = mesh.vertex_count;
+
+    float wheelRadius = 0.35f * car->height;
+    float wheelWidth = 0.15f * car->width;
+    float wheelDistX = (car->width / 2.0f) + wheelWidth * 0.5f;
+    float wheelDistZ = (car->length / 2.0f) * 0.7f;
+    for (int wheel = 0; wheel < 4; ++wheel) {
+        // Same box as the immediate path's scaled cube turned 90 degrees: the
+        // wheel width ends up along Z.
+        addMeshBox(&mesh, (wheel & 1) ? wheelDistX : -wheelDistX, 0.0f, (wheel & 2) ? -wheelDistZ : wheelDistZ,
+                   wheelRadius * 2.0f, wheelRadius * 2.0f, wheelWidth, WHEEL_COLOR);
+    }
+    addMeshBox(&mesh, 0.0f, car->height * 0.6f, -car->length * 0.1f, HELMET_SIZE, HELMET_SIZE, HELMET_SIZE, HELMET_COLOR);
+
+    float* tint = (float*)malloc(sizeof(float) * (mesh.vertex_count ? mesh.vertex_count : 1));
+    if (mesh.failed || !tint) {
+        free(tint);
+        freeTrackMesh(&mesh);
+        return 0;
+    }
+    for (unsigned int i = 0; i < mesh.vertex_count; ++i) tint[i] = (i < bodyVertexCount) ? 1.0f : 0.0f;
+
+    glBindBuffer(GL_ARRAY_BUFFER, modelVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(TrackVertex) * mesh.vertex_count, mesh.vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, modelTintBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(float) * mesh.vertex_count, tint, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, modelIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)sizeof(unsigned int) * mesh.index_count, mesh.indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    modelIndexCount = (GLsizei)mesh.index_count;
+    modelWidth = car->width;
+    modelHeight = car->height;
+    modelLength = car->length;
+
+    free(tint);
+    freeTrackMesh(&mesh);
+    return 1;
+}
+
+int initCarRenderer() {
+    useCoreInstancing = GLEW_VERSION_3_3;
+    if (!useCoreInstancing && !(GLEW_VERSION_2_0 && GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced)) {
+        printf("Car renderer: instancing not supported, drawing cars one at a time\n");
+        return 0;
+    }
+    carProgram = buildCarProgram();
+    if (!carProgram) return 0;
+    glGenBuffers(1, &modelVertexBuffer);
+    glGenBuffers(1, &modelTintBuffer);
+    glGenBuffers(1, &modelIndexBuffer);
+    glGenBuffers(1, &instanceBuffer);
+    instancingReady = 1;
+    printf("Car renderer: instanced\n");
+    return 1;
+}
+
+void freeCarRenderer() {
+    if (instancingReady) {
+        glDeleteBuffers(1, &modelVertexBuffer);
+        glDeleteBuffers(1, &modelTintBuffer);
+        glDeleteBuffers(1, &modelIndexBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteProgram(carProgram);
+    }
+    modelVertexBuffer = modelTintBuffer = modelIndexBuffer = instanceBuffer = carProgram = 0;
+    modelIndexCount = 0;
+    instancingReady = 0;
+    free(instanceData);
+    instanceData = NULL;
+    instanceCapacity = 0;
+}
+
+static void setAttribDivisor(GLuint index, GLuint divisor) {
+    if (useCoreInstancing) glVertexAttribDivisor(index, divisor);
+    else glVertexAttribDivisorARB(index, divisor);
+}
+
+// --- Drawing ---
+void renderCars(const Car* cars, const float* bodyColors, int count) {
+    static const float red[3] = {CAR_RENDER_COLOR_RED};
+    if (count <= 0) return;
+
+    if (instancingReady && (modelIndexCount == 0 || cars[0].width != modelWidth ||
+                            cars[0].height != modelHeight || cars[0].length != modelLength)) {
+        if (!uploadCarModel(&cars[0])) instancingReady = 0; // Out of memory: fall back
+    }
+    if (!instancingReady) {
+        for (int i = 0; i < count; ++i) renderCarColored(&cars[i], bodyColors ? &bodyColors[i * 3] : red);
+        return;
+    }
+
+    // Fill the instance data and stream it to the GPU (orphaning last frame's buffer).
+    if (count > instanceCapacity) {
+        int capacity = instanceCapacity ? instanceCapacity : 64;
+        while (capacity < count) capacity *= 2;
+        float* grown = (float*)realloc(instanceData, sizeof(float) * INSTANCE_FLOATS * capacity);
+        if (!grown) return;
+        instanceData = grown;
+        instanceCapacity = capacity;
+    }
+    for (int i = 0; i < count; ++i) {
+        const float* color = bodyColors ? &bodyColors[i * 3] : red;
+        float* d = &instanceData[i * INSTANCE_FLOATS];
+        d[0] = cars[i].x;
+        d[1] = cars[i].y;
+        d[2] = cars[i].z;
+        d[3] = cars[i].heading_sin;
+        d[4] = color[0];
+        d[5] = color[1];
+        d[6] = color[2];
+        d[7] = cars[i].heading_cos;
+    }
+    GLsizeiptr instanceBytes = (GLsizeiptr)sizeof(float) * INSTANCE_FLOATS * count;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instanceBytes, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceBytes, instanceData);
+
+    glUseProgram(carProgram);
+    GLsizei instanceStride = sizeof(float) * INSTANCE_FLOATS;
+    glVertexAttribPointer(ATTRIB_INSTANCE_POSE, 4, GL_FLOAT, GL_FALSE, instanceStride, (const GLvoid*)0);
+    glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 4, GL_FLOAT, GL_FALSE, instanceStride, (const GLvoid*)(sizeof(float) * 4));
+    glBindBuffer(GL_ARRAY_BUFFER, modelVertexBuffer);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(TrackVertex), (const GLvoid*)offsetof(TrackVertex, x));
+    glVertexAttribPointer(ATTRIB_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(TrackVertex), (const GLvoid*)offsetof(TrackVertex, r));
+    glBindBuffer(GL_ARRAY_BUFFER, modelTintBuffer);
+    glVertexAttribPointer(ATTRIB_TINT, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const GLvoid*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (GLuint a = ATTRIB_POSITION; a <= ATTRIB_INSTANCE_COLOR; ++a) glEnableVertexAttribArray(a);
+    setAttribDivisor(ATTRIB_INSTANCE_POSE, 1);
+    setAttribDivisor(ATTRIB_INSTANCE_COLOR, 1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, modelIndexBuffer);
+    if (useCoreInstancing) glDrawElementsInstanced(GL_TRIANGLES, modelIndexCount, GL_UNSIGNED_INT, (const GLvoid*)0, count);
+    else glDrawElementsInstancedARB(GL_TRIANGLES, modelIndexCount, GL_UNSIGNED_INT, (const GLvoid*)0, count);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Restore the state the fixed-function code expects
+    setAttribDivisor(ATTRIB_INSTANCE_POSE, 0);
+    setAttribDivisor(ATTRIB_INSTANCE_COLOR, 0);
+    for (GLuint a = ATTRIB_POSITION; a <= ATTRIB_INSTANCE_COLOR; ++a) glDisableVertexAttribArray(a);
+    glUseProgram(0);
+}
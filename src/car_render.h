@@ -0,0 +1,21 @@
+#ifndef CAR_RENDER_H
+#define CAR_RENDER_H
+
+#include "car.h" // Car
+
+// --- Car Rendering ---
+// Cars are drawn by an instanced renderer: the car model is uploaded once and
+// every car is one instance (position, heading and body colour) of a single
+// instanced draw call, so drawing a full grid costs about the same as one
+// car. Needs GL 3.3 (or GL 2.0 with ARB_instanced_arrays and
+// ARB_draw_instanced); otherwise each car is drawn with renderCar.
+
+#define CAR_RENDER_COLOR_RED 1.0f, 0.0f, 0.0f // Default body colour (the player's car)
+
+int initCarRenderer();    // Call once after glewInit; returns 1 if instancing is in use
+void freeCarRenderer();
+// Draws 'count' cars. bodyColors holds an RGB triple per car, or is NULL for all red.
+void renderCars(const Car* cars, const float* bodyColors, int count);
+void renderCar(const Car* car); // Single car, immediate mode (the fallback path)
+
+#endif // CAR_RENDER_H
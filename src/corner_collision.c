@@ -0,0 +1,224 @@
+#include "corner_collision.h"
+#include "track_rect.h"
+#include "track_round.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CORNER_COLLISION_SSE2 1
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CORNER_COLLISION_AVX 1
+#endif
+
+// Corner order matches calculateCarCorners: FL, FR, RL, RR.
+// Local X is -half_width for the left corners, local Z is +half_length at the front.
+// World X = CenterX + LocalX * cos + LocalZ * sin
+// World Z = CenterZ - LocalX * sin + LocalZ * cos
+
+
+// The SIMD kernels only know the two built-in analytic shapes. Grid queries
+// (the track's query_backend, custom tracks) go through isPositionOnTrack.
+static int usesAnalyticKernels(const SimTrack* track) {
+    return track->query_backend == TRACK_QUERY_ANALYTIC && track->type != TRACK_CUSTOM;
+}
+
+// --- Scalar Fallback ---
+// Also used for the distance grid backend, which isPositionOnTrack handles.
+static int isPointOnTrackScalar(const SimTrack* track, float x, float z) {
+    return isPositionOnTrack(track, x, z);
+}
+
+static int areCarCornersOnTrackScalar(const SimTrack* track, float cx, float cz,
+                                      float s, float c, float hw, float hl) {
+    return isPointOnTrackScalar(track, cx + (-hw) * c + hl * s,    cz - (-hw) * s + hl * c) &&
+           isPointOnTrackScalar(track, cx + hw * c + hl * s,       cz - hw * s + hl * c) &&
+           isPointOnTrackScalar(track, cx + (-hw) * c + (-hl) * s, cz - (-hw) * s + (-hl) * c) &&
+           isPointOnTrackScalar(track, cx + hw * c + (-hl) * s,    cz - hw * s + (-hl) * c);
+}
+
+
+#ifdef CORNER_COLLISION_SSE2
+// --- SSE2 Point Tests (4 points per call, all-ones lane = on track) ---
+static __m128 absPs(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static __m128 onRectTrackPs(__m128 x, __m128 z) {
+    __m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(x, _mm_set1_ps(RECT_COLLIDE_OUTER_X_POS)),
+                                         _mm_cmplt_ps(x, _mm_set1_ps(RECT_COLLIDE_OUTER_X_NEG))),
+                               _mm_or_ps(_mm_cmpgt_ps(z, _mm_set1_ps(RECT_COLLIDE_OUTER_Z_POS)),
+                                         _mm_cmplt_ps(z, _mm_set1_ps(RECT_COLLIDE_OUTER_Z_NEG))));
+    __m128 inHole = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(x, _mm_set1_ps(RECT_COLLIDE_INNER_X_POS)),
+                                          _mm_cmpgt_ps(x, _mm_set1_ps(RECT_COLLIDE_INNER_X_NEG))),
+                               _mm_and_ps(_mm_cmplt_ps(z, _mm_set1_ps(RECT_COLLIDE_INNER_Z_POS)),
+                                          _mm_cmpgt_ps(z, _mm_set1_ps(RECT_COLLIDE_INNER_Z_NEG))));
+    // on = !outside && !inHole
+    return _mm_andnot_ps(_mm_or_ps(outside, inHole), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+}
+
+static __m128 onRoundTrackPs(__m128 x, __m128 z) {
+    __m128 ax = absPs(x);
+    __m128 az = absPs(z);
+    __m128 xLimit = _mm_set1_ps(ROUND_STRAIGHT_X_LIMIT);
+    __m128 zLimit = _mm_set1_ps(ROUND_STRAIGHT_Z_LIMIT);
+
+    // Top/bottom straights
+    __m128 onTopBottom = _mm_and_ps(_mm_cmple_ps(ax, xLimit),
+                                    _mm_and_ps(_mm_cmpge_ps(az, _mm_set1_ps(ROUND_COLLIDE_Z_MIN)),
+                                               _mm_cmple_ps(az, _mm_set1_ps(ROUND_COLLIDE_Z_MAX))));
+    // Left/right straights
+    __m128 onLeftRight = _mm_and_ps(_mm_cmple_ps(az, zLimit),
+                                    _mm_and_ps(_mm_cmpge_ps(ax, _mm_set1_ps(ROUND_COLLIDE_X_MIN)),
+                                               _mm_cmple_ps(ax, _mm_set1_ps(ROUND_COLLIDE_X_MAX))));
+    // Corners, folded into the +X/+Z quadrant
+    __m128 inCorner = _mm_and_ps(_mm_cmpgt_ps(ax, xLimit), _mm_cmpgt_ps(az, zLimit));
+    __m128 dx = _mm_sub_ps(ax, xLimit);
+    __m128 dz = _mm_sub_ps(az, zLimit);
+    __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+    __m128 onCorner = _mm_and_ps(inCorner,
+                                 _mm_and_ps(_mm_cmpge_ps(distSq, _mm_set1_ps(ROUND_COLLIDE_INNER_RADIUS_SQ)),
+                                            _mm_cmple_ps(distSq, _mm_set1_ps(ROUND_COLLIDE_OUTER_RADIUS_SQ))));
+    return _mm_or_ps(_mm_or_ps(onTopBottom, onLeftRight), onCorner);
+}
+
+static __m128 onTrackPs(TrackType track, __m128 x, __m128 z) {
+    return (track == TRACK_RECT) ? onRectTrackPs(x, z) : onRoundTrackPs(x, z);
+}
+
+// World position of one corner for four cars at once (local offsets lx, lz).
+static void cornerPs(__m128 cx, __m128 cz, __m128 s, __m128 c, float lx, float lz, __m128* wx, __m128* wz) {
+    __m128 vlx = _mm_set1_ps(lx);
+    __m128 vlz = _mm_set1_ps(lz);
+    *wx = _mm_add_ps(_mm_add_ps(cx, _mm_mul_ps(vlx, c)), _mm_mul_ps(vlz, s));
+    *wz = _mm_add_ps(_mm_sub_ps(cz, _mm_mul_ps(vlx, s)), _mm_mul_ps(vlz, c));
+}
+#endif // CORNER_COLLISION_SSE2
+
+
+#ifdef CORNER_COLLISION_AVX
+// --- AVX Point Tests (8 points per call) ---
+static __m256 absPs256(__m256 v) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+static __m256 onRectTrackPs256(__m256 x, __m256 z) {
+    __m256 outside = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(x, _mm256_set1_ps(RECT_COLLIDE_OUTER_X_POS), _CMP_GT_OQ),
+                                               _mm256_cmp_ps(x, _mm256_set1_ps(RECT_COLLIDE_OUTER_X_NEG), _CMP_LT_OQ)),
+                                  _mm256_or_ps(_mm256_cmp_ps(z, _mm256_set1_ps(RECT_COLLIDE_OUTER_Z_POS), _CMP_GT_OQ),
+                                               _mm256_cmp_ps(z, _mm256_set1_ps(RECT_COLLIDE_OUTER_Z_NEG), _CMP_LT_OQ)));
+    __m256 inHole = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(RECT_COLLIDE_INNER_X_POS), _CMP_LT_OQ),
+                                                _mm256_cmp_ps(x, _mm256_set1_ps(RECT_COLLIDE_INNER_X_NEG), _CMP_GT_OQ)),
+                                  _mm256_and_ps(_mm256_cmp_ps(z, _mm256_set1_ps(RECT_COLLIDE_INNER_Z_POS), _CMP_LT_OQ),
+                                                _mm256_cmp_ps(z, _mm256_set1_ps(RECT_COLLIDE_INNER_Z_NEG), _CMP_GT_OQ)));
+    return _mm256_andnot_ps(_mm256_or_ps(outside, inHole), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+}
+
+static __m256 onRoundTrackPs256(__m256 x, __m256 z) {
+    __m256 ax = absPs256(x);
+    __m256 az = absPs256(z);
+    __m256 xLimit = _mm256_set1_ps(ROUND_STRAIGHT_X_LIMIT);
+    __m256 zLimit = _mm256_set1_ps(ROUND_STRAIGHT_Z_LIMIT);
+
+    __m256 onTopBottom = _mm256_and_ps(_mm256_cmp_ps(ax, xLimit, _CMP_LE_OQ),
+                                       _mm256_and_ps(_mm256_cmp_ps(az, _mm256_set1_ps(ROUND_COLLIDE_Z_MIN), _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(az, _mm256_set1_ps(ROUND_COLLIDE_Z_MAX), _CMP_LE_OQ)));
+    __m256 onLeftRight = _mm256_and_ps(_mm256_cmp_ps(az, zLimit, _CMP_LE_OQ),
+                                       _mm256_and_ps(_mm256_cmp_ps(ax, _mm256_set1_ps(ROUND_COLLIDE_X_MIN), _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(ax, _mm256_set1_ps(ROUND_COLLIDE_X_MAX), _CMP_LE_OQ)));
+    __m256 inCorner = _mm256_and_ps(_mm256_cmp_ps(ax, xLimit, _CMP_GT_OQ), _mm256_cmp_ps(az, zLimit, _CMP_GT_OQ));
+    __m256 dx = _mm256_sub_ps(ax, xLimit);
+    __m256 dz = _mm256_sub_ps(az, zLimit);
+    __m256 distSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+    __m256 onCorner = _mm256_and_ps(inCorner,
+                                    _mm256_and_ps(_mm256_cmp_ps(distSq, _mm256_set1_ps(ROUND_COLLIDE_INNER_RADIUS_SQ), _CMP_GE_OQ),
+                                                  _mm256_cmp_ps(distSq, _mm256_set1_ps(ROUND_COLLIDE_OUTER_RADIUS_SQ), _CMP_LE_OQ)));
+    return _mm256_or_ps(_mm256_or_ps(onTopBottom, onLeftRight), onCorner);
+}
+
+static __m256 onTrackPs256(TrackType track, __m256 x, __m256 z) {
+    return (track == TRACK_RECT) ? onRectTrackPs256(x, z) : onRoundTrackPs256(x, z);
+}
+
+static void cornerPs256(__m256 cx, __m256 cz, __m256 s, __m256 c, float lx, float lz, __m256* wx, __m256* wz) {
+    __m256 vlx = _mm256_set1_ps(lx);
+    __m256 vlz = _mm256_set1_ps(lz);
+    *wx = _mm256_add_ps(_mm256_add_ps(cx, _mm256_mul_ps(vlx, c)), _mm256_mul_ps(vlz, s));
+    *wz = _mm256_add_ps(_mm256_sub_ps(cz, _mm256_mul_ps(vlx, s)), _mm256_mul_ps(vlz, c));
+}
+#endif // CORNER_COLLISION_AVX
+
+
+// --- Single Car: four corners in one SSE register ---
+int areCarCornersOnTrack(const SimTrack* track, float center_x, float center_z,
+                         float sin_a, float cos_a, float half_width, float half_length) {
+    if (!usesAnalyticKernels(track)) {
+        return areCarCornersOnTrackScalar(track, center_x, center_z, sin_a, cos_a, half_width, half_length);
+    }
+#ifdef CORNER_COLLISION_SSE2
+    // Lanes hold FL, FR, RL, RR (_mm_set_ps takes the highest lane first)
+    __m128 lx = _mm_set_ps(half_width, -half_width, half_width, -half_width);
+    __m128 lz = _mm_set_ps(-half_length, -half_length, half_length, half_length);
+    __m128 s = _mm_set1_ps(sin_a);
+    __m128 c = _mm_set1_ps(cos_a);
+    __m128 wx = _mm_add_ps(_mm_add_ps(_mm_set1_ps(center_x), _mm_mul_ps(lx, c)), _mm_mul_ps(lz, s));
+    __m128 wz = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(center_z), _mm_mul_ps(lx, s)), _mm_mul_ps(lz, c));
+    return _mm_movemask_ps(onTrackPs(track->type, wx, wz)) == 0xF;
+#else
+    return areCarCornersOnTrackScalar(track, center_x, center_z, sin_a, cos_a, half_width, half_length);
+#endif
+}
+
+
+// --- Many Cars: one corner of 8 (AVX) or 4 (SSE2) cars per register ---
+void areCarCornersOnTrackBatch(const SimTrack* track, int count,
+                               const float* center_x, const float* center_z,
+                               const float* sin_a, const float* cos_a,
+                               float half_width, float half_length,
+                               unsigned char* on_track) {
+    int i = 0;
+#if defined(CORNER_COLLISION_SSE2) || defined(CORNER_COLLISION_AVX)
+    int simd_count = usesAnalyticKernels(track) ? count : 0; // Grid queries all go to the scalar loop
+    const float lxs[4] = { -half_width, half_width, -half_width, half_width };
+    const float lzs[4] = { half_length, half_length, -half_length, -half_length };
+#endif
+
+#ifdef CORNER_COLLISION_AVX
+    for (; i + 8 <= simd_count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(center_x + i);
+        __m256 cz = _mm256_loadu_ps(center_z + i);
+        __m256 s = _mm256_loadu_ps(sin_a + i);
+        __m256 c = _mm256_loadu_ps(cos_a + i);
+        __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int k = 0; k < 4; ++k) {
+            __m256 wx, wz;
+            cornerPs256(cx, cz, s, c, lxs[k], lzs[k], &wx, &wz);
+            all = _mm256_and_ps(all, onTrackPs256(track->type, wx, wz));
+        }
+        int mask = _mm256_movemask_ps(all);
+        for (int j = 0; j < 8; ++j) on_track[i + j] = (unsigned char)((mask >> j) & 1);
+    }
+#endif
+#ifdef CORNER_COLLISION_SSE2
+    for (; i + 4 <= simd_count; i += 4) {
+        __m128 cx = _mm_loadu_ps(center_x + i);
+        __m128 cz = _mm_loadu_ps(center_z + i);
+        __m128 s = _mm_loadu_ps(sin_a + i);
+        __m128 c = _mm_loadu_ps(cos_a + i);
+        __m128 all = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int k = 0; k < 4; ++k) {
+            __m128 wx, wz;
+            cornerPs(cx, cz, s, c, lxs[k], lzs[k], &wx, &wz);
+            all = _mm_and_ps(all, onTrackPs(track->type, wx, wz));
+        }
+        int mask = _mm_movemask_ps(all);
+        for (int j = 0; j < 4; ++j) on_track[i + j] = (unsigned char)((mask >> j) & 1);
+    }
+#endif
+    // Remaining cars (or everything, without SIMD)
+    for (; i < count; ++i) {
+        on_track[i] = (unsigned char)areCarCornersOnTrackScalar(track, center_x[i], center_z[i],
+                                                                sin_a[i], cos_a[i], half_width, half_length);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef CORNER_COLLISION_H
+#define CORNER_COLLISION_H
+
+#include "sim.h" // SimTrack
+
+// --- Four-Corner Track Collision Kernels ---
+// Transform a car's four corners (same layout as calculateCarCorners) and test
+// them against the rectangular or rounded track in one pass. Results match
+// calculateCarCorners() + isPositionOnRectTrack()/isPositionOnRoundTrack()
+// exactly. SSE2 is used when available (always on x86-64), the batch kernel
+// uses AVX when compiled with -mavx, and a scalar version is used elsewhere.
+// sin_a/cos_a are the sine and cosine of the car heading in radians.
+// With the track's query_backend set to TRACK_QUERY_GRID, and always for
+// TRACK_CUSTOM, the corners are looked up in the track's distance grid instead.
+
+// Returns 1 if all four corners of the car are on the track.
+int areCarCornersOnTrack(const SimTrack* track, float center_x, float center_z,
+                         float sin_a, float cos_a, float half_width, float half_length);
+
+// Tests 'count' cars (arrays indexed by car) and writes 1/0 per car to on_track.
+void areCarCornersOnTrackBatch(const SimTrack* track, int count,
+                               const float* center_x, const float* center_z,
+                               const float* sin_a, const float* cos_a,
+                               float half_width, float half_length,
+                               unsigned char* on_track);
+
+#endif // CORNER_COLLISION_H
@@ -0,0 +1,210 @@
+#include "driver.h"
+#include "track_rect.h"
+#include "track_round.h"
+#include "track_file.h"  // Centerline samples of custom tracks
+#include "platform.h"    // runPlatformOnce for the built-in paths
+#include "sim_math.h"    // M_PI, RAD_TO_DEG, getHeadingSinCos
+#include <math.h>
+
+// --- Centerline Path Settings ---
+#define PATH_MAX_POINTS 1024
+#define PATH_SPACING 1.0f         // Approximate distance between centerline samples
+#define STEER_LOOKAHEAD 8         // Samples ahead used as the steering target
+#define BRAKE_LOOKAHEAD 26        // Samples ahead checked for an upcoming corner
+#define STEER_DEADZONE_DEG 2.0f   // Heading error ignored to avoid oscillation
+#define SEARCH_WINDOW 12          // Samples searched either side of the hint
+
+// A view of a track's centerline samples. The built-in tracks' paths are
+// built once, on first use from whichever thread asks first; custom tracks
+// read the samples straight from the track file (stride between samples).
+typedef struct {
+    int count;
+    int stride;        // Distance between consecutive samples in floats
+    const float* x;
+    const float* z;
+} CenterlinePath;
+
+typedef struct {
+    int count;
+    float xs[PATH_MAX_POINTS];
+    float zs[PATH_MAX_POINTS];
+} BuiltInPath;
+
+static BuiltInPath builtInPaths[2];
+static int builtInPathReady[2]; // runPlatformOnce flags
+
+#define PATH_X(path, i) ((path)->x[(size_t)(i) * (path)->stride])
+#define PATH_Z(path, i) ((path)->z[(size_t)(i) * (path)->stride])
+
+// --- Path Building Helpers ---
+static void addPathPoint(BuiltInPath* path, float x, float z) {
+    if (path->count < PATH_MAX_POINTS) {
+        path->xs[path->count] = x;
+        path->zs[path->count] = z;
+        path->count++;
+    }
+}
+
+// Adds samples along a straight line from (x1,z1) up to (but excluding) (x2,z2).
+static void addPathLine(BuiltInPath* path, float x1, float z1, float x2, float z2) {
+    float len = sqrtf((x2 - x1) * (x2 - x1) + (z2 - z1) * (z2 - z1));
+    int steps = (int)(len / PATH_SPACING);
+    if (steps < 1) steps = 1;
+    for (int i = 0; i < steps; ++i) {
+        float t = (float)i / steps;
+        addPathPoint(path, x1 + (x2 - x1) * t, z1 + (z2 - z1) * t);
+    }
+}
+
+// Adds samples along a 90-degree arc, excluding the end point (same angle convention as track_round.c).
+// The points go through getHeadingSinCos so the centerline (and the track
+// progress and grid built from it) is the same whatever the C library in
+// deterministic builds.
+static void addPathArc(BuiltInPath* path, float cx, float cz, float radius, float start_angle_deg) {
+    int steps = (int)((float)(M_PI / 2.0) * radius / PATH_SPACING);
+    if (steps < 1) steps = 1;
+    for (int i = 0; i < steps; ++i) {
+        float s, c;
+        getHeadingSinCos(start_angle_deg + 90.0f * (float)i / (float)steps, &s, &c);
+        addPathPoint(path, cx + radius * c, cz + radius * s);
+    }
+}
+
+// Builds a built-in centerline in driving order: up the right straight (+Z)
+// and round the track through the top, left and bottom sections.
+static int buildBuiltInPath(void* arg) {
+    TrackType track = *(const TrackType*)arg;
+    BuiltInPath* path = &builtInPaths[track == TRACK_RECT ? 0 : 1];
+    path->count = 0;
+    if (track == TRACK_RECT) {
+        float cx = (RECT_INNER_X_POS + RECT_OUTER_X_POS) / 2.0f;
+        float cz = (RECT_INNER_Z_POS + RECT_OUTER_Z_POS) / 2.0f;
+        addPathLine(path,  cx, -cz,  cx,  cz); // Right straight
+        addPathLine(path,  cx,  cz, -cx,  cz); // Top straight
+        addPathLine(path, -cx,  cz, -cx, -cz); // Left straight
+        addPathLine(path, -cx, -cz,  cx, -cz); // Bottom straight
+    } else { // TRACK_ROUNDED
+        float sx = ROUND_TRACK_MAIN_WIDTH / 2.0f;
+        float sz = ROUND_TRACK_MAIN_LENGTH / 2.0f;
+        addPathLine(path, sx, -ROUND_STRAIGHT_Z_LIMIT, sx, ROUND_STRAIGHT_Z_LIMIT);
+        addPathArc(path, ROUND_CORNER_CENTER_TR_X, ROUND_CORNER_CENTER_TR_Z, ROUND_CORNER_RADIUS, 0.0f);
+        addPathLine(path, ROUND_STRAIGHT_X_LIMIT, sz, -ROUND_STRAIGHT_X_LIMIT, sz);
+        addPathArc(path, ROUND_CORNER_CENTER_TL_X, ROUND_CORNER_CENTER_TL_Z, ROUND_CORNER_RADIUS, 90.0f);
+        addPathLine(path, -sx, ROUND_STRAIGHT_Z_LIMIT, -sx, -ROUND_STRAIGHT_Z_LIMIT);
+        addPathArc(path, ROUND_CORNER_CENTER_BL_X, ROUND_CORNER_CENTER_BL_Z, ROUND_CORNER_RADIUS, 180.0f);
+        addPathLine(path, -ROUND_STRAIGHT_X_LIMIT, -sz, ROUND_STRAIGHT_X_LIMIT, -sz);
+        addPathArc(path, ROUND_CORNER_CENTER_BR_X, ROUND_CORNER_CENTER_BR_Z, ROUND_CORNER_RADIUS, 270.0f);
+    }
+    return 1;
+}
+
+// Fills 'out' with the track's centerline and returns it (count 0 for a
+// custom track with no file).
+static const CenterlinePath* getCenterlinePath(const SimTrack* track, CenterlinePath* out) {
+    out->count = 0;
+    out->stride = 1;
+    out->x = out->z = NULL;
+    if (track->type == TRACK_CUSTOM) {
+        const TrackData* data = track->data;
+        if (data) {
+            out->count = (int)data->header->sample_count;
+            out->stride = (int)(sizeof(TrackSample) / sizeof(float));
+            out->x = &data->samples[0].x;
+            out->z = &data->samples[0].z;
+        }
+        return out;
+    }
+    TrackType type = track->type;
+    int i = (type == TRACK_RECT) ? 0 : 1;
+    runPlatformOnce(&builtInPathReady[i], buildBuiltInPath, &type); // Cannot fail
+    out->count = builtInPaths[i].count;
+    out->x = builtInPaths[i].xs;
+    out->z = builtInPaths[i].zs;
+    return out;
+}
+
+// Wraps an angle difference in degrees into [-180, 180).
+static float wrapAngleDeg(float a) {
+    a = fmodf(a + 180.0f, 360.0f);
+    if (a < 0.0f) a += 360.0f;
+    return a - 180.0f;
+}
+
+// Heading (degrees, car convention: 0 = +Z, 90 = +X) from one point to another.
+static float headingTo(float x1, float z1, float x2, float z2) {
+    return RAD_TO_DEG(atan2f(x2 - x1, z2 - z1));
+}
+
+// Index of the sample nearest to (x,z), searching the whole path.
+static int findNearestPoint(const CenterlinePath* path, float x, float z) {
+    int best = 0;
+    float bestDistSq = 1e30f;
+    for (int i = 0; i < path->count; ++i) {
+        float dx = PATH_X(path, i) - x; float dz = PATH_Z(path, i) - z;
+        float d = dx * dx + dz * dz;
+        if (d < bestDistSq) { bestDistSq = d; best = i; }
+    }
+    return best;
+}
+
+
+int getCenterlineSamples(const SimTrack* track, float* xs, float* zs, int maxCount) {
+    CenterlinePath line;
+    const CenterlinePath* path = getCenterlinePath(track, &line);
+    int n = path->count < maxCount ? path->count : maxCount;
+    for (int i = 0; i < n; ++i) {
+        xs[i] = PATH_X(path, i);
+        zs[i] = PATH_Z(path, i);
+    }
+    return path->count;
+}
+
+
+// --- Autopilot Initialization ---
+void initAutopilot(Autopilot* pilot, const SimTrack* track, const Car* car) {
+    pilot->track = *track;
+    CenterlinePath line;
+    pilot->pathIndex = findNearestPoint(getCenterlinePath(track, &line), car->x, car->z);
+    pilot->corner_speed = AUTOPILOT_CORNER_SPEED;
+}
+
+
+// --- Autopilot Update ---
+// Called once per physics tick before updateCar().
+void updateAutopilot(Autopilot* pilot, Car* car) {
+    CenterlinePath line;
+    const CenterlinePath* path = getCenterlinePath(&pilot->track, &line);
+    int n = path->count;
+    if (n == 0) return; // Custom track not loaded
+
+    // Track the nearest sample with a local search around the previous one.
+    int best = pilot->pathIndex;
+    float bestDistSq = 1e30f;
+    for (int k = -SEARCH_WINDOW; k <= SEARCH_WINDOW; ++k) {
+        int i = ((pilot->pathIndex + k) % n + n) % n;
+        float dx = PATH_X(path, i) - car->x; float dz = PATH_Z(path, i) - car->z;
+        float d = dx * dx + dz * dz;
+        if (d < bestDistSq) { bestDistSq = d; best = i; }
+    }
+    pilot->pathIndex = best;
+
+    // --- Steering: aim at a point a fixed distance ahead on the centerline ---
+    int target = (best + STEER_LOOKAHEAD) % n;
+    float error = wrapAngleDeg(headingTo(car->x, car->z, PATH_X(path, target), PATH_Z(path, target)) - car->angle);
+    car->turning_left = (error > STEER_DEADZONE_DEG);   // Positive angle change turns left
+    car->turning_right = (error < -STEER_DEADZONE_DEG);
+
+    // --- Throttle: slow down for the largest direction change coming up ---
+    int ahead = (best + BRAKE_LOOKAHEAD) % n;
+    int next = (best + 1) % n;
+    int aheadNext = (ahead + 1) % n;
+    float turnAhead = fabsf(wrapAngleDeg(headingTo(PATH_X(path, ahead), PATH_Z(path, ahead), PATH_X(path, aheadNext), PATH_Z(path, aheadNext)) -
+                                         headingTo(PATH_X(path, best), PATH_Z(path, best), PATH_X(path, next), PATH_Z(path, next))));
+    float turnFactor = fminf(1.0f, turnAhead / 90.0f);
+    float targetSpeed = car->max_speed - (car->max_speed - pilot->corner_speed) * turnFactor;
+    // Still turning hard: hold corner speed until the car is pointed down the road.
+    if (fabsf(error) > 20.0f) targetSpeed = fminf(targetSpeed, pilot->corner_speed);
+
+    car->accelerating = (car->speed < targetSpeed);
+    car->braking = (car->speed > targetSpeed + 1.0f);
+}
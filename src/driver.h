@@ -0,0 +1,27 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "sim.h" // Car struct and SimTrack
+
+// --- Autopilot ---
+// A simple scripted driver for runs without a keyboard (headless runner,
+// batch tools). It follows the track centerline with a fixed lookahead and
+// brakes ahead of corners. It only writes the car's control flags; physics
+// is still done by updateCar().
+typedef struct {
+    SimTrack track;  // Track whose centerline is followed
+    int pathIndex;   // Index of the nearest centerline sample (search hint)
+    float corner_speed; // Target speed through a 90-degree corner (AUTOPILOT_CORNER_SPEED unless changed)
+} Autopilot;
+
+#define AUTOPILOT_CORNER_SPEED 10.0f
+
+void initAutopilot(Autopilot* pilot, const SimTrack* track, const Car* car);
+void updateAutopilot(Autopilot* pilot, Car* car); // Sets accelerating/braking/turning_* on the car
+
+// Copies up to maxCount centerline samples (in driving order, about one unit
+// apart) into xs/zs and returns how many there are. The racing-line AI
+// (ai_driver.h) builds its line from these.
+int getCenterlineSamples(const SimTrack* track, float* xs, float* zs, int maxCount);
+
+#endif // DRIVER_H
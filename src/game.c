@@ -6,73 +6,345 @@
 #include <math.h>
 #include <limits.h>
 
-// Include BOTH track headers - the code uses constants/functions from one based on selectedTrackType
+// Include BOTH track headers - the code uses constants/functions from one based on the race's track
 #include "track_rect.h"
 #include "track_round.h"
-
-// Define M_PI if not already defined by math.h
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-// Macro for converting degrees to radians
-#define DEG_TO_RAD(angle) ((angle) * M_PI / 180.0f)
+#include "track_grid.h"     // getTrackGrid for the 'G' backend toggle
+#include "track_renderer.h" // Track geometry is built when a race starts
+#include "profiler.h"       // Profiler panel and CSV export
+#include "replay.h"         // Input recording of each race
+#include "telemetry.h"      // Optional per-tick telemetry log
+#include "car_batch.h"      // Opponent cars
+#include "ai_driver.h"      // Opponent controllers
+#include "car_contact.h"    // Opponent car-to-car contacts
+#include "standings.h"      // Race order and gaps shown in the HUD
+#include "snapshot.h"       // Rewind keyframes
+#include "netplay.h"        // Races against other players over the network
+#include "car_render.h"     // renderCars
+#include "text_renderer.h"  // HUD and menu text
+#include "sim_math.h"       // M_PI
+#include <stdlib.h>
+
+#define HUD_STANDINGS_ROWS 10 // Places listed in the standings panel (plus the player's)
 
 // --- Global Variable Definitions ---
 // Declared 'extern' in game.h, defined here with initial values.
 GameState currentGameState = STATE_MENU;     // Start the game in the menu state
-TrackType selectedTrackType = TRACK_RECT; // Default track type for internal logic (will be overwritten by menu)
 int menuSelectionIndex = 0;              // Index of the currently highlighted menu option (0-based)
-Car playerCar;                           // The player's car object
-int lapStartTimeMs = 0;                  // Milliseconds timestamp when the current lap started
-int currentLapTimeMs = 0;                // Milliseconds duration of the lap currently in progress
-int lastLapTimeMs = 0;                   // Milliseconds duration of the previously completed lap
-int bestLapTimeMs = INT_MAX;             // Milliseconds duration of the fastest completed lap
-int crossedFinishLineMovingForwardState = 0; // Boolean flag (0=false, 1=true) for lap detection
+const char* customTrackPath = CUSTOM_TRACK_DEFAULT_PATH; // Can be overridden on the command line
+int physicsTickRate = SIM_DEFAULT_TICK_RATE;           // Can be overridden on the command line
+SimContext raceSim;                                    // The player's race, set up by main
+Car renderPlayerCar;                                   // Interpolated copy of raceSim.car for drawing
+int opponentCount = 0;                                 // Can be overridden on the command line
+const char* netplayAddress = NULL;                     // Set with --connect
+
+// --- Fixed-Step Clock ---
+static Car previousPlayerCar;          // raceSim.car before the last tick (interpolation start)
+static double tickAccumulator = 0.0;   // Wall time not yet simulated (seconds)
+static int lastUpdateTimeMs = 0;       // GLUT time of the previous idle call
+
+// --- Race Recording ---
+static Replay raceReplay;              // Inputs of the race in progress
+static int raceReplayActive = 0;
+
+// --- Telemetry ---
+static TelemetryLog telemetryLog;      // Only open when requested on the command line
+
+// --- Opponents ---
+// Simulated as one CarBatch; the render list holds the player's car followed
+// by every opponent, interpolated between ticks like the player's car.
+static CarBatch opponents;
+static RacingLine opponentLine;
+static CarContactGrid opponentContacts;
+static AIDriver* opponentDrivers = NULL;
+static Car* previousOpponents = NULL;  // Opponent states before the last tick
+static Car* renderCarList = NULL;      // 1 + opponentCount cars, drawn by renderRaceCars
+static float* renderCarColors = NULL;  // RGB per car in renderCarList
+static int opponentsActive = 0;
+static Standings raceStandings;        // Player is entry 0, opponent i is entry i + 1
+static int standingsActive = 0;
+
+// --- Rewind ---
+static SnapshotRing raceKeyframes;     // Empty if it could not be allocated
+
+// --- Netplay ---
+// The client runs every player's race; raceSim is a copy of the local
+// player's, so the HUD and camera work as in a local race.
+static NetClient netClient;
+static int netplayActive = 0;          // Joining or racing on a server
+static int netRaceReported = 0;        // Result printed once the server's race length is reached
+static Car previousNetCars[NET_MAX_PLAYERS]; // Every player's car before the last tick
+static Car renderNetCars[NET_MAX_PLAYERS];
+static float netCarColors[NET_MAX_PLAYERS * 3];
 
 // --- Function to switch track ---
 void switchTrack(TrackType newType) {
-    selectedTrackType = newType;
+    raceSim.track.type = newType;
+    raceSim.track.data = NULL; // startGame loads the file of a custom track
+}
+
+// --- Race Recording ---
+// Every race is recorded; when it ends (reset, back to the menu, window
+// closed) its inputs are saved to REPLAY_PATH for 'headless --replay'.
+void saveRaceReplay() {
+    if (!raceReplayActive) return;
+    if (raceReplay.tick_count > 0) {
+        finishReplay(&raceReplay, &raceSim);
+        if (writeReplayFile(&raceReplay, REPLAY_PATH)) {
+            printf("Race saved to %s (%u ticks, %u input runs).\n", REPLAY_PATH, raceReplay.tick_count, raceReplay.run_count);
+        }
+    }
+    freeReplay(&raceReplay);
+    raceReplayActive = 0;
+}
+
+// --- Telemetry ---
+// Logs every physics tick of every race to 'path' until the game exits.
+int openGameTelemetry(const char* path) {
+    if (!openTelemetryLog(&telemetryLog, path, physicsTickRate)) return 0;
+    printf("Telemetry: logging every tick to %s\n", path);
+    return 1;
+}
+
+void closeGameTelemetry() {
+    closeTelemetryLog(&telemetryLog);
+}
+
+// --- Opponents ---
+static void freeOpponents() {
+    if (!opponentsActive) return;
+    freeCarBatch(&opponents);
+    freeRacingLine(&opponentLine);
+    freeCarContactGrid(&opponentContacts);
+    if (standingsActive) freeStandings(&raceStandings);
+    standingsActive = 0;
+    free(opponentDrivers); opponentDrivers = NULL;
+    free(previousOpponents); previousOpponents = NULL;
+    free(renderCarList); renderCarList = NULL;
+    free(renderCarColors); renderCarColors = NULL;
+    opponentsActive = 0;
+}
+
+// Colour of car i of n other than the player's: spread round the colour wheel away from red.
+static void getCarColor(int i, int n, float* c) {
+    float h = 0.15f + 0.7f * (float)i / (float)n; // Hue in [0.15, 0.85)
+    c[0] = 0.5f + 0.5f * cosf(2.0f * (float)M_PI * h);
+    c[1] = 0.5f + 0.5f * cosf(2.0f * (float)M_PI * (h - 1.0f / 3.0f));
+    c[2] = 0.5f + 0.5f * cosf(2.0f * (float)M_PI * (h - 2.0f / 3.0f));
+}
+
+// Puts opponentCount AI cars on the grid around the player's start position.
+static void initOpponents() {
+    freeOpponents();
+    if (opponentCount <= 0) return;
+    int n = opponentCount;
+    if (!initCarBatch(&opponents, n, &raceSim.track, &raceSim.car)) return;
+    if (!buildRacingLine(&opponentLine, &raceSim.track, &raceSim.car)) {
+        printf("Could not build a racing line; racing without opponents.\n");
+        freeCarBatch(&opponents);
+        return;
+    }
+    opponentDrivers = (AIDriver*)malloc((size_t)n * sizeof(AIDriver));
+    previousOpponents = (Car*)malloc((size_t)n * sizeof(Car));
+    renderCarList = (Car*)malloc((size_t)(n + 1) * sizeof(Car));
+    renderCarColors = (float*)malloc((size_t)(n + 1) * 3 * sizeof(float));
+    int contactsReady = initCarContactGrid(&opponentContacts, n + 1, &raceSim.car); // Opponents plus the player
+    standingsActive = initStandings(&raceStandings, n + 1, getTrackProgress(&raceSim.track));
+    opponentsActive = 1;
+    if (!contactsReady || !standingsActive || !opponentDrivers || !previousOpponents || !renderCarList || !renderCarColors) {
+        freeOpponents();
+        return;
+    }
+    addStandingsEntry(&raceStandings, raceSim.car.x, raceSim.car.z);
+    for (int i = 0; i < n; ++i) {
+        Car car;
+        placeCarOnGrid(&raceSim.car, getTrackProgress(&raceSim.track), i, &car);
+        addCarToBatch(&opponents, &car);
+        initAIDriver(&opponentDrivers[i], &opponentLine, car.x, car.z);
+        previousOpponents[i] = car;
+        addStandingsEntry(&raceStandings, car.x, car.z);
+    }
+    sortStandings(&raceStandings);
+    // Player red, opponents spread round the colour wheel away from red.
+    renderCarColors[0] = 1.0f; renderCarColors[1] = 0.0f; renderCarColors[2] = 0.0f;
+    for (int i = 0; i < n; ++i) getCarColor(i, n, &renderCarColors[(i + 1) * 3]);
+}
+
+// One physics tick for every opponent: the AI picks the controls, the batch
+// moves, then overlapping cars are pushed apart. The player's car is a fixed
+// obstacle there: opponents yield to it but never move it, so the player's
+// race (and its recording) does not depend on the opponents. The standings
+// are brought up to date last, with every car in its final place.
+static void updateOpponents(float deltaTime) {
+    for (int i = 0; i < opponents.count; ++i) getCarFromBatch(&opponents, i, &previousOpponents[i]);
+    updateAIDriverBatch(opponentDrivers, &opponentLine, &opponents);
+    updateCarBatch(&opponents, deltaTime);
+    resolveCarContacts(&opponentContacts, &opponents, &raceSim.car, 1);
+
+    int timeNowMs = getRaceTimeMs(&raceSim);
+    updateStandingsEntry(&raceStandings, 0, raceSim.car.x, raceSim.car.z, timeNowMs);
+    updateStandingsEntries(&raceStandings, 1, opponents.count, opponents.x, opponents.z, timeNowMs);
+    sortStandings(&raceStandings);
+}
+
+// --- Car Rendering ---
+// Called by display() with the camera set up.
+void renderRaceCars() {
+    if (netplayActive) {
+        renderCars(renderNetCars, netCarColors, netClient.player_count);
+        return;
+    }
+    if (!opponentsActive) {
+        renderCars(&renderPlayerCar, NULL, 1);
+        return;
+    }
+    renderCarList[0] = renderPlayerCar;
+    renderCars(renderCarList, renderCarColors, 1 + opponents.count);
+}
+
+// --- Rewind ---
+// Everything the race's keyframes hold: the player's race and, if racing
+// against them, the opponents with their drivers and the standings.
+static void getRaceState(SimState* state) {
+    state->sim = &raceSim;
+    state->cars = opponentsActive ? &opponents : NULL;
+    state->drivers = opponentsActive ? opponentDrivers : NULL;
+    state->standings = standingsActive ? &raceStandings : NULL;
+}
+
+// Goes back to the keyframe REWIND_SECONDS ago. The recording is cut at that
+// tick, so the saved replay is the race as it was driven from there on.
+static void rewindRace() {
+    SimState state;
+    getRaceState(&state);
+    unsigned char held = getCarControlBits(&raceSim.car); // Keys still held apply from the rewound tick
+    long long rewound = rewindSnapshotRing(&raceKeyframes, &state, (long long)REWIND_SECONDS * raceSim.tick_rate);
+    if (rewound == 0) {
+        printf("'B' pressed. Nothing to rewind to.\n");
+        return;
+    }
+    setCarControlBits(&raceSim.car, held);
+    truncateReplay(&raceReplay, (unsigned int)raceSim.ticks);
+    // No interpolation across the jump
+    previousPlayerCar = raceSim.car;
+    renderPlayerCar = raceSim.car;
+    for (int i = 0; opponentsActive && i < opponents.count; ++i) {
+        getCarFromBatch(&opponents, i, &previousOpponents[i]);
+        renderCarList[i + 1] = previousOpponents[i];
+    }
+    tickAccumulator = 0.0;
+    printf("'B' pressed. Rewound %.2f s.\n", (double)rewound / raceSim.tick_rate);
+}
+
+// --- Netplay ---
+// With --connect, ENTER in the menu joins the server instead of starting a
+// local race; the race starts on the server's track once every player has
+// joined. There are no opponents, recording, rewind or reset in a net race.
+static void joinNetRace() {
+    if (netplayActive) return;
+    if (!openNetClient(&netClient, netplayAddress)) return;
+    netplayActive = 1;
+    printf("Joining the race at %s...\n", netplayAddress);
+}
+
+void closeGameNetplay() {
+    if (!netplayActive) return;
+    closeNetClient(&netClient);
+    netplayActive = 0;
+    initSimContext(&raceSim, raceSim.track.type, physicsTickRate); // The server's tick rate may differ
+    raceSim.profiled = 1;
+}
+
+// The server started the race: set up the track and enter the racing state.
+static void beginNetRace() {
+    if (!loadTrackRenderer(&netClient.players[0].track)) {
+        closeGameNetplay();
+        return;
+    }
+    saveRaceReplay();
+    freeOpponents();
+    freeSnapshotRing(&raceKeyframes);
+    int local = netClient.local_player;
+    raceSim = netClient.players[local];
+    for (int p = 0; p < netClient.player_count; ++p) {
+        previousNetCars[p] = renderNetCars[p] = netClient.players[p].car;
+        if (p == local) { netCarColors[p * 3] = 1.0f; netCarColors[p * 3 + 1] = 0.0f; netCarColors[p * 3 + 2] = 0.0f; }
+        else getCarColor(p, netClient.player_count, &netCarColors[p * 3]);
+    }
+    previousPlayerCar = renderPlayerCar = raceSim.car;
+    tickAccumulator = 0.0;
+    lastUpdateTimeMs = glutGet(GLUT_ELAPSED_TIME);
+    netRaceReported = 0;
+    currentGameState = STATE_RACING;
+    printf("Net race started: player %d of %d, track type %d.\n", local + 1, netClient.player_count, netClient.track);
+}
+
+// Like the local fixed step, but each tick goes through the net client, which
+// may refuse it until the other players' inputs catch up (the banked time then
+// waits) and may rewrite past ticks when their inputs arrive.
+static void updateNetRace(double tickSeconds) {
+    int ticksRun = 0;
+    int local = netClient.local_player;
+    unsigned char held = getCarControlBits(&raceSim.car);
+    updateNetClient(&netClient);
+    while (tickAccumulator >= tickSeconds && ticksRun < MAX_CATCHUP_TICKS) {
+        Car before[NET_MAX_PLAYERS];
+        for (int p = 0; p < netClient.player_count; ++p) before[p] = netClient.players[p].car;
+        if (!stepNetClient(&netClient, held)) break;
+        memcpy(previousNetCars, before, (size_t)netClient.player_count * sizeof(Car));
+        tickAccumulator -= tickSeconds;
+        ticksRun++;
+    }
+    if (netClient.state == NET_CLIENT_FINISHED && !netRaceReported) {
+        printf("Net race over. Checksum %08x (equal on every client).\n", getNetClientChecksum(&netClient));
+        netRaceReported = 1;
+    }
+    raceSim = netClient.players[local];
+    setCarControlBits(&raceSim.car, held); // Keys still held
+    previousPlayerCar = previousNetCars[local];
 }
 
 // --- Initialization Function (for RACING state) ---
 // Called by startGame() or when 'R' is pressed during racing.
 // Sets up the car and timers for the currently selected track.
 void initGame() {
-    // initCar() itself now checks 'selectedTrackType' for positioning etc.
-    initCar(&playerCar); // initCar is defined in car.c
-
-    // Initialize lap timing variables for the start of the race/reset.
-    lapStartTimeMs = glutGet(GLUT_ELAPSED_TIME); // Get current time since GLUT started
-    currentLapTimeMs = 0;
-    lastLapTimeMs = 0;       // No previous lap yet on reset
-    bestLapTimeMs = INT_MAX; // Reset best lap on reset (or load from save later)
-
-    // Determine initial finish line state based on the car's starting Z and X position
-    // relative to the finish line boundaries of the *selected* track.
-    float finishLineXStart, finishLineXEnd;
-    if (selectedTrackType == TRACK_RECT) {
-        finishLineXStart = RECT_FINISH_LINE_X_START;
-        finishLineXEnd = RECT_FINISH_LINE_X_END;
-    } else { // TRACK_ROUNDED
-        finishLineXStart = ROUND_FINISH_LINE_X_START;
-        finishLineXEnd = ROUND_FINISH_LINE_X_END;
-    }
-    // Set flag to true (1) only if starting exactly on or past the line (unlikely with current setup)
-    crossedFinishLineMovingForwardState = (playerCar.z >= FINISH_LINE_Z &&
-                                           playerCar.x >= finishLineXStart &&
-                                           playerCar.x <= finishLineXEnd);
+    // Car placement, lap timers, the finish line flag and the tick clock are
+    // reset by the GL-free race code in sim.c.
+    saveRaceReplay(); // Keep the race being reset, if any
+    tickAccumulator = 0.0;
+    lastUpdateTimeMs = glutGet(GLUT_ELAPSED_TIME);
+    initRace(&raceSim);
+    previousPlayerCar = raceSim.car;
+    renderPlayerCar = raceSim.car;
+    initOpponents(); // After initRace, so the grid forms around the player's start
+    SimState state;
+    getRaceState(&state);
+    int keyframeInterval = raceSim.tick_rate / REWIND_KEYFRAMES_PER_SECOND;
+    freeSnapshotRing(&raceKeyframes);
+    initSnapshotRing(&raceKeyframes, &state, REWIND_HISTORY_SECONDS * REWIND_KEYFRAMES_PER_SECOND + 1, keyframeInterval);
+    updateSnapshotRing(&raceKeyframes, &state); // The start of the race
+    startReplay(&raceReplay, raceSim.track.type, customTrackPath, raceSim.tick_rate, &raceSim.car);
+    raceReplayActive = 1;
 
     printf("Game Initialized for Track Type %d. Start time: %dms. Crossed Flag: %d\n",
-           selectedTrackType, lapStartTimeMs, crossedFinishLineMovingForwardState);
+           raceSim.track.type, raceSim.lap_start_time_ms, raceSim.crossed_finish_line_forward);
 }
 
 
 // --- Function to start the game ---
 // Called when the user selects a track from the menu and presses Enter.
 void startGame(TrackType type) {
+    SimTrack track = raceSim.track; // Same rules, on the chosen track
+    track.type = type;
+    track.data = NULL;
+    // Custom tracks are mapped from disk the first time they are picked.
+    if (type == TRACK_CUSTOM && !(track.data = loadCustomTrack(customTrackPath))) {
+        printf("Could not load custom track '%s' (build it with 'make tracks').\n", customTrackPath);
+        return; // Stay in the menu
+    }
     printf("Starting game with Track Type %d\n", type);
-    selectedTrackType = type;       // Store the chosen track type globally
+    if (!loadTrackRenderer(&track)) return; // Build the track's vertex buffers once, here
+    raceSim.track = track;          // Race on the chosen track
     initGame();                     // Initialize car position, timers for this track
     currentGameState = STATE_RACING; // Change the game state to racing mode
     glutPostRedisplay();            // Ensure screen updates immediately
@@ -88,15 +360,16 @@ void setupCamera() {
     float lookAtHeightOffset = 0.5f; // Point slightly above car's center Y
 
     // Calculate camera position using car's angle and position
-    float carAngleRad = DEG_TO_RAD(playerCar.angle);
-    float camX = playerCar.x - followDistance * sinf(carAngleRad);
-    float camY = playerCar.y + followHeight; // Use car's actual y + offset
-    float camZ = playerCar.z - followDistance * cosf(carAngleRad);
+    // (the interpolated car, so the camera moves smoothly between physics ticks)
+    const Car* car = &renderPlayerCar;
+    float camX = car->x - followDistance * car->heading_sin; // The heading's cached sine/cosine
+    float camY = car->y + followHeight; // Use car's actual y + offset
+    float camZ = car->z - followDistance * car->heading_cos;
 
     // Calculate look-at point (center of the car)
-    float lookAtX = playerCar.x;
-    float lookAtY = playerCar.y + lookAtHeightOffset;
-    float lookAtZ = playerCar.z;
+    float lookAtX = car->x;
+    float lookAtY = car->y + lookAtHeightOffset;
+    float lookAtZ = car->z;
 
     // Set the Modelview matrix using gluLookAt
     glMatrixMode(GL_MODELVIEW);
@@ -108,102 +381,95 @@ void setupCamera() {
 
 
 // --- Fixed Timestep Update Function ---
-// Contains the main game loop logic, called repeatedly by GLUT timer.
-void updateGame(int value) {
+// Called by GLUT whenever it is idle. Runs as many physics ticks as the wall
+// time since the last call allows, then interpolates the car for drawing.
+void updateGame() {
+    int nowMs = glutGet(GLUT_ELAPSED_TIME);
+    int elapsedMs = nowMs - lastUpdateTimeMs;
+    lastUpdateTimeMs = nowMs;
+
+    // Waiting for the other players to join a net race
+    if (netplayActive && netClient.state == NET_CLIENT_JOINING) {
+        updateNetClient(&netClient);
+        if (netClient.state != NET_CLIENT_JOINING) beginNetRace();
+    }
+
     // --- Only update game logic if in RACING state ---
     if (currentGameState != STATE_RACING) {
-        // Still need to reschedule the timer to keep the loop running for the menu
-        glutTimerFunc(FRAME_TIME_MS, updateGame, 0);
-        // Request redraw in case menu needs updating (e.g., animations, though none currently)
+        // Keep redrawing the menu (nothing is simulated, so no time is banked)
         glutPostRedisplay();
         return; // Skip physics, lap timing, etc., when in menu
     }
     // --- End of state check ---
 
-    (void)value; // Mark the GLUT timer parameter as unused
-
-    int timeNowMs = glutGet(GLUT_ELAPSED_TIME);
-
-    // Update car physics, movement, and collision detection/response.
-    // This function (in car.c) now internally calls the correct isPositionOn*Track
-    updateCar(&playerCar, FRAME_TIME_SEC);
-
-    // Update Lap Timers based on elapsed time.
-    if (timeNowMs >= lapStartTimeMs) {
-        currentLapTimeMs = timeNowMs - lapStartTimeMs;
-    } else {
-        // Handle potential timer wrap-around or reset during gameplay.
-        lapStartTimeMs = timeNowMs;
-        currentLapTimeMs = 0;
+    double tickSeconds = 1.0 / raceSim.tick_rate;
+    tickAccumulator += (elapsedMs > 0 ? elapsedMs : 0) / 1000.0;
+
+    // Advance the car and run lap timing/detection (see updateRace in sim.c)
+    // once per whole tick of banked time.
+    int ticksRun = 0;
+    if (netplayActive) updateNetRace(tickSeconds);
+    while (!netplayActive && tickAccumulator >= tickSeconds && ticksRun < MAX_CATCHUP_TICKS) {
+        previousPlayerCar = raceSim.car;
+        unsigned char controls = getCarControlBits(&raceSim.car);
+        recordReplayTick(&raceReplay, getReplayTickInputs(&raceSim.track, controls));
+        int events = updateRace(&raceSim);
+        if (opponentsActive) updateOpponents(getRaceTickSeconds(&raceSim));
+        if (telemetryLog.open) {
+            // Only a copy into the ring buffer; the file is written by a background thread.
+            TelemetryRecord record;
+            makeTelemetryRecord(&record, &raceSim, controls,
+                                events | (raceSim.ticks == 1 ? TELEMETRY_EVENT_RACE_START : 0));
+            logTelemetry(&telemetryLog, &record);
+        }
+        SimState state;
+        getRaceState(&state);
+        updateSnapshotRing(&raceKeyframes, &state);
+        tickAccumulator -= tickSeconds;
+        ticksRun++;
+    }
+    // After a long stall (window drag, breakpoint) drop the backlog rather than
+    // running a burst of ticks; the game just runs slow for that frame. A net
+    // race keeps it: the other players' ticks go on, so the banked time is run
+    // off MAX_CATCHUP_TICKS a frame once the lockstep lets it.
+    if (!netplayActive && tickAccumulator >= tickSeconds) {
+        tickAccumulator = fmod(tickAccumulator, tickSeconds);
     }
 
-    // --- Lap Completion Logic ---
-    // Check if the car has crossed the finish line in the forward direction.
-    float carZ = playerCar.z;
-    float carPrevZ = playerCar.prev_z;
-    float carX = playerCar.x;
-    int movingForward = (playerCar.speed > 0.1f); // Check speed for direction
-
-    // Get finish line X boundaries based on the currently selected track.
-    float finishLineXStart, finishLineXEnd;
-    if (selectedTrackType == TRACK_RECT) {
-        finishLineXStart = RECT_FINISH_LINE_X_START;
-        finishLineXEnd = RECT_FINISH_LINE_X_END;
-    } else { // TRACK_ROUNDED
-        finishLineXStart = ROUND_FINISH_LINE_X_START;
-        finishLineXEnd = ROUND_FINISH_LINE_X_END;
+    // Draw the cars partway between the last two ticks (at the last one while
+    // a net race has time banked).
+    float alpha = (float)(tickAccumulator / tickSeconds);
+    if (alpha > 1.0f) alpha = 1.0f;
+    interpolateCar(&previousPlayerCar, &raceSim.car, alpha, &renderPlayerCar);
+    for (int p = 0; netplayActive && p < netClient.player_count; ++p) {
+        interpolateCar(&previousNetCars[p], &netClient.players[p].car, alpha, &renderNetCars[p]);
     }
-    // Check if the car is within the X span of the finish line.
-    int withinFinishLineX = (carX >= finishLineXStart && carX <= finishLineXEnd);
-
-
-    // --- Detect Crossing Finish Line FORWARD ---
-    // Conditions: Z crossed the FINISH_LINE_Z threshold, moving forward, within X bounds.
-    if (carPrevZ < FINISH_LINE_Z && carZ >= FINISH_LINE_Z && movingForward && withinFinishLineX) {
-        // Only count lap completion if the 'crossedForward' flag is already set (meaning
-        // we completed the previous part of the track and are genuinely finishing a lap).
-        if (crossedFinishLineMovingForwardState == 1) {
-            // --- LAP COMPLETED ---
-            lastLapTimeMs = currentLapTimeMs; // Record the time
-            // Update best lap if this one was faster (and valid).
-            if (lastLapTimeMs > 0 && lastLapTimeMs < bestLapTimeMs) {
-                bestLapTimeMs = lastLapTimeMs;
-            }
-            // Reset timer for the start of the *new* lap.
-            lapStartTimeMs = timeNowMs;
-            currentLapTimeMs = 0;
-            // The flag remains 1 as we start the next lap from past the line.
-        } else {
-            // This is the *first* time crossing forward (either started before the line
-            // or crossed backward then forward again). Set the flag and start the timer.
-            crossedFinishLineMovingForwardState = 1; // Set flag to true
-            lapStartTimeMs = timeNowMs;            // Start timing the first/next lap *now*.
-            currentLapTimeMs = 0;
+    if (opponentsActive) {
+        for (int i = 0; i < opponents.count; ++i) {
+            Car current;
+            getCarFromBatch(&opponents, i, &current);
+            interpolateCar(&previousOpponents[i], &current, alpha, &renderCarList[i + 1]);
         }
     }
-    // --- Detect Crossing Finish Line BACKWARD ---
-    // Conditions: Z crossed the threshold backward, within X bounds.
-    else if (carPrevZ >= FINISH_LINE_Z && carZ < FINISH_LINE_Z && withinFinishLineX) {
-        // If the car goes backward over the line, reset the state flag. It will need
-        // to cross forward again to set the flag before completing the *next* lap.
-        crossedFinishLineMovingForwardState = 0; // Set flag to false
-    }
 
     // Request GLUT to redraw the screen.
     glutPostRedisplay();
-    // Reschedule this update function to be called again after the frame delay.
-    glutTimerFunc(FRAME_TIME_MS, updateGame, 0);
 }
 
 
 // --- Menu Rendering Function ---
 // Draws the track selection menu.
 void renderMenu(int windowWidth, int windowHeight) {
+    static const float yellow[3] = { 1.0f, 1.0f, 0.0f };
+    static const float lightGrey[3] = { 0.8f, 0.8f, 0.8f };
+    static const float white[3] = { 1.0f, 1.0f, 1.0f };
+    static const float grey[3] = { 0.6f, 0.6f, 0.6f };
     char menuText[100]; // Text buffer
     // Array of track names corresponding to TrackType enum order and NUM_TRACK_OPTIONS
     const char* trackNames[NUM_TRACK_OPTIONS] = {
         "Rectangular Circuit", // Index 0 -> TRACK_RECT
-        "Rounded Circuit"      // Index 1 -> TRACK_ROUNDED
+        "Rounded Circuit",     // Index 1 -> TRACK_ROUNDED
+        "Custom Circuit"       // Index 2 -> TRACK_CUSTOM (loaded from customTrackPath)
         // Add more names here if NUM_TRACK_OPTIONS increases
     };
 
@@ -218,48 +484,44 @@ void renderMenu(int windowWidth, int windowHeight) {
     glDisable(GL_TEXTURE_2D); glDisable(GL_FOG);
 
     // --- Render Menu Text Elements ---
+    // Collected by the text renderer and drawn in one batch by endText.
+    beginText();
     int textX = windowWidth / 2 - 150; // Base X position for roughly centered text
     int textY = windowHeight / 2 + 100; // Starting Y position (higher up)
     int lineHeight = 28;               // Vertical spacing between lines
 
     // Title
-    glColor3f(1.0f, 1.0f, 0.0f); // Yellow
-    snprintf(menuText, sizeof(menuText), "F1 RACER PROTOTYPE");
-    glRasterPos2i(textX, textY);
-    for (char* c = menuText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *c); }
+    drawText(TEXT_FONT_TITLE, textX, textY, yellow, "F1 RACER PROTOTYPE");
     textY -= lineHeight * 2; // Move down
 
     // Instructions
-    glColor3f(0.8f, 0.8f, 0.8f); // Light grey
-    snprintf(menuText, sizeof(menuText), "Use UP/DOWN arrows to select");
-    glRasterPos2i(textX, textY); for (char* c = menuText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
+    drawText(TEXT_FONT_NORMAL, textX, textY, lightGrey, "Use UP/DOWN arrows to select");
     textY -= (int)(lineHeight * 0.75); // Smaller gap
-    snprintf(menuText, sizeof(menuText), "Press ENTER to start");
-    glRasterPos2i(textX, textY); for (char* c = menuText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
+    drawText(TEXT_FONT_NORMAL, textX, textY, lightGrey, "Press ENTER to start");
     textY -= (int)(lineHeight * 1.5); // Larger gap
 
+    // Net race: ENTER joins the server, whose track is raced
+    if (netplayAddress) {
+        if (netplayActive) snprintf(menuText, sizeof(menuText), "Waiting for players at %s...", netplayAddress);
+        else snprintf(menuText, sizeof(menuText), "Netplay: ENTER joins %s", netplayAddress);
+        drawText(TEXT_FONT_NORMAL, textX, textY, yellow, menuText);
+        textY -= (int)(lineHeight * 1.5);
+    }
+
     // Track Options (Loop through and highlight the selected one)
     for (int i = 0; i < NUM_TRACK_OPTIONS; ++i) {
-        if (i == menuSelectionIndex) {
-            glColor3f(1.0f, 1.0f, 1.0f); // White for selected item
-            snprintf(menuText, sizeof(menuText), "> %s <", trackNames[i]); // Add selection markers
-        } else {
-            glColor3f(0.6f, 0.6f, 0.6f); // Grey for non-selected items
-            snprintf(menuText, sizeof(menuText), "  %s  ", trackNames[i]); // Add padding for alignment
-        }
-        glRasterPos2i(textX + 10, textY); // Indent the track names slightly
-        for (char* c = menuText; *c != '\0'; c++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
-        }
+        int selected = (i == menuSelectionIndex);
+        if (selected) snprintf(menuText, sizeof(menuText), "> %s <", trackNames[i]); // Add selection markers
+        else snprintf(menuText, sizeof(menuText), "  %s  ", trackNames[i]);          // Add padding for alignment
+        // White for the selected item, grey for the others; indented slightly
+        drawText(TEXT_FONT_NORMAL, textX + 10, textY, selected ? white : grey, menuText);
         textY -= lineHeight; // Move down for next option
     }
     textY -= lineHeight; // Extra space before exit prompt
 
     // Exit Instruction
-    glColor3f(0.8f, 0.8f, 0.8f);
-    snprintf(menuText, sizeof(menuText), "ESC to Exit");
-    glRasterPos2i(textX, textY);
-    for (char* c = menuText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
+    drawText(TEXT_FONT_NORMAL, textX, textY, lightGrey, "ESC to Exit");
+    endText();
 
     // --- Restore OpenGL states and matrices ---
     glPopAttrib(); // Restore disabled states (depth, lighting etc.)
@@ -271,6 +533,11 @@ void renderMenu(int windowWidth, int windowHeight) {
 // --- Heads-Up Display (HUD) Rendering Function ---
 // Draws the lap timers during the racing state.
 void renderHUD(int windowWidth, int windowHeight) {
+    static const float white[3] = { 1.0f, 1.0f, 1.0f };
+    static const float green[3] = { 0.4f, 1.0f, 0.4f };
+    static const float grey[3] = { 0.6f, 0.6f, 0.6f };
+    static const float red[3] = { 1.0f, 0.4f, 0.4f };
+    static const float yellow[3] = { 1.0f, 1.0f, 0.4f };
     char hudText[100]; // Buffer for formatted strings
 
     // --- Set up 2D Orthographic Projection ---
@@ -284,16 +551,20 @@ void renderHUD(int windowWidth, int windowHeight) {
     glDisable(GL_TEXTURE_2D); glDisable(GL_FOG);
 
     // --- Render Timers ---
-    glColor3f(1.0f, 1.0f, 1.0f); // White text color
+    // Text is collected by the text renderer, which only rebuilds the lines
+    // that changed since the last frame, and drawn in one batch by endText.
+    beginText();
     int textX = 10;                // X position from left edge
     int textY = windowHeight - 30; // Y position from *bottom* edge (near top-left)
     int lineHeight = 20;           // Vertical spacing
 
     // Current Lap Time
+    int currentLapTimeMs = raceSim.current_lap_time_ms;
+    int lastLapTimeMs = raceSim.last_lap_time_ms;
+    int bestLapTimeMs = raceSim.best_lap_time_ms;
     int cur_mins=(currentLapTimeMs/1000)/60; int cur_secs=(currentLapTimeMs/1000)%60; int cur_ms=currentLapTimeMs%1000;
     snprintf(hudText, sizeof(hudText), "Current: %02d:%02d.%03d", cur_mins, cur_secs, cur_ms);
-    glRasterPos2i(textX, textY); // Set position for text drawing
-    for (char* c = hudText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); } // Draw character by character
+    drawText(TEXT_FONT_NORMAL, textX, textY, white, hudText);
     textY -= lineHeight; // Move down for next line
 
     // Last Lap Time
@@ -303,7 +574,7 @@ void renderHUD(int windowWidth, int windowHeight) {
     } else {
         snprintf(hudText, sizeof(hudText), "Last:    --:--.---"); // Placeholder if no laps completed
     }
-    glRasterPos2i(textX, textY); for (char* c = hudText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
+    drawText(TEXT_FONT_NORMAL, textX, textY, white, hudText);
     textY -= lineHeight;
 
     // Best Lap Time
@@ -313,7 +584,86 @@ void renderHUD(int windowWidth, int windowHeight) {
     } else {
         snprintf(hudText, sizeof(hudText), "Best:    --:--.---"); // Placeholder if no laps recorded
     }
-    glRasterPos2i(textX, textY); for (char* c = hudText; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
+    drawText(TEXT_FONT_NORMAL, textX, textY, white, hudText);
+
+    // --- Sector Splits ---
+    // This lap's split once the sector is done (green if it is the best),
+    // otherwise the last lap's, greyed out.
+    for (int s = 0; s < raceSim.sector_count; ++s) {
+        textY -= lineHeight;
+        int split = raceSim.current_sector_times_ms[s];
+        const float* color = (split == raceSim.best_sector_times_ms[s]) ? green : white;
+        if (split <= 0) {
+            split = raceSim.last_sector_times_ms[s];
+            color = grey;
+        }
+        if (split > 0) {
+            snprintf(hudText, sizeof(hudText), "S%d:      %02d:%02d.%03d", s + 1, (split / 1000) / 60, (split / 1000) % 60, split % 1000);
+        } else {
+            snprintf(hudText, sizeof(hudText), "S%d:      --:--.---", s + 1);
+        }
+        drawText(TEXT_FONT_NORMAL, textX, textY, color, hudText);
+    }
+
+    // --- Standings Panel (racing against opponents) ---
+    // The top places with their gap to the leader, plus the player's place
+    // if it is further down.
+    if (standingsActive) {
+        int panelX = windowWidth - 200;
+        int panelY = windowHeight - 30;
+        int smallLineHeight = 15;
+        int timeNowMs = getRaceTimeMs(&raceSim);
+        int playerPlace = raceStandings.position[0];
+        snprintf(hudText, sizeof(hudText), "Pos %d/%d", playerPlace + 1, raceStandings.count);
+        drawText(TEXT_FONT_NORMAL, panelX, panelY, white, hudText);
+        panelY -= lineHeight;
+        for (int p = 0; p < raceStandings.count; ++p) {
+            if (p >= HUD_STANDINGS_ROWS && p != playerPlace) continue;
+            int id = raceStandings.order[p];
+            int lapsBehind;
+            int gapMs = getStandingsGapMs(&raceStandings, id, timeNowMs, &lapsBehind);
+            char name[16];
+            if (id == 0) snprintf(name, sizeof(name), "You");
+            else snprintf(name, sizeof(name), "Car %d", id);
+            if (p == 0) snprintf(hudText, sizeof(hudText), "%3d %-9s Lap %d", p + 1, name, getStandingsLaps(&raceStandings, id) + 1);
+            else if (lapsBehind > 0) snprintf(hudText, sizeof(hudText), "%3d %-9s +%d lap%s", p + 1, name, lapsBehind, lapsBehind > 1 ? "s" : "");
+            else snprintf(hudText, sizeof(hudText), "%3d %-9s +%d.%03d", p + 1, name, gapMs / 1000, gapMs % 1000);
+            // Player in red, like the car
+            drawText(TEXT_FONT_SMALL, panelX, panelY, (id == 0) ? red : white, hudText);
+            panelY -= smallLineHeight;
+        }
+    }
+
+    // --- Profiler Panel ('P') ---
+    // Per-frame time of each zone over the last PROFILE_HISTORY_FRAMES frames.
+    // Render zones are CPU time spent issuing GL calls, not GPU time.
+    if (profilerEnabled) {
+        int panelY = textY - 2 * lineHeight;
+        int smallLineHeight = 15;
+        snprintf(hudText, sizeof(hudText), "%-14s %7s %7s %7s", "zone (ms)", "min", "avg", "p99");
+        drawText(TEXT_FONT_SMALL, textX, panelY, yellow, hudText);
+        for (int z = 0; z < PROFILE_ZONE_COUNT; ++z) {
+            ProfileStats stats;
+            getProfileStats((ProfileZone)z, &stats);
+            panelY -= smallLineHeight;
+            snprintf(hudText, sizeof(hudText), "%-14s %7.3f %7.3f %7.3f", getProfileZoneName((ProfileZone)z),
+                     stats.min_ms, stats.avg_ms, stats.p99_ms);
+            drawText(TEXT_FONT_SMALL, textX, panelY, yellow, hudText);
+        }
+        TrackRenderStats trackStats;
+        getTrackRenderStats(&trackStats);
+        panelY -= smallLineHeight;
+        snprintf(hudText, sizeof(hudText), "track tiles %d/%d (%d coarse), %d draws", trackStats.drawn, trackStats.tiles,
+                 trackStats.coarse, trackStats.draw_calls);
+        drawText(TEXT_FONT_SMALL, textX, panelY, yellow, hudText);
+        TextRenderStats textStats;
+        getTextRenderStats(&textStats);
+        panelY -= smallLineHeight;
+        snprintf(hudText, sizeof(hudText), "text %d strings, %d rebuilt%s", textStats.strings, textStats.rebuilt,
+                 textStats.atlas ? "" : " (bitmap)");
+        drawText(TEXT_FONT_SMALL, textX, panelY, yellow, hudText);
+    }
+    endText();
 
     // --- Restore OpenGL states and matrices ---
     glPopAttrib(); // Restore states disabled earlier
@@ -331,7 +681,8 @@ void handleMenuKeyPress(unsigned char key) {
          case 13: // ASCII for Enter key
             // Start the game with the track corresponding to the highlighted index.
             // The index directly maps to the TrackType enum value.
-            startGame((TrackType)menuSelectionIndex);
+            if (netplayAddress) joinNetRace();
+            else startGame((TrackType)menuSelectionIndex);
             break;
         case 27: // ESC key
             printf("ESC pressed in menu. Exiting.\n");
@@ -367,7 +718,7 @@ void handleRacingKeyPress(unsigned char key) {
     // Pass movement keys (W, A, S, D) to the car controller.
     // Allow case-insensitivity for movement keys.
     if (key == 'w' || key == 'W' || key == 'a' || key == 'A' || key == 's' || key == 'S' || key == 'd' || key == 'D') {
-        setCarControls(&playerCar, key, 1); // 1 = key down
+        setCarControls(&raceSim.car, key, 1); // 1 = key down
     }
 
 
@@ -375,16 +726,49 @@ void handleRacingKeyPress(unsigned char key) {
     switch (key) {
         case 'r': // Reset key
         case 'R':
+            if (netplayActive) { printf("'R' pressed. No reset in a net race.\n"); break; }
             printf("'R' pressed. Resetting race.\n");
-            initGame(); // Re-initialize car and timers for the current track.
+            initGame(); // Re-initialize car, timers and the tick clock for the current track.
+            break;
+        case 'b': // Rewind the race
+        case 'B':
+            if (netplayActive) { printf("'B' pressed. No rewind in a net race.\n"); break; }
+            rewindRace();
+            break;
+        case 'g': // Toggle the track query backend (analytic tests vs distance grid)
+        case 'G':
+            if (netplayActive) break; // Every client must race with the same rules
+            if (raceSim.track.query_backend == TRACK_QUERY_ANALYTIC) {
+                // Build the grid now rather than on the next physics tick.
+                raceSim.track.query_backend = getTrackGrid(&raceSim.track) ? TRACK_QUERY_GRID : TRACK_QUERY_ANALYTIC;
+            } else {
+                raceSim.track.query_backend = TRACK_QUERY_ANALYTIC;
+            }
+            printf("'G' pressed. Track queries: %s.\n", raceSim.track.query_backend == TRACK_QUERY_GRID ? "distance grid" : "analytic");
+            break;
+        case 'p': // Toggle the profiler and its HUD panel
+        case 'P':
+            profilerEnabled = !profilerEnabled;
+            if (profilerEnabled) resetProfiler(); // Start a fresh history
+            printf("'P' pressed. Profiler %s.\n", profilerEnabled ? "on" : "off");
+            break;
+        case 'c': // Save the profiler history as CSV
+        case 'C':
+            if (profilerEnabled && writeProfileCSV(PROFILE_CSV_PATH)) {
+                printf("'C' pressed. Profile saved to %s.\n", PROFILE_CSV_PATH);
+            } else if (!profilerEnabled) {
+                printf("'C' pressed. Turn the profiler on with 'P' first.\n");
+            }
             break;
         case 27: // ESC key
             printf("ESC pressed in racing. Returning to Menu.\n");
+            saveRaceReplay(); // Before the lap timers below are cleared
+            closeGameNetplay();
             currentGameState = STATE_MENU; // Change state back to menu.
             // Optionally highlight the track we just left in the menu.
-            menuSelectionIndex = (int)selectedTrackType;
+            menuSelectionIndex = (int)raceSim.track.type;
             // Reset timers when returning to menu to avoid confusion.
-            lastLapTimeMs = 0; bestLapTimeMs = INT_MAX; currentLapTimeMs = 0;
+            raceSim.last_lap_time_ms = 0; raceSim.best_lap_time_ms = INT_MAX; raceSim.current_lap_time_ms = 0;
             glutPostRedisplay(); // Request redraw to show the menu immediately.
             break;
     }
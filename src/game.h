@@ -1,7 +1,7 @@
 #ifndef GAME_H
 #define GAME_H
 
-#include "car.h" // Includes Car struct definition
+#include "sim.h" // Includes Car struct, TrackType and the race state globals
 
 // --- Game States ---
 typedef enum {
@@ -9,47 +9,68 @@ typedef enum {
     STATE_RACING     // Actively racing on a selected track
 } GameState;
 
-// --- Track Types ---
-// Enum defining the different available track geometries.
-typedef enum {
-    TRACK_RECT,      // The sharp-cornered rectangle
-    TRACK_ROUNDED    // The rectangle with rounded corners
-    // Add more track types here if needed (remember to update NUM_TRACK_OPTIONS)
-} TrackType;
-
 // --- Menu Selection ---
 // Defines how many track options are available in the menu.
 // This MUST match the number of entries in the trackNames array in game.c
-#define NUM_TRACK_OPTIONS 2
+#define NUM_TRACK_OPTIONS 3
 
 // --- Frame Timing ---
-#define FRAME_RATE 60                // Target frames per second
-#define FRAME_TIME_MS (1000 / FRAME_RATE) // Delay between updates in milliseconds
-#define FRAME_TIME_SEC (1.0f / FRAME_RATE) // Delay between updates in seconds (for physics)
+// Physics runs at a fixed rate from the GLUT idle callback: wall time is added
+// to an accumulator and whole ticks are taken out of it, so the simulation
+// does not depend on the display rate or on timer jitter. Frames are drawn as
+// often as the display allows, with the car interpolated between the last two
+// ticks (renderPlayerCar).
+#define MAX_CATCHUP_TICKS 8 // Most ticks run per idle call; past that the game slows down instead of stalling
 
 // --- Global Variables ---
 // These are defined in game.c and declared here for access in other files (like main.c).
+// The race state (track, car, clock, lap timers) is raceSim, see SimContext in sim.h.
 extern GameState currentGameState;           // Current state of the game (menu or racing)
-extern TrackType selectedTrackType;        // Track type for the *current* race (set when race starts)
 extern int menuSelectionIndex;           // Which track is highlighted in the menu (0-based)
-extern Car playerCar;                    // The player's car object
+#define CUSTOM_TRACK_DEFAULT_PATH "tracks/circuit.trk"
+extern const char* customTrackPath;      // Track file loaded for the Custom Circuit option
+extern int physicsTickRate;              // Physics ticks per second (default SIM_DEFAULT_TICK_RATE)
+extern SimContext raceSim;               // The player's race
+extern Car renderPlayerCar;              // raceSim.car interpolated to the frame being drawn
+
+// --- Opponents ---
+// AI cars (see ai_driver.h) that start on the grid around the player and
+// follow the track's racing line. They do not affect the player's race.
+#define MAX_OPPONENTS 256
+extern int opponentCount;                // Set with --opponents N (default 0)
+
+// --- Netplay ---
+// With --connect HOST[:PORT] the menu joins a race on a netserver (see
+// netplay.h) instead of starting a local one.
+extern const char* netplayAddress;       // NULL = local races only
+
+// --- Profiler ---
+#define PROFILE_CSV_PATH "profile.csv" // Written by the 'C' key while racing
+
+// --- Race Recording ---
+#define REPLAY_PATH "last_race.rpl"     // Inputs of the last race, for 'headless --replay'
 
-// Timer variables used for lap timing in the HUD.
-extern int lapStartTimeMs;                   // Time the current lap started (ms since GLUT init)
-extern int currentLapTimeMs;                 // Duration of the current lap (ms)
-extern int lastLapTimeMs;                  // Duration of the last completed lap (ms)
-extern int bestLapTimeMs;                  // Duration of the best completed lap (ms)
-extern int crossedFinishLineMovingForwardState; // State flag for lap detection (0=false, 1=true)
+// --- Rewind ---
+// Keyframes of the race (see snapshot.h) taken every quarter second; the 'B'
+// key goes back to the one REWIND_SECONDS ago and races on from there.
+#define REWIND_SECONDS 5
+#define REWIND_HISTORY_SECONDS 30       // How far back keyframes are kept
+#define REWIND_KEYFRAMES_PER_SECOND 4
 
 // --- Function Declarations ---
 // Core game functions
 void initGame();                           // Initializes car/timers for the selected track (called by startGame/reset)
-void updateGame(int value);                // Main game loop update function (timer callback)
+void updateGame();                         // Main game loop update function (idle callback)
 void setupCamera();                        // Configures the third-person camera view
 void startGame(TrackType type);            // Transitions from menu to racing state with chosen track
 void switchTrack(TrackType newType);       // Function to change track
+void saveRaceReplay();                     // Saves the race in progress to REPLAY_PATH (if any)
+int openGameTelemetry(const char* path);   // Starts logging every tick to a telemetry file; returns 1 on success
+void closeGameTelemetry();                 // Flushes and closes the telemetry file (if open)
+void closeGameNetplay();                   // Leaves the net race being joined or raced (if any)
 
 // Rendering functions
+void renderRaceCars();                              // Draws the player's car and the opponents
 void renderMenu(int windowWidth, int windowHeight); // Draws the track selection menu
 void renderHUD(int windowWidth, int windowHeight);  // Draws the lap timer HUD
 
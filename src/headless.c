@@ -0,0 +1,490 @@
+// Headless race runner.
+// Runs the same physics and lap logic as the game (sim.c / car.c) without a
+// window or OpenGL, driven by the autopilot and a simulated clock, so laps run
+// as fast as the CPU allows instead of at 60 Hz wall time.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <math.h>
+
+#include "sim.h"
+#include "driver.h"
+#include "ai_driver.h"
+#include "car_batch.h"
+#include "car_contact.h"
+#include "standings.h"
+#include "track_file.h"
+#include "profiler.h"
+#include "replay.h"
+#include "telemetry.h"
+#include "netplay.h"
+#include "sim_math.h" // hashSimBytes
+#include "platform.h" // getPlatformTimeSeconds
+
+// Fixed step, the same as the windowed game's (both default to SIM_DEFAULT_TICK_RATE)
+static int tickRate = SIM_DEFAULT_TICK_RATE;
+static int useAI = 0; // Drive with the racing-line AI instead of the autopilot
+static int useContacts = 0; // Resolve car-to-car contacts in --cars mode
+static int useStandings = 0; // Keep the race order of the --cars field
+#define HEADLESS_TICK_SEC ((float)(1.0 / tickRate)) // Same expression as the game and runReplay
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [--track rect|round|FILE.trk] [--laps N] [--max-seconds S] [--cars N] [--grid]\n"
+           "       [--ai] [--contacts] [--standings] [--physics-hz N] [--profile FILE.csv] [--record FILE.rpl] [--replay FILE.rpl]\n"
+           "       [--telemetry FILE] [--collision stop|sweep] [--sectors N] [--connect HOST[:PORT]]\n", prog);
+    printf("  --track        Built-in track or track file from trackgen (default: rect)\n");
+    printf("  --laps         Number of completed laps to run (default: 100)\n");
+    printf("  --max-seconds  Simulated time limit, in case the car gets stuck (default: 60 per lap)\n");
+    printf("  --cars         Run N autopilot cars through updateCarBatch for --max-seconds\n");
+    printf("                 (default 60) instead of timing laps with the single player car\n");
+    printf("  --grid         Answer on-track queries from the precomputed distance grid\n");
+    printf("  --ai           Drive with the racing-line AI (ai_driver.c) instead of the autopilot\n");
+    printf("  --contacts     With --cars, let the cars collide with each other (car_contact.c);\n");
+    printf("                 car 0 is then no longer compared with updateCar\n");
+    printf("  --standings    With --cars, keep the race order and gaps (standings.c) and print the top 5\n");
+    printf("  --collision    Track edge response: stop the car, or sweep its box and slide along\n");
+    printf("                 the wall (default: sweep)\n");
+    printf("  --sectors      Equal-length timing sectors per lap, 1 to %d (default: %d)\n", MAX_SECTORS, DEFAULT_SECTOR_COUNT);
+    printf("  --physics-hz   Physics ticks per simulated second (default: %d)\n", SIM_DEFAULT_TICK_RATE);
+    printf("  --profile      Time physics and lap detection per tick, print min/avg/p99 and\n");
+    printf("                 write the last %d ticks to FILE.csv\n", PROFILE_HISTORY_FRAMES);
+    printf("  --record       Save the autopilot's inputs as a replay file\n");
+    printf("  --telemetry    Log every tick of the race to a binary telemetry file\n");
+    printf("  --replay       Re-run a recorded race (from the game or --record) and check that\n");
+    printf("                 it ends in exactly the recorded state; other options are ignored\n");
+    printf("  --connect      Join a netserver race as an autopilot player (default port %d) and\n", NET_DEFAULT_PORT);
+    printf("                 print the race checksum; other options are ignored\n");
+}
+
+// Name printed in the reports.
+static const char* getTrackLabel(const SimTrack* track) {
+    if (track->type == TRACK_RECT) return "rect";
+    if (track->type == TRACK_ROUNDED) return "round";
+    return track->data ? track->data->header->name : "custom";
+}
+
+// --- Batch Mode ---
+// Runs a field of cars through updateCarBatch. Car 0 is also run through the
+// scalar updateCar with the same inputs to check the two stay identical.
+static int runBatch(SimContext* sim, int numCars, double maxSeconds) {
+    const SimTrack* track = &sim->track;
+    initRace(sim);
+
+    CarBatch batch;
+    if (!initCarBatch(&batch, numCars, &sim->track, &sim->car)) {
+        fprintf(stderr, "Failed to allocate %d cars\n", numCars);
+        return 1;
+    }
+    RacingLine line;
+    if (useAI && !buildRacingLine(&line, track, &sim->car)) {
+        fprintf(stderr, "Failed to build the racing line\n");
+        freeCarBatch(&batch);
+        return 1;
+    }
+    CarContactGrid contacts;
+    if (useContacts && !initCarContactGrid(&contacts, numCars, &sim->car)) {
+        if (useAI) freeRacingLine(&line);
+        freeCarBatch(&batch);
+        return 1;
+    }
+    Standings standings;
+    if (useStandings && !initStandings(&standings, numCars, getTrackProgress(track))) {
+        if (useAI) freeRacingLine(&line);
+        if (useContacts) freeCarContactGrid(&contacts);
+        freeCarBatch(&batch);
+        return 1;
+    }
+    Autopilot* pilots = (Autopilot*)malloc((size_t)numCars * sizeof(Autopilot));
+    AIDriver* drivers = (AIDriver*)malloc((size_t)numCars * sizeof(AIDriver));
+    if (!pilots || !drivers) {
+        free(pilots); free(drivers);
+        if (useStandings) freeStandings(&standings);
+        if (useAI) freeRacingLine(&line);
+        if (useContacts) freeCarContactGrid(&contacts);
+        freeCarBatch(&batch);
+        return 1;
+    }
+
+    // Form the grid behind the start position (see placeCarOnGrid); the cars only
+    // touch each other with --contacts.
+    for (int i = 0; i < numCars; ++i) {
+        Car car;
+        placeCarOnGrid(&sim->car, getTrackProgress(track), i, &car);
+        addCarToBatch(&batch, &car);
+        initAutopilot(&pilots[i], track, &car);
+        if (useAI) initAIDriver(&drivers[i], &line, car.x, car.z);
+        if (useStandings) addStandingsEntry(&standings, car.x, car.z);
+    }
+    if (useStandings) sortStandings(&standings);
+    Car reference; getCarFromBatch(&batch, 0, &reference);
+    Autopilot referencePilot = pilots[0];
+    AIDriver referenceDriver = drivers[0];
+
+    long long ticks = (long long)(maxSeconds * tickRate);
+    int matches = 1;
+    clock_t wallStart = clock();
+    double driverSeconds = 0.0; // Time spent choosing the controls
+    double contactSeconds = 0.0; // Time spent in resolveCarContacts
+    double standingsSeconds = 0.0; // Time spent updating and sorting the standings
+    long long candidatePairs = 0, contactPairs = 0, standingsSwaps = 0;
+    for (long long tick = 0; tick < ticks; ++tick) {
+        double driverStart = getPlatformTimeSeconds();
+        if (useAI) {
+            updateAIDriverBatch(drivers, &line, &batch);
+        } else {
+            for (int i = 0; i < numCars; ++i) {
+                Car car; getCarFromBatch(&batch, i, &car);
+                updateAutopilot(&pilots[i], &car);
+                batch.controls[i] = getCarControlBits(&car);
+            }
+        }
+        driverSeconds += getPlatformTimeSeconds() - driverStart;
+        updateCarBatch(&batch, HEADLESS_TICK_SEC);
+        if (useContacts) {
+            double contactStart = getPlatformTimeSeconds();
+            contactPairs += resolveCarContacts(&contacts, &batch, NULL, 0);
+            contactSeconds += getPlatformTimeSeconds() - contactStart;
+            candidatePairs += contacts.candidate_pairs;
+        }
+        if (useStandings) {
+            double standingsStart = getPlatformTimeSeconds();
+            updateStandingsEntries(&standings, 0, numCars, batch.x, batch.z, (int)((tick + 1) * 1000 / tickRate));
+            sortStandings(&standings);
+            standingsSeconds += getPlatformTimeSeconds() - standingsStart;
+            standingsSwaps += standings.swaps;
+        }
+
+        if (useAI) updateAIDriver(&referenceDriver, &line, &reference);
+        else updateAutopilot(&referencePilot, &reference);
+        updateCar(&reference, &sim->track, HEADLESS_TICK_SEC);
+        if (reference.x != batch.x[0] || reference.z != batch.z[0] ||
+            reference.angle != batch.angle[0] || reference.speed != batch.speed[0]) {
+            matches = 0;
+        }
+    }
+    double wallSeconds = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+
+    printf("Track:          %s\n", getTrackLabel(track));
+    printf("Cars:           %d (%s)\n", numCars, useAI ? "racing-line AI" : "autopilot");
+    printf("Simulated time: %.2f s (%lld ticks)\n", (double)ticks / tickRate, ticks);
+    if (useContacts) matches = 1; // Contacts move cars that updateCar alone would not
+    else printf("Car 0 matches updateCar: %s\n", matches ? "yes" : "NO");
+    size_t stateBytes = (size_t)numCars * sizeof(float);
+    unsigned int checksum = hashSimBytes(SIM_HASH_SEED, batch.x, stateBytes);
+    checksum = hashSimBytes(checksum, batch.z, stateBytes);
+    checksum = hashSimBytes(checksum, batch.angle, stateBytes);
+    checksum = hashSimBytes(checksum, batch.speed, stateBytes);
+    printf("Checksum:       %08x (%s physics)\n", checksum, SIM_PHYSICS_MODE);
+    printf("Wall time:      %.3f s\n", wallSeconds);
+    if (wallSeconds > 0.0) {
+        printf("Throughput:     %.0f car-ticks/s\n", (double)ticks * numCars / wallSeconds);
+    }
+    if (ticks > 0 && numCars > 0) {
+        printf("Driver cost:    %.1f ns per car-tick\n", driverSeconds * 1e9 / ((double)ticks * numCars));
+        if (useContacts) {
+            printf("Contact cost:   %.1f ns per car-tick\n", contactSeconds * 1e9 / ((double)ticks * numCars));
+            printf("Contacts:       %.2f candidate pairs, %.2f overlapping pairs per tick\n",
+                   (double)candidatePairs / ticks, (double)contactPairs / ticks);
+        }
+        if (useStandings) {
+            printf("Standings cost: %.1f ns per car-tick (%.2f places changed per tick)\n",
+                   standingsSeconds * 1e9 / ((double)ticks * numCars), (double)standingsSwaps / ticks);
+            int timeNowMs = (int)(ticks * 1000 / tickRate);
+            for (int p = 0; p < numCars && p < 5; ++p) {
+                int id = standings.order[p], lapsBehind;
+                int gapMs = getStandingsGapMs(&standings, id, timeNowMs, &lapsBehind);
+                if (p == 0) printf("  P1  car %-5d lap %d\n", id, getStandingsLaps(&standings, id) + 1);
+                else if (lapsBehind > 0) printf("  P%-2d car %-5d +%d lap%s\n", p + 1, id, lapsBehind, lapsBehind > 1 ? "s" : "");
+                else printf("  P%-2d car %-5d +%d.%03d s\n", p + 1, id, gapMs / 1000, gapMs % 1000);
+            }
+        }
+    }
+
+    free(drivers);
+    if (useAI) freeRacingLine(&line);
+    if (useContacts) freeCarContactGrid(&contacts);
+    if (useStandings) freeStandings(&standings);
+    free(pilots);
+    freeCarBatch(&batch);
+    return matches ? 0 : 3;
+}
+
+// Formats a lap time the same way as the HUD (mm:ss.mmm).
+static void formatLapTime(int ms, char* out, size_t size) {
+    if (ms <= 0 || ms == INT_MAX) { snprintf(out, size, "--:--.---"); return; }
+    snprintf(out, size, "%02d:%02d.%03d", (ms / 1000) / 60, (ms / 1000) % 60, ms % 1000);
+}
+
+// One line of sector splits, e.g. "S1 00:04.123  S2 ...".
+static void printSectorTimes(const char* label, const SimContext* sim, const int* timesMs) {
+    printf("%s", label);
+    for (int i = 0; i < sim->sector_count; ++i) {
+        char text[16];
+        formatLapTime(timesMs[i], text, sizeof(text));
+        printf(" S%d %s", i + 1, text);
+    }
+    printf("\n");
+}
+
+// --- Replay Mode ---
+// Re-runs a recorded race and checks it ends exactly as recorded.
+static int runReplayFile(const char* path) {
+    Replay replay;
+    if (!readReplayFile(&replay, path)) return 1;
+
+    ReplayResult result;
+    double wallStart = getPlatformTimeSeconds();
+    int ran = runReplay(&replay, &result);
+    double wallSeconds = getPlatformTimeSeconds() - wallStart;
+    if (!ran) {
+        fprintf(stderr, "Replay '%s': could not be run\n", path);
+        freeReplay(&replay);
+        return 1;
+    }
+
+    char lastText[16], bestText[16];
+    formatLapTime(result.last_lap_ms, lastText, sizeof(lastText));
+    formatLapTime(result.best_lap_ms, bestText, sizeof(bestText));
+    printf("Replay:         %s (%u input runs)\n", path, replay.run_count);
+    SimTrack track;
+    initSimTrack(&track, replay.track);
+    if (replay.track == TRACK_CUSTOM) track.data = loadCustomTrack(replay.track_path); // Already loaded by runReplay
+    printf("Track:          %s\n", getTrackLabel(&track));
+    printf("Simulated time: %.2f s (%u ticks at %d Hz)\n", (double)result.ticks / replay.tick_rate, result.ticks, replay.tick_rate);
+    printf("Laps completed: %d\n", result.laps_completed);
+    printf("Last lap:       %s\n", lastText);
+    printf("Best lap:       %s\n", bestText);
+    printf("Matches recording: %s\n", result.matches ? "yes" : "NO");
+    printf("Wall time:      %.3f ms\n", wallSeconds * 1000.0);
+    freeReplay(&replay);
+    return result.matches ? 0 : 4;
+}
+
+// --- Netplay Client Mode ---
+// Races on a netserver as fast as the lockstep bound allows, driven by the
+// autopilot. Every client of a race should print the same checksum.
+static int runNetClient(const char* address) {
+    static NetClient client; // One SimContext per possible player: keep it off the stack
+    if (!openNetClient(&client, address)) return 1;
+    printf("Joining %s...\n", address);
+
+    Autopilot pilot;
+    Car driven; // The autopilot steers a copy; its controls are the local input
+    double joinStart = getPlatformTimeSeconds();
+    double wallStart = 0.0;
+    while (client.state != NET_CLIENT_FINISHED) {
+        int wasJoining = (client.state == NET_CLIENT_JOINING);
+        updateNetClient(&client);
+        if (client.state == NET_CLIENT_JOINING) {
+            if (getPlatformTimeSeconds() - joinStart > NET_TIMEOUT_SECONDS) {
+                fprintf(stderr, "No answer from %s\n", address);
+                closeNetClient(&client);
+                return 1;
+            }
+            sleepPlatformMs(1);
+            continue;
+        }
+        if (wasJoining) {
+            if (client.end_tick == 0) { // Would never finish
+                fprintf(stderr, "The race has no end; start netserver with --seconds\n");
+                closeNetClient(&client);
+                return 1;
+            }
+            printf("Player %d of %d on %s\n", client.local_player + 1, client.player_count, getTrackLabel(&client.players[0].track));
+            initAutopilot(&pilot, &client.players[0].track, &client.players[client.local_player].car);
+            wallStart = getPlatformTimeSeconds();
+        }
+        driven = client.players[client.local_player].car;
+        updateAutopilot(&pilot, &driven);
+        if (!stepNetClient(&client, getCarControlBits(&driven))) sleepPlatformMs(1);
+    }
+    double wallSeconds = getPlatformTimeSeconds() - wallStart;
+
+    const NetStats* stats = &client.stats;
+    printf("Simulated time: %.2f s (%lld ticks at %d Hz)\n", (double)client.tick / client.tick_rate, client.tick, client.tick_rate);
+    for (int p = 0; p < client.player_count; ++p) {
+        char bestText[16];
+        formatLapTime(client.players[p].best_lap_time_ms, bestText, sizeof(bestText));
+        printf("  Player %-2d %d laps, best %s%s\n", p + 1, client.players[p].laps_completed, bestText,
+               p == client.local_player ? " (this client)" : "");
+    }
+    printf("Rollbacks:      %lld (%lld ticks resimulated, %lld stalled steps)\n",
+           stats->rollbacks, stats->resimulated_ticks, stats->stalls);
+    if (client.tick > 0) {
+        printf("Traffic:        %.1f bytes up, %.1f bytes down per tick\n",
+               (double)stats->bytes_sent / client.tick, (double)stats->bytes_received / client.tick);
+    }
+    printf("Wall time:      %.3f s\n", wallSeconds);
+    printf("Checksum:       %08x\n", getNetClientChecksum(&client));
+    closeNetClient(&client);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    TrackType track = TRACK_RECT;
+    int targetLaps = 100;
+    double maxSeconds = -1.0;
+    int numCars = 0;
+    const char* profilePath = NULL;
+    const char* trackPath = NULL;   // Track file, for TRACK_CUSTOM
+    const TrackData* trackData = NULL;
+    const char* recordPath = NULL;
+    const char* telemetryPath = NULL;
+    SimTrack rules;         // Query backend and collision response; the track type is set below
+    initSimTrack(&rules, TRACK_RECT);
+    int sectorCount = DEFAULT_SECTOR_COUNT;
+
+    // --- Parse Command Line ---
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--track") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "rect") == 0) track = TRACK_RECT;
+            else if (strcmp(name, "round") == 0) track = TRACK_ROUNDED;
+            else if ((trackData = loadCustomTrack(name)) != NULL) { track = TRACK_CUSTOM; trackPath = name; }
+            else return 1; // loadCustomTrack printed why
+        } else if (strcmp(argv[i], "--laps") == 0 && i + 1 < argc) {
+            targetLaps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc) {
+            maxSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--cars") == 0 && i + 1 < argc) {
+            numCars = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0) {
+            rules.query_backend = TRACK_QUERY_GRID;
+        } else if (strcmp(argv[i], "--ai") == 0) {
+            useAI = 1;
+        } else if (strcmp(argv[i], "--contacts") == 0) {
+            useContacts = 1;
+        } else if (strcmp(argv[i], "--standings") == 0) {
+            useStandings = 1;
+        } else if (strcmp(argv[i], "--collision") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "stop") == 0) rules.collision_response = TRACK_COLLISION_STOP;
+            else if (strcmp(mode, "sweep") == 0) rules.collision_response = TRACK_COLLISION_SWEPT;
+            else { fprintf(stderr, "--collision must be stop or sweep\n"); return 1; }
+        } else if (strcmp(argv[i], "--sectors") == 0 && i + 1 < argc) {
+            sectorCount = atoi(argv[++i]);
+            if (sectorCount < 1 || sectorCount > MAX_SECTORS) {
+                fprintf(stderr, "--sectors must be between 1 and %d\n", MAX_SECTORS);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+            profilerEnabled = 1;
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            return runReplayFile(argv[++i]);
+        } else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+            return runNetClient(argv[++i]);
+        } else if (strcmp(argv[i], "--physics-hz") == 0 && i + 1 < argc) {
+            tickRate = atoi(argv[++i]);
+            if (tickRate < 1 || tickRate > SIM_MAX_TICK_RATE) {
+                fprintf(stderr, "--physics-hz must be between 1 and %d\n", SIM_MAX_TICK_RATE);
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+    SimContext sim;
+    initSimContext(&sim, track, tickRate);
+    sim.track.data = trackData;
+    sim.profiled = (profilePath != NULL);
+    sim.track.query_backend = rules.query_backend;
+    sim.track.collision_response = rules.collision_response;
+    setRaceSectors(&sim, sectorCount, NULL);
+    if (numCars > 0) {
+        return runBatch(&sim, numCars, (maxSeconds > 0.0) ? maxSeconds : 60.0);
+    }
+    if (targetLaps < 1) targetLaps = 1;
+    if (maxSeconds <= 0.0) maxSeconds = 60.0 * targetLaps;
+
+    // --- Set Up Race ---
+    initRace(&sim);
+    Car* car = &sim.car;
+    Autopilot pilot;
+    initAutopilot(&pilot, &sim.track, car);
+    RacingLine line;
+    AIDriver driver;
+    if (useAI) {
+        if (!buildRacingLine(&line, &sim.track, car)) {
+            fprintf(stderr, "Failed to build the racing line\n");
+            return 1;
+        }
+        initAIDriver(&driver, &line, car->x, car->z);
+    }
+    Replay replay;
+    if (recordPath) startReplay(&replay, track, trackPath, tickRate, car);
+    TelemetryLog telemetry;
+    if (telemetryPath && !openTelemetryLog(&telemetry, telemetryPath, tickRate)) return 1;
+
+    // --- Run Fixed-Step Simulation ---
+    long long maxTicks = (long long)(maxSeconds * tickRate);
+    long long wallTicks = 0; // Ticks on which the car touched the track edge
+    clock_t wallStart = clock();
+    while (sim.laps_completed < targetLaps && sim.ticks < maxTicks) {
+        if (useAI) updateAIDriver(&driver, &line, car);
+        else updateAutopilot(&pilot, car);
+        unsigned char controls = getCarControlBits(car);
+        if (recordPath) {
+            recordReplayTick(&replay, getReplayTickInputs(&sim.track, controls));
+        }
+        int events = updateRace(&sim); // Advances the simulated clock by one tick
+        if (events & RACE_EVENT_COLLISION) wallTicks++;
+        if (telemetryPath) {
+            TelemetryRecord record;
+            makeTelemetryRecord(&record, &sim, controls, events | (sim.ticks == 1 ? TELEMETRY_EVENT_RACE_START : 0));
+            logTelemetry(&telemetry, &record);
+        }
+        profileEndFrame(); // One profiler frame per tick
+    }
+    double wallSeconds = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+    if (telemetryPath) closeTelemetryLog(&telemetry);
+    if (useAI) freeRacingLine(&line);
+
+    // --- Report ---
+    char lastText[16], bestText[16];
+    formatLapTime(sim.last_lap_time_ms, lastText, sizeof(lastText));
+    formatLapTime(sim.best_lap_time_ms, bestText, sizeof(bestText));
+    printf("Track:          %s\n", getTrackLabel(&sim.track));
+    printf("Driver:         %s\n", useAI ? "racing-line AI" : "autopilot");
+    printf("Collision:      %s (%lld wall ticks)\n",
+           sim.track.collision_response == TRACK_COLLISION_SWEPT ? "swept, slide" : "stop", wallTicks);
+    printf("Laps completed: %d / %d\n", sim.laps_completed, targetLaps);
+    printf("Simulated time: %.2f s (%lld ticks)\n", (double)sim.ticks / tickRate, sim.ticks);
+    printf("Last lap:       %s\n", lastText);
+    printf("Best lap:       %s\n", bestText);
+    printSectorTimes("Last sectors:  ", &sim, sim.last_sector_times_ms);
+    printSectorTimes("Best sectors:  ", &sim, sim.best_sector_times_ms);
+    int laps[3] = { sim.laps_completed, sim.last_lap_time_ms, sim.best_lap_time_ms };
+    unsigned int checksum = hashSimBytes(hashSimBytes(SIM_HASH_SEED, &sim.car, sizeof(Car)), laps, sizeof(laps));
+    printf("Checksum:       %08x (%s physics)\n", checksum, SIM_PHYSICS_MODE);
+    printf("Wall time:      %.3f s\n", wallSeconds);
+    if (wallSeconds > 0.0) {
+        printf("Throughput:     %.0f laps/s, %.0f ticks/s\n", sim.laps_completed / wallSeconds, sim.ticks / wallSeconds);
+    }
+    if (recordPath) {
+        finishReplay(&replay, &sim);
+        int written = writeReplayFile(&replay, recordPath);
+        if (written) printf("Recorded:       %s (%u input runs)\n", recordPath, replay.run_count);
+        freeReplay(&replay);
+        if (!written) return 1;
+    }
+    if (profilePath) {
+        printf("Profile (last %d ticks, ms):\n", PROFILE_HISTORY_FRAMES);
+        for (int z = 0; z <= PROFILE_LAP_DETECTION; ++z) { // The zones headless runs
+            ProfileStats stats;
+            getProfileStats((ProfileZone)z, &stats);
+            printf("  %-14s min %.4f  avg %.4f  p99 %.4f\n", getProfileZoneName((ProfileZone)z),
+                   stats.min_ms, stats.avg_ms, stats.p99_ms);
+        }
+        if (!writeProfileCSV(profilePath)) return 1;
+    }
+
+    return (sim.laps_completed >= targetLaps) ? 0 : 2; // Non-zero if the time limit was hit
+}
@@ -1,11 +1,14 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <GL/glew.h>
 #include <GL/freeglut.h>
 
 #include "game.h"
-// Include BOTH track headers for rendering functions
-#include "track_rect.h"
-#include "track_round.h"
+#include "track_renderer.h" // Retained-mode track geometry
+#include "car_render.h"     // Instanced car renderer
+#include "profiler.h"       // Frame timers
+#include "text_renderer.h"  // Glyph atlas for the HUD and menu
 // car.h is included via game.h
 
 // --- Function Prototypes for GLUT Callbacks ---
@@ -25,6 +28,29 @@ int main(int argc, char** argv) {
     glutInitWindowSize(1280, 720);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("F1 Racing Simulator");
+    // Optional arguments (glutInit has removed its own):
+    //   [--physics-hz N] [--telemetry FILE] [--opponents N] [--connect HOST[:PORT]] [TRACK.trk]
+    //   physics rate, per-tick telemetry log, AI opponents, netplay server, and track file for the Custom Circuit option
+    const char* telemetryPath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--physics-hz") == 0 && i + 1 < argc) {
+            int rate = atoi(argv[++i]);
+            physicsTickRate = (rate < 1) ? 1 : (rate > SIM_MAX_TICK_RATE ? SIM_MAX_TICK_RATE : rate);
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        } else if (strcmp(argv[i], "--opponents") == 0 && i + 1 < argc) {
+            int count = atoi(argv[++i]);
+            opponentCount = (count < 0) ? 0 : (count > MAX_OPPONENTS ? MAX_OPPONENTS : count);
+        } else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+            netplayAddress = argv[++i];
+        } else {
+            customTrackPath = argv[i];
+        }
+    }
+    fprintf(stdout, "Status: Physics at %d Hz\n", physicsTickRate);
+    initSimContext(&raceSim, TRACK_RECT, physicsTickRate); // Track chosen in the menu
+    raceSim.profiled = 1; // The 'P' panel times the player's race
+    if (telemetryPath) openGameTelemetry(telemetryPath);
 
     // 2. Initialize GLEW
     GLenum err = glewInit();
@@ -46,6 +72,9 @@ int main(int argc, char** argv) {
     glEnable(GL_CULL_FACE); // Enable face culling
     glCullFace(GL_BACK);    // Cull back-facing polygons
 
+    // Car model and shaders (falls back to immediate mode without instancing)
+    initCarRenderer();
+
 
     // 4. Initial Game State Setup
     // Game starts in STATE_MENU by default (see game.c definition)
@@ -61,19 +90,23 @@ int main(int argc, char** argv) {
     glutCloseFunc(cleanup);
 
 
-    // 6. Register the Fixed-Update Timer
-    glutTimerFunc(FRAME_TIME_MS, updateGame, 0);
+    // 6. Register the Fixed-Step Update (runs whenever GLUT is idle)
+    glutIdleFunc(updateGame);
 
 
     // 7. Print Controls in Menu & Enter Main Loop
      printf("\n--- CONTROLS ---\n");
      printf(" Menu:\n");
      printf("   UP/DOWN Arrows: Select Track\n");
-     printf("   ENTER: Start Race\n");
+     printf("   ENTER: Start Race%s\n", netplayAddress ? " (joins the net race)" : "");
      printf(" Racing:\n");
      printf("   W/S: Accelerate/Brake\n");
      printf("   A/D: Turn Left/Right\n");
      printf("   R: Reset Race\n");
+     printf("   B: Rewind %d Seconds\n", REWIND_SECONDS);
+     printf("   G: Toggle Track Queries (analytic / distance grid)\n");
+     printf("   P: Toggle Profiler Panel\n");
+     printf("   C: Save Profile to %s\n", PROFILE_CSV_PATH);
      printf(" General:\n");
      printf("   ESC: Return to Menu / Exit\n");
      printf("-----------------\n\n");
@@ -88,6 +121,7 @@ int main(int argc, char** argv) {
 
 // Main Drawing Function
 void display() {
+    prepareTextRenderer(); // Builds the glyph atlas on the first frame (draws into the back buffer, so before the clear)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear buffers
 
     // Render based on the current game state
@@ -100,22 +134,24 @@ void display() {
         glMatrixMode(GL_MODELVIEW); glLoadIdentity();
         setupCamera(); // Position the camera
 
-        // Render the appropriate track based on selection
-        if (selectedTrackType == TRACK_RECT) {
-            renderRectTrack();
-            renderRectGuardrails();
-        } else { // TRACK_ROUNDED
-            renderRoundTrack();
-            renderRoundGuardrails();
-        }
+        // Render the selected track (surface, markings and guardrails were
+        // uploaded to vertex buffers by startGame; tiles outside the view are skipped)
+        profileBegin(PROFILE_TRACK_RENDER);
+        renderTrack();
+        profileEnd(PROFILE_TRACK_RENDER);
 
-        renderCar(&playerCar); // Draw the car
+        profileBegin(PROFILE_CAR_RENDER);
+        renderRaceCars(); // Draw the cars (interpolated between ticks)
+        profileEnd(PROFILE_CAR_RENDER);
 
         // --- Render 2D HUD ---
-        renderHUD(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT)); // Draw timers
+        profileBegin(PROFILE_HUD_RENDER);
+        renderHUD(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT)); // Draw timers (and the profiler panel)
+        profileEnd(PROFILE_HUD_RENDER);
     }
 
     glutSwapBuffers(); // Display the rendered frame
+    profileEndFrame(); // Physics ticks run since the last frame count towards this one
 }
 
 
@@ -154,7 +190,7 @@ void keyboardUp(unsigned char key, int x, int y) {
     if (currentGameState == STATE_RACING) {
         // Allow case-insensitivity for releasing movement keys
         if (key == 'w' || key == 'W' || key == 'a' || key == 'A' || key == 's' || key == 'S' || key == 'd' || key == 'D') {
-             setCarControls(&playerCar, key, 0); // 0 = key up
+             setCarControls(&raceSim.car, key, 0); // 0 = key up
         }
     }
 }
@@ -176,4 +212,10 @@ void specialKeyDown(int key, int x, int y) {
 // Cleanup Function
 void cleanup() {
     printf("Exiting application...\n");
+    saveRaceReplay();
+    closeGameNetplay();
+    closeGameTelemetry();
+    freeTrackRenderer();
+    freeCarRenderer();
+    freeTextRenderer();
 }
\ No newline at end of file
@@ -0,0 +1,508 @@
+#include "netplay.h"
+#include "snapshot.h" // Saved states for rollback
+#include "car_batch.h" // placeCarOnGrid
+#include "sim_math.h"  // hashSimBytes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Messages ---
+// Every datagram starts with its type byte. Multi-byte fields are little-endian.
+//   JOIN   c->s  type
+//   START  s->c  type, player, player count, track, tick rate (u16), end tick (u32)
+//   INPUT  c->s  type, player, last tick (t16), last - confirmed tick (varint), count, inputs
+//   INPUTS s->c  type, player count, then per player: for the receiving player
+//                last tick (t16); for the others count, and if it is not 0,
+//                last tick (t16) and inputs
+//   LEAVE  c->s  type, player
+// An input run ends at 'last tick', so it covers ticks last - count + 1 .. last.
+// Ticks go as their low 16 bits (t16) and are unwrapped against the nearest
+// tick the receiver knows for that player, which is never more than the
+// input history away. Inputs are the 4 CAR_CONTROL_* bits, two per byte (the
+// earlier tick in the low half). A varint is 7 bits per byte, low bits first,
+// the top bit set on every byte but the last.
+enum {
+    NET_MSG_JOIN = 1,
+    NET_MSG_START,
+    NET_MSG_INPUT,
+    NET_MSG_INPUTS,
+    NET_MSG_LEAVE
+};
+
+#define NET_JOIN_RESEND_SECONDS 0.2
+#define NET_LEAVE_MESSAGES 3   // Leave is not acknowledged, so it is sent a few times
+
+static void putU32(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)value; p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16); p[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned int getU32(const unsigned char* p) {
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void putU16(unsigned char* p, unsigned int value) {
+    p[0] = (unsigned char)value; p[1] = (unsigned char)(value >> 8);
+}
+
+// Tick whose low 16 bits are at p, nearest to 'reference'.
+static long long getTick16(const unsigned char* p, long long reference) {
+    unsigned int low = (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+    int delta = (int)((low - (unsigned int)reference) & 0xFFFFu);
+    if (delta >= 0x8000) delta -= 0x10000;
+    return reference + delta;
+}
+
+// Returns the bytes written (at most 5).
+static int putVarint(unsigned char* p, unsigned int value) {
+    int n = 0;
+    while (value >= 0x80) {
+        p[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (unsigned char)value;
+    return n;
+}
+
+// Returns the bytes read, or 0 if the varint runs past 'size' or is too long.
+static int getVarint(const unsigned char* p, int size, unsigned int* value) {
+    *value = 0;
+    for (int n = 0; n < size && n < 5; ++n) {
+        *value |= (unsigned int)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+// Packs 'count' inputs from a history ring, starting at tick 'first'. Returns the bytes written.
+static int packInputs(unsigned char* p, const unsigned char* history, long long first, int count) {
+    for (int i = 0; i < count; i += 2) {
+        unsigned char low = history[(first + i) % NET_INPUT_HISTORY] & 0x0F;
+        unsigned char high = (i + 1 < count) ? (history[(first + i + 1) % NET_INPUT_HISTORY] & 0x0F) : 0;
+        p[i / 2] = (unsigned char)(low | (high << 4));
+    }
+    return (count + 1) / 2;
+}
+
+static unsigned char getPackedInput(const unsigned char* p, long long i) {
+    return (unsigned char)((i % 2 == 0) ? (p[i / 2] & 0x0F) : (p[i / 2] >> 4));
+}
+
+static int isSameAddress(const PlatformAddress* a, const PlatformAddress* b) {
+    return a->ip == b->ip && a->port == b->port;
+}
+
+static void sendCounted(const PlatformSocket* sock, const PlatformAddress* to, const unsigned char* data, int size, NetStats* stats) {
+    if (sendPlatformDatagram(sock, to, data, size)) {
+        stats->packets_sent++;
+        stats->bytes_sent += size;
+    }
+}
+
+
+// --- Client: Simulation ---
+// Input player p drove with on tick t: the known one, else its last known one.
+static unsigned char getPlayerInput(const NetClient* client, int p, long long t) {
+    long long known = client->received[p];
+    if (t <= known) return client->inputs[p][t % NET_INPUT_HISTORY];
+    return (known > 0) ? client->inputs[p][known % NET_INPUT_HISTORY] : 0;
+}
+
+static unsigned char* getFrame(const NetClient* client, long long t) {
+    return client->frames + client->frame_size * (size_t)(t % (NET_INPUT_WINDOW + 1));
+}
+
+// One snapshot per player, back to back.
+static void saveFrame(NetClient* client, long long t) {
+    unsigned char* frame = getFrame(client, t);
+    size_t size = client->frame_size / (size_t)client->player_count;
+    for (int p = 0; p < client->player_count; ++p) {
+        SimState state = { &client->players[p], NULL, NULL, NULL };
+        saveSimSnapshot(&state, frame + size * (size_t)p);
+    }
+}
+
+static void restoreFrame(NetClient* client, long long t) {
+    const unsigned char* frame = getFrame(client, t);
+    size_t size = client->frame_size / (size_t)client->player_count;
+    for (int p = 0; p < client->player_count; ++p) {
+        SimState state = { &client->players[p], NULL, NULL, NULL };
+        restoreSimSnapshot(&state, frame + size * (size_t)p);
+    }
+}
+
+static void simulateTick(NetClient* client, long long t) {
+    for (int p = 0; p < client->player_count; ++p) {
+        unsigned char input = getPlayerInput(client, p, t);
+        client->used[p][t % NET_INPUT_HISTORY] = input;
+        setCarControlBits(&client->players[p].car, input);
+        updateRace(&client->players[p]);
+    }
+    saveFrame(client, t);
+}
+
+// Every player on the grid of the built-in track, in join order.
+static int startClientRace(NetClient* client) {
+    SimState state = { &client->players[0], NULL, NULL, NULL };
+    client->frame_size = getSimSnapshotSize(&state) * (size_t)client->player_count;
+    client->frames = (unsigned char*)malloc(client->frame_size * (NET_INPUT_WINDOW + 1));
+    if (!client->frames) return 0;
+    for (int p = 0; p < client->player_count; ++p) {
+        SimContext* sim = &client->players[p];
+        initSimContext(sim, client->track, client->tick_rate);
+        initRace(sim);
+        Car car;
+        placeCarOnGrid(&sim->car, getTrackProgress(&sim->track), p, &car);
+        setRaceStartCar(sim, &car);
+    }
+    client->tick = 0;
+    client->acked_time = getPlatformTimeSeconds();
+    saveFrame(client, 0);
+    client->state = NET_CLIENT_RACING;
+    return 1;
+}
+
+
+// --- Client: Messages ---
+static void sendClientInputs(NetClient* client) {
+    unsigned char packet[16 + NET_INPUT_WINDOW / 2];
+    long long last = client->received[client->local_player];
+    long long first = client->acked + 1;
+    // Just the newest inputs while the server keeps up; all it lacks once it stalls.
+    double now = getPlatformTimeSeconds();
+    if (now - client->acked_time < NET_RESEND_SECONDS && first < last - NET_INPUT_REDUNDANCY + 1) {
+        first = last - NET_INPUT_REDUNDANCY + 1;
+    }
+    if (first < last - NET_INPUT_WINDOW + 1) first = last - NET_INPUT_WINDOW + 1;
+    int count = (last >= first) ? (int)(last - first + 1) : 0;
+    packet[0] = NET_MSG_INPUT;
+    packet[1] = (unsigned char)client->local_player;
+    putU16(packet + 2, (unsigned int)last);
+    int size = 4 + putVarint(packet + 4, (unsigned int)(last - client->confirmed));
+    packet[size++] = (unsigned char)count;
+    size += packInputs(packet + size, client->inputs[client->local_player], first, count);
+    sendCounted(&client->socket, &client->server, packet, size, &client->stats);
+    client->last_send_time = now;
+}
+
+static void handleStart(NetClient* client, const unsigned char* data, int size) {
+    if (client->state != NET_CLIENT_JOINING || size < 10) return;
+    int players = data[2];
+    int tickRate = data[4] | (data[5] << 8);
+    // Only built-in tracks can be raced; anything else is a bad or foreign packet
+    if (players < 1 || players > NET_MAX_PLAYERS || data[1] >= players || data[3] >= TRACK_CUSTOM ||
+        tickRate < 1 || tickRate > SIM_MAX_TICK_RATE) return;
+    client->local_player = data[1];
+    client->player_count = players;
+    client->track = (TrackType)data[3];
+    client->tick_rate = tickRate;
+    client->end_tick = getU32(data + 6);
+    if (!startClientRace(client)) client->state = NET_CLIENT_FINISHED; // Out of memory: give up
+}
+
+static void handleInputs(NetClient* client, const unsigned char* data, int size) {
+    if (client->state == NET_CLIENT_JOINING || size < 2 || data[1] != client->player_count) return;
+    int offset = 2;
+    for (int p = 0; p < client->player_count; ++p) {
+        if (p == client->local_player) {
+            if (offset + 2 > size) return;
+            long long last = getTick16(data + offset, client->acked);
+            offset += 2;
+            if (last > client->acked && last <= client->received[p]) {
+                client->acked = last;
+                client->acked_time = getPlatformTimeSeconds();
+            }
+            continue;
+        }
+        if (offset + 1 > size) return;
+        int count = data[offset++];
+        if (count == 0) continue;
+        if (offset + 2 + (count + 1) / 2 > size) return;
+        long long last = getTick16(data + offset, client->received[p]);
+        const unsigned char* packed = data + offset + 2;
+        offset += 2 + (count + 1) / 2;
+        // Only runs that continue what is known are taken (a gap waits for a resend).
+        long long first = last - count + 1;
+        for (long long t = first; t <= last; ++t) {
+            if (t <= client->received[p]) continue;
+            if (t != client->received[p] + 1) break;
+            unsigned char input = getPackedInput(packed, t - first);
+            client->inputs[p][t % NET_INPUT_HISTORY] = input;
+            client->received[p] = t;
+            // Already simulated with a different guess: redo from there.
+            if (t <= client->tick && client->used[p][t % NET_INPUT_HISTORY] != input &&
+                (client->resim_from == 0 || t < client->resim_from)) {
+                client->resim_from = t;
+            }
+        }
+    }
+    long long confirmed = client->received[0];
+    for (int p = 1; p < client->player_count; ++p) {
+        if (client->received[p] < confirmed) confirmed = client->received[p];
+    }
+    client->confirmed = confirmed;
+}
+
+
+// --- Client ---
+int openNetClient(NetClient* client, const char* address) {
+    memset(client, 0, sizeof(*client));
+    client->socket.handle = -1;
+    if (!parsePlatformAddress(address, NET_DEFAULT_PORT, &client->server)) {
+        fprintf(stderr, "Netplay: bad server address '%s'\n", address);
+        return 0;
+    }
+    if (!openPlatformUdpSocket(&client->socket, 0)) {
+        fprintf(stderr, "Netplay: could not open a UDP socket\n");
+        return 0;
+    }
+    client->state = NET_CLIENT_JOINING;
+    unsigned char join = NET_MSG_JOIN;
+    sendCounted(&client->socket, &client->server, &join, 1, &client->stats);
+    client->last_send_time = getPlatformTimeSeconds();
+    return 1;
+}
+
+void closeNetClient(NetClient* client) {
+    if (client->socket.handle != -1 && client->state != NET_CLIENT_JOINING) {
+        unsigned char leave[2] = { NET_MSG_LEAVE, (unsigned char)client->local_player };
+        for (int i = 0; i < NET_LEAVE_MESSAGES; ++i) sendCounted(&client->socket, &client->server, leave, 2, &client->stats);
+    }
+    closePlatformSocket(&client->socket);
+    free(client->frames);
+    client->frames = NULL;
+}
+
+void updateNetClient(NetClient* client) {
+    unsigned char packet[NET_MAX_PACKET];
+    PlatformAddress from;
+    int size;
+    while ((size = receivePlatformDatagram(&client->socket, &from, packet, sizeof(packet))) > 0) {
+        if (!isSameAddress(&from, &client->server)) continue;
+        client->stats.packets_received++;
+        client->stats.bytes_received += size;
+        if (packet[0] == NET_MSG_START) handleStart(client, packet, size);
+        else if (packet[0] == NET_MSG_INPUTS) handleInputs(client, packet, size);
+    }
+
+    double now = getPlatformTimeSeconds();
+    if (client->state == NET_CLIENT_JOINING) {
+        if (now - client->last_send_time >= NET_JOIN_RESEND_SECONDS) {
+            unsigned char join = NET_MSG_JOIN;
+            sendCounted(&client->socket, &client->server, &join, 1, &client->stats);
+            client->last_send_time = now;
+        }
+        return;
+    }
+
+    // --- Rollback ---
+    if (client->resim_from > 0) {
+        restoreFrame(client, client->resim_from - 1);
+        for (long long t = client->resim_from; t <= client->tick; ++t) simulateTick(client, t);
+        client->stats.rollbacks++;
+        client->stats.resimulated_ticks += client->tick - client->resim_from + 1;
+        client->resim_from = 0;
+    }
+
+    if (client->state == NET_CLIENT_RACING && client->end_tick > 0 &&
+        client->confirmed >= client->end_tick && client->acked >= client->end_tick) {
+        client->state = NET_CLIENT_FINISHED;
+    }
+    // Keep the server's view (and our confirmed tick) fresh while stalled or finished.
+    if (now - client->last_send_time >= NET_RESEND_SECONDS) sendClientInputs(client);
+}
+
+int stepNetClient(NetClient* client, unsigned char controls) {
+    if (client->state != NET_CLIENT_RACING) return 0;
+    if ((client->end_tick > 0 && client->tick >= client->end_tick) ||
+        client->tick - client->confirmed >= NET_INPUT_WINDOW || client->tick - client->acked >= NET_INPUT_WINDOW) {
+        client->stats.stalls++;
+        return 0;
+    }
+    long long t = ++client->tick;
+    int local = client->local_player;
+    client->inputs[local][t % NET_INPUT_HISTORY] = controls;
+    client->received[local] = t;
+    if (client->player_count == 1) client->confirmed = t;
+    simulateTick(client, t);
+    sendClientInputs(client);
+    return 1;
+}
+
+// Over each player's car and lap results.
+unsigned int getNetClientChecksum(const NetClient* client) {
+    unsigned int hash = SIM_HASH_SEED;
+    for (int p = 0; p < client->player_count; ++p) {
+        const SimContext* sim = &client->players[p];
+        int laps[3] = { sim->laps_completed, sim->last_lap_time_ms, sim->best_lap_time_ms };
+        hash = hashSimBytes(hash, &sim->car, sizeof(Car)); // Floats and ints only, so no padding
+        hash = hashSimBytes(hash, laps, sizeof(laps));
+    }
+    return hash;
+}
+
+
+// --- Server ---
+int openNetServer(NetServer* server, int port, int playerCount, TrackType track, int tickRate, long long endTick) {
+    memset(server, 0, sizeof(*server));
+    if (playerCount < 1 || playerCount > NET_MAX_PLAYERS || track == TRACK_CUSTOM) return 0;
+    if (!openPlatformUdpSocket(&server->socket, port)) {
+        fprintf(stderr, "Netplay: could not listen on UDP port %d\n", port);
+        return 0;
+    }
+    server->player_count = playerCount;
+    server->track = track;
+    server->tick_rate = tickRate;
+    server->end_tick = endTick;
+    server->last_packet_time = getPlatformTimeSeconds();
+    return 1;
+}
+
+void closeNetServer(NetServer* server) {
+    closePlatformSocket(&server->socket);
+}
+
+static void sendStart(NetServer* server, int player) {
+    unsigned char packet[10];
+    packet[0] = NET_MSG_START;
+    packet[1] = (unsigned char)player;
+    packet[2] = (unsigned char)server->player_count;
+    packet[3] = (unsigned char)server->track;
+    packet[4] = (unsigned char)server->tick_rate;
+    packet[5] = (unsigned char)(server->tick_rate >> 8);
+    putU32(packet + 6, (unsigned int)server->end_tick);
+    sendCounted(&server->socket, &server->clients[player], packet, sizeof(packet), &server->stats);
+}
+
+static int findClient(const NetServer* server, const PlatformAddress* from) {
+    for (int p = 0; p < server->joined; ++p) {
+        if (isSameAddress(&server->clients[p], from)) return p;
+    }
+    return -1;
+}
+
+static void handleJoin(NetServer* server, const PlatformAddress* from) {
+    int player = findClient(server, from);
+    if (player < 0) {
+        if (server->started) return; // Full
+        player = server->joined++;
+        server->clients[player] = *from;
+        printf("Player %d joined (%d/%d)\n", player + 1, server->joined, server->player_count);
+        if (server->joined < server->player_count) return;
+        server->started = 1;
+        printf("Race started\n");
+        for (int p = 0; p < server->player_count; ++p) sendStart(server, p);
+        return;
+    }
+    if (server->started) sendStart(server, player); // Our START was lost
+}
+
+static void handleInput(NetServer* server, int player, const unsigned char* data, int size) {
+    if (size < 5) return;
+    long long last = getTick16(data + 2, server->received[player]);
+    unsigned int behind;
+    int offset = 4;
+    int n = getVarint(data + offset, size - offset, &behind);
+    if (n == 0) return;
+    offset += n;
+    if (offset + 1 > size) return;
+    int count = data[offset++];
+    if (offset + (count + 1) / 2 > size) return;
+    long long confirmed = last - (long long)behind;
+    if (confirmed > server->client_confirmed[player]) server->client_confirmed[player] = confirmed;
+    long long first = last - count + 1;
+    for (long long t = first; t <= last; ++t) {
+        if (t <= server->received[player]) continue;
+        if (t != server->received[player] + 1) break;
+        server->inputs[player][t % NET_INPUT_HISTORY] = getPackedInput(data + offset, t - first);
+        server->received[player] = t;
+        server->pending = 1;
+    }
+}
+
+// One INPUTS packet to every client still in the race: what it has not
+// confirmed yet of every other player, and how far its own inputs got.
+static void flushInputs(NetServer* server) {
+    int n = server->player_count;
+    // A player who left coasts on with no controls, so the others are not held up.
+    long long newest = 0;
+    for (int p = 0; p < n; ++p) {
+        if (server->received[p] > newest) newest = server->received[p];
+    }
+    for (int p = 0; p < n; ++p) {
+        while (server->gone[p] && server->received[p] < newest) {
+            server->received[p]++;
+            server->inputs[p][server->received[p] % NET_INPUT_HISTORY] = 0;
+        }
+    }
+
+    int budget = ((NET_MAX_PACKET - 2) / n - 3) * 2; // Inputs per player that fit
+    if (budget > 255) budget = 255;
+    for (int c = 0; c < n; ++c) {
+        if (server->gone[c]) continue;
+        unsigned char packet[NET_MAX_PACKET];
+        int size = 2;
+        packet[0] = NET_MSG_INPUTS;
+        packet[1] = (unsigned char)n;
+        for (int p = 0; p < n; ++p) {
+            long long last = server->received[p];
+            if (p == c) {
+                putU16(packet + size, (unsigned int)last); // Just how far its own inputs got
+                size += 2;
+                continue;
+            }
+            long long first = server->client_confirmed[c] + 1;
+            if (first < last - (NET_INPUT_HISTORY - 1)) first = last - (NET_INPUT_HISTORY - 1); // Lost from the history
+            if (last - first + 1 > budget) last = first + budget - 1;   // The rest goes in later packets
+            int count = (first <= last) ? (int)(last - first + 1) : 0;
+            packet[size++] = (unsigned char)count;
+            if (count == 0) continue;
+            putU16(packet + size, (unsigned int)last);
+            size += 2;
+            size += packInputs(packet + size, server->inputs[p], first, count);
+        }
+        sendCounted(&server->socket, &server->clients[c], packet, size, &server->stats);
+    }
+    server->pending = 0;
+    server->last_flush_time = getPlatformTimeSeconds();
+}
+
+int updateNetServer(NetServer* server) {
+    unsigned char packet[NET_MAX_PACKET];
+    PlatformAddress from;
+    int size;
+    double now = getPlatformTimeSeconds();
+    while ((size = receivePlatformDatagram(&server->socket, &from, packet, sizeof(packet))) > 0) {
+        server->stats.packets_received++;
+        server->stats.bytes_received += size;
+        server->last_packet_time = now;
+        if (packet[0] == NET_MSG_JOIN) {
+            handleJoin(server, &from);
+            continue;
+        }
+        int player = findClient(server, &from);
+        if (player < 0 || !server->started || size < 2 || packet[1] != player) continue;
+        if (packet[0] == NET_MSG_INPUT) {
+            handleInput(server, player, packet, size);
+        } else if (packet[0] == NET_MSG_LEAVE && !server->gone[player]) {
+            server->gone[player] = 1;
+            server->left++;
+            server->pending = 1;
+            printf("Player %d left (%d still racing)\n", player + 1, server->player_count - server->left);
+        }
+    }
+
+    if (server->started) {
+        // Batch what arrived within half a tick; resend now and then for lost packets.
+        double sinceFlush = now - server->last_flush_time;
+        if ((server->pending && sinceFlush >= 0.5 / server->tick_rate) || sinceFlush >= NET_RESEND_SECONDS) {
+            flushInputs(server);
+        }
+    }
+    if (server->started && server->left == server->player_count) return 0;
+    if (now - server->last_packet_time > NET_TIMEOUT_SECONDS) {
+        printf("No packets for %.0f s; ending the session\n", NET_TIMEOUT_SECONDS);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,128 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "sim.h"      // SimContext
+#include "platform.h" // UDP sockets
+
+// --- Lockstep Netplay with Rollback ---
+// Races between several players over UDP. The simulation is deterministic,
+// so every client runs the same race from the same start and only the
+// players' control bits travel: four bits per player per tick.
+//
+// Server: a relay that runs no physics. It numbers the clients as they join,
+// starts the race once all have, and forwards every player's inputs to the
+// others. Inputs arriving within half a tick are batched, so each client
+// gets one packet per tick however many players there are.
+//
+// Client: runs the whole race, one SimContext per player on a shared tick
+// clock. Local inputs apply at once. A remote player whose input for a tick
+// has not arrived yet is predicted to keep its last known controls. When an
+// input arrives that differs from the prediction, the client restores the
+// state from before that tick and resimulates up to the present. A client
+// never runs more than NET_INPUT_WINDOW ticks past the last tick it has every
+// player's input for (the lockstep bound), which also bounds the rollback
+// depth and the ring of saved states. Players do not collide with each
+// other, as with the AI opponents.
+//
+// Loss: nothing is acknowledged packet by packet. Each client packet carries
+// its newest NET_INPUT_REDUNDANCY inputs, so the next few packets cover a
+// lost one; if the server's confirmation of them stops moving for
+// NET_RESEND_SECONDS, everything unconfirmed is sent again. Ticks travel as
+// their low 16 bits and inputs two to a byte, so a client sends about 8 bytes
+// per tick. Each server packet repeats the inputs the client has not
+// confirmed yet: 4 bytes, plus 1 per other player, plus 2 and the inputs for
+// each player with any to send. Only the built-in tracks can be raced, since
+// every client must have the same one.
+
+#define NET_DEFAULT_PORT 47800
+#define NET_MAX_PLAYERS 32
+#define NET_INPUT_WINDOW 64       // Ticks a client may run ahead of its confirmed inputs (also the rollback depth)
+#define NET_INPUT_HISTORY 256     // Inputs kept per player, by tick modulo this (at least 2 * window + slack)
+#define NET_MAX_PACKET 1200       // Largest datagram sent (below a typical path MTU)
+#define NET_RESEND_SECONDS 0.05   // Unconfirmed inputs are sent again this often when nothing else is sent
+#define NET_INPUT_REDUNDANCY 3    // Newest local inputs in every client packet
+#define NET_TIMEOUT_SECONDS 10.0  // Server gives up on a session this long without a packet
+
+typedef struct {
+    long long packets_sent, packets_received;
+    long long bytes_sent, bytes_received;
+    long long rollbacks;          // Mispredictions that caused a resimulation
+    long long resimulated_ticks;
+    long long stalls;             // Steps refused by the lockstep bound
+} NetStats;
+
+// --- Client ---
+typedef enum {
+    NET_CLIENT_JOINING,           // Waiting for the server to start the race
+    NET_CLIENT_RACING,
+    NET_CLIENT_FINISHED           // Every player's input up to end_tick is known
+} NetClientState;
+
+typedef struct {
+    PlatformSocket socket;
+    PlatformAddress server;
+    NetClientState state;
+    int local_player;
+    int player_count;
+    TrackType track;
+    int tick_rate;
+    long long end_tick;           // Last tick of the race (0 = until the players leave)
+
+    SimContext players[NET_MAX_PLAYERS];
+    long long tick;               // Ticks simulated
+    long long received[NET_MAX_PLAYERS]; // Last tick whose input is known, per player
+    long long confirmed;          // Last tick whose input is known for every player
+    long long acked;              // Last local input the server has
+    double acked_time;            // When 'acked' last moved on
+    long long resim_from;         // First tick simulated with a wrong prediction (0 = none)
+    unsigned char inputs[NET_MAX_PLAYERS][NET_INPUT_HISTORY]; // Known inputs
+    unsigned char used[NET_MAX_PLAYERS][NET_INPUT_HISTORY];   // Inputs the current state was simulated with
+    unsigned char* frames;        // State after each of the last NET_INPUT_WINDOW + 1 ticks
+    size_t frame_size;
+    double last_send_time;
+    NetStats stats;
+} NetClient;
+
+// Opens a socket and asks the server at 'address' ("host[:port]") to join.
+// Returns 1 on success.
+int openNetClient(NetClient* client, const char* address);
+// Sends the server a few leave messages and releases everything.
+void closeNetClient(NetClient* client);
+// Handles the packets waiting, then resimulates if an input proved a
+// prediction wrong. Call often (e.g. every frame, and while stalled).
+void updateNetClient(NetClient* client);
+// Runs the next tick with the local player's control bits. Returns 0 if it
+// may not run yet (joining, at the lockstep bound, or past end_tick).
+int stepNetClient(NetClient* client, unsigned char controls);
+// Checksum of every player's car and lap state, equal on every client that
+// has simulated the same confirmed ticks.
+unsigned int getNetClientChecksum(const NetClient* client);
+
+// --- Server ---
+typedef struct {
+    PlatformSocket socket;
+    int player_count;             // Players the race starts with
+    int joined, left;
+    TrackType track;
+    int tick_rate;
+    long long end_tick;
+    int started;
+    PlatformAddress clients[NET_MAX_PLAYERS];
+    long long received[NET_MAX_PLAYERS];         // Last tick whose input the server has, per player
+    long long client_confirmed[NET_MAX_PLAYERS]; // Last tick each client has every input for
+    int gone[NET_MAX_PLAYERS];
+    unsigned char inputs[NET_MAX_PLAYERS][NET_INPUT_HISTORY];
+    int pending;                  // New inputs not yet forwarded
+    double last_flush_time;
+    double last_packet_time;
+    NetStats stats;
+} NetServer;
+
+// Listens on 'port' for 'playerCount' players. Returns 1 on success.
+int openNetServer(NetServer* server, int port, int playerCount, TrackType track, int tickRate, long long endTick);
+void closeNetServer(NetServer* server);
+// Handles the packets waiting and forwards inputs. Returns 0 once every
+// player has left (or the session timed out).
+int updateNetServer(NetServer* server);
+
+#endif // NETPLAY_H
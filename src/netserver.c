@@ -0,0 +1,80 @@
+// Netplay relay server.
+// Waits for the given number of players (the windowed game or the headless
+// runner started with --connect), starts their race on a built-in track and
+// forwards each player's inputs to the others until everyone has left. It
+// runs no physics; see netplay.h for the protocol.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "netplay.h"
+#include "platform.h" // sleepPlatformMs
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [--players N] [--track rect|round] [--port N] [--physics-hz N] [--seconds S]\n", prog);
+    printf("  --players     Players the race starts with (1-%d, default: 2)\n", NET_MAX_PLAYERS);
+    printf("  --track       Track to race on (default: rect)\n");
+    printf("  --port        UDP port to listen on (default: %d)\n", NET_DEFAULT_PORT);
+    printf("  --physics-hz  Physics ticks per simulated second (default: %d)\n", SIM_DEFAULT_TICK_RATE);
+    printf("  --seconds     Race length in simulated seconds (default: until the players leave)\n");
+}
+
+int main(int argc, char** argv) {
+    int players = 2;
+    TrackType track = TRACK_RECT;
+    int port = NET_DEFAULT_PORT;
+    int tickRate = SIM_DEFAULT_TICK_RATE;
+    double seconds = 0.0;
+
+    // --- Parse Command Line ---
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            players = atoi(argv[++i]);
+            if (players < 1 || players > NET_MAX_PLAYERS) {
+                fprintf(stderr, "--players must be between 1 and %d\n", NET_MAX_PLAYERS);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--track") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "rect") == 0) track = TRACK_RECT;
+            else if (strcmp(name, "round") == 0) track = TRACK_ROUNDED;
+            else { fprintf(stderr, "Unknown track '%s'\n", name); return 1; }
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--physics-hz") == 0 && i + 1 < argc) {
+            tickRate = atoi(argv[++i]);
+            if (tickRate < 1 || tickRate > SIM_MAX_TICK_RATE) {
+                fprintf(stderr, "--physics-hz must be between 1 and %d\n", SIM_MAX_TICK_RATE);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    long long endTick = (seconds > 0.0) ? (long long)(seconds * tickRate + 0.5) : 0;
+    static NetServer server; // Input history for every player: keep it off the stack
+    if (!openNetServer(&server, port, players, track, tickRate, endTick)) return 1;
+    printf("Waiting for %d player(s) on UDP port %d...\n", players, port);
+
+    while (updateNetServer(&server)) sleepPlatformMs(1);
+
+    long long ticks = 0;
+    for (int p = 0; p < players; ++p) {
+        if (server.received[p] > ticks) ticks = server.received[p];
+    }
+    printf("Ticks: %lld\n", ticks);
+    printf("Sent: %lld packets, %lld bytes; received: %lld packets, %lld bytes\n",
+           server.stats.packets_sent, server.stats.bytes_sent,
+           server.stats.packets_received, server.stats.bytes_received);
+    if (ticks > 0 && server.joined > 0) {
+        printf("Per player per tick: %.1f bytes up, %.1f bytes down\n",
+               (double)server.stats.bytes_received / server.joined / ticks,
+               (double)server.stats.bytes_sent / server.joined / ticks);
+    }
+    closeNetServer(&server);
+    return 0;
+}
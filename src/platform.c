@@ -0,0 +1,324 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // mmap/fstat/clock_gettime under -std=c99
+#endif
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h> // Before windows.h, which would pull in the old winsock.h
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#endif
+
+// --- Read-Only File Mapping ---
+#ifdef _WIN32
+int mapFileReadOnly(const char* path, PlatformFileMap* map) {
+    memset(map, 0, sizeof(*map));
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); return 0; }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file); // The mapping keeps the file open
+    if (!mapping) return 0;
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) { CloseHandle(mapping); return 0; }
+
+    map->data = data;
+    map->size = (size_t)size.QuadPart;
+    map->handle = mapping;
+    return 1;
+}
+
+void unmapFile(PlatformFileMap* map) {
+    if (map->data) UnmapViewOfFile(map->data);
+    if (map->handle) CloseHandle((HANDLE)map->handle);
+    memset(map, 0, sizeof(*map));
+}
+#else
+int mapFileReadOnly(const char* path, PlatformFileMap* map) {
+    memset(map, 0, sizeof(*map));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return 0; }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (data == MAP_FAILED) return 0;
+
+    map->data = data;
+    map->size = (size_t)st.st_size;
+    return 1;
+}
+
+void unmapFile(PlatformFileMap* map) {
+    if (map->data) munmap((void*)map->data, map->size);
+    memset(map, 0, sizeof(*map));
+}
+#endif
+
+// --- High-Resolution Clock ---
+#ifdef _WIN32
+double getPlatformTimeSeconds(void) {
+    static LARGE_INTEGER frequency; // Fixed at boot, so read once
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+void sleepPlatformMs(int ms) {
+    Sleep((DWORD)ms);
+}
+#else
+double getPlatformTimeSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void sleepPlatformMs(int ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+#endif
+
+// --- Threads ---
+// The function and argument are passed to the new thread in a small heap
+// block, since the native entry point signatures differ.
+typedef struct {
+    PlatformThreadFunction function;
+    void* arg;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI threadEntry(LPVOID param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.function(start.arg);
+    return 0;
+}
+
+int startPlatformThread(PlatformThread* thread, PlatformThreadFunction function, void* arg) {
+    thread->handle = NULL;
+    ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start) return 0;
+    start->function = function;
+    start->arg = arg;
+    HANDLE handle = CreateThread(NULL, 0, threadEntry, start, 0, NULL);
+    if (!handle) { free(start); return 0; }
+    thread->handle = handle;
+    return 1;
+}
+
+void joinPlatformThread(PlatformThread* thread) {
+    if (!thread->handle) return;
+    WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+    CloseHandle((HANDLE)thread->handle);
+    thread->handle = NULL;
+}
+
+int getPlatformCpuCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+#else
+static void* threadEntry(void* param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.function(start.arg);
+    return NULL;
+}
+
+int startPlatformThread(PlatformThread* thread, PlatformThreadFunction function, void* arg) {
+    thread->handle = NULL;
+    pthread_t* handle = (pthread_t*)malloc(sizeof(pthread_t));
+    ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!handle || !start) { free(handle); free(start); return 0; }
+    start->function = function;
+    start->arg = arg;
+    if (pthread_create(handle, NULL, threadEntry, start) != 0) {
+        free(handle);
+        free(start);
+        return 0;
+    }
+    thread->handle = handle;
+    return 1;
+}
+
+void joinPlatformThread(PlatformThread* thread) {
+    if (!thread->handle) return;
+    pthread_join(*(pthread_t*)thread->handle, NULL);
+    free(thread->handle);
+    thread->handle = NULL;
+}
+
+int getPlatformCpuCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+#endif
+
+
+// --- One-Time Initialization ---
+#define ONCE_NOT_RUN 0
+#define ONCE_RUNNING 1
+#define ONCE_DONE 2
+
+int runPlatformOnce(int* flag, PlatformOnceFunction function, void* arg) {
+    for (;;) {
+        int state = platformAtomicLoad(flag);
+        if (state == ONCE_DONE) return 1;
+        if (state == ONCE_NOT_RUN && platformAtomicCompareExchange(flag, &state, ONCE_RUNNING)) {
+            int ok = function(arg);
+            platformAtomicStore(flag, ok ? ONCE_DONE : ONCE_NOT_RUN);
+            return ok;
+        }
+        sleepPlatformMs(1); // Another thread is building it (builds are one-off and short)
+    }
+}
+
+
+// --- UDP Sockets ---
+static void toSockaddr(const PlatformAddress* address, struct sockaddr_in* out) {
+    memset(out, 0, sizeof(*out));
+    out->sin_family = AF_INET;
+    out->sin_addr.s_addr = htonl(address->ip);
+    out->sin_port = htons(address->port);
+}
+
+#ifdef _WIN32
+typedef int PlatformSockLen;
+
+// Winsock needs starting once per process before the first socket.
+static int startWinsock(void) {
+    static int started = 0;
+    if (!started) {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return 0;
+        started = 1;
+    }
+    return 1;
+}
+
+int openPlatformUdpSocket(PlatformSocket* sock, int port) {
+    sock->handle = -1;
+    if (!startWinsock()) return 0;
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET) return 0;
+    PlatformAddress any = { 0, (unsigned short)port };
+    struct sockaddr_in local;
+    toSockaddr(&any, &local);
+    u_long nonBlocking = 1;
+    if (bind(s, (struct sockaddr*)&local, sizeof(local)) != 0 || ioctlsocket(s, FIONBIO, &nonBlocking) != 0) {
+        closesocket(s);
+        return 0;
+    }
+    sock->handle = (long long)s;
+    return 1;
+}
+
+void closePlatformSocket(PlatformSocket* sock) {
+    if (sock->handle != -1) closesocket((SOCKET)sock->handle);
+    sock->handle = -1;
+}
+
+// A datagram sent to a closed port comes back as WSAECONNRESET on the next
+// receive; that says nothing about the datagrams still queued.
+static int isTransientReceiveError(void) {
+    return WSAGetLastError() == WSAECONNRESET;
+}
+#define PLATFORM_SOCKET(sock) ((SOCKET)(sock)->handle)
+#else
+typedef socklen_t PlatformSockLen;
+
+int openPlatformUdpSocket(PlatformSocket* sock, int port) {
+    sock->handle = -1;
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) return 0;
+    PlatformAddress any = { 0, (unsigned short)port };
+    struct sockaddr_in local;
+    toSockaddr(&any, &local);
+    int flags = fcntl(s, F_GETFL, 0);
+    if (bind(s, (struct sockaddr*)&local, sizeof(local)) != 0 || flags < 0 || fcntl(s, F_SETFL, flags | O_NONBLOCK) != 0) {
+        close(s);
+        return 0;
+    }
+    sock->handle = s;
+    return 1;
+}
+
+void closePlatformSocket(PlatformSocket* sock) {
+    if (sock->handle != -1) close((int)sock->handle);
+    sock->handle = -1;
+}
+
+static int isTransientReceiveError(void) {
+    return errno == ECONNREFUSED || errno == EINTR;
+}
+#define PLATFORM_SOCKET(sock) ((int)(sock)->handle)
+#endif
+
+int sendPlatformDatagram(const PlatformSocket* sock, const PlatformAddress* to, const void* data, int size) {
+    struct sockaddr_in remote;
+    toSockaddr(to, &remote);
+    return sendto(PLATFORM_SOCKET(sock), (const char*)data, size, 0, (struct sockaddr*)&remote, sizeof(remote)) == size;
+}
+
+int receivePlatformDatagram(const PlatformSocket* sock, PlatformAddress* from, void* buffer, int capacity) {
+    for (;;) {
+        struct sockaddr_in remote;
+        PlatformSockLen length = sizeof(remote);
+        int size = (int)recvfrom(PLATFORM_SOCKET(sock), (char*)buffer, capacity, 0, (struct sockaddr*)&remote, &length);
+        if (size < 0 && isTransientReceiveError()) continue;
+        if (size <= 0) return 0; // Nothing waiting (or an error, treated the same)
+        from->ip = ntohl(remote.sin_addr.s_addr);
+        from->port = ntohs(remote.sin_port);
+        return size;
+    }
+}
+
+int parsePlatformAddress(const char* text, int defaultPort, PlatformAddress* address) {
+    unsigned int parts[4] = { 127, 0, 0, 1 };
+    const char* p = text;
+    if (strncmp(p, "localhost", 9) == 0) {
+        p += 9;
+    } else {
+        for (int i = 0; i < 4; ++i) {
+            char* end;
+            unsigned long value = strtoul(p, &end, 10);
+            if (end == p || value > 255 || (i < 3 && *end != '.')) return 0;
+            parts[i] = (unsigned int)value;
+            p = (i < 3) ? end + 1 : end;
+        }
+    }
+    long port = defaultPort;
+    if (*p == ':') {
+        char* end;
+        port = strtol(p + 1, &end, 10);
+        p = end;
+    }
+    if (*p != '\0' || port < 1 || port > 65535) return 0;
+    address->ip = (parts[0] << 24) | (parts[1] << 16) | (parts[2] << 8) | parts[3];
+    address->port = (unsigned short)port;
+    return 1;
+}
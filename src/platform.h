@@ -0,0 +1,79 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stddef.h>
+
+// --- Platform Layer ---
+// The few OS services the simulation needs that differ between Windows and
+// POSIX systems. Everything else in src/ is plain C99.
+
+// --- Read-Only File Mapping ---
+// Maps a whole file into memory read-only. Pages are shared between every
+// process that maps the same file, so many simulation instances can use one
+// copy of a large track without each reading it in.
+typedef struct {
+    const void* data; // Start of the mapped file (NULL if not mapped)
+    size_t size;      // File size in bytes
+    void* handle;     // Platform mapping handle (Windows only)
+} PlatformFileMap;
+
+int mapFileReadOnly(const char* path, PlatformFileMap* map); // Returns 1 on success
+void unmapFile(PlatformFileMap* map);
+
+// --- High-Resolution Clock ---
+// Monotonic time in seconds from an arbitrary start, with sub-microsecond
+// resolution on both platforms (for profiling, not for the race clock).
+double getPlatformTimeSeconds(void);
+void sleepPlatformMs(int ms);
+
+// --- Threads ---
+// Just enough for background workers (e.g. the telemetry writer).
+typedef struct {
+    void* handle;
+} PlatformThread;
+
+typedef void (*PlatformThreadFunction)(void* arg);
+int startPlatformThread(PlatformThread* thread, PlatformThreadFunction function, void* arg); // Returns 1 on success
+void joinPlatformThread(PlatformThread* thread);
+int getPlatformCpuCount(void); // Logical processors available to the process (at least 1)
+
+// --- UDP Sockets ---
+// Non-blocking IPv4 datagram sockets, for netplay. Addresses are in host
+// byte order. Link with ws2_32 on Windows.
+typedef struct {
+    unsigned int ip;      // e.g. 0x7F000001 for 127.0.0.1
+    unsigned short port;
+} PlatformAddress;
+
+typedef struct {
+    long long handle;     // Native socket (-1 if not open)
+} PlatformSocket;
+
+int openPlatformUdpSocket(PlatformSocket* sock, int port); // port 0 picks any free port; returns 1 on success
+void closePlatformSocket(PlatformSocket* sock);
+// Sends one datagram; returns 1 if it was handed to the network.
+int sendPlatformDatagram(const PlatformSocket* sock, const PlatformAddress* to, const void* data, int size);
+// Receives one waiting datagram into 'buffer' and returns its size, or 0 if none is waiting.
+int receivePlatformDatagram(const PlatformSocket* sock, PlatformAddress* from, void* buffer, int capacity);
+// Parses "a.b.c.d[:port]" or "localhost[:port]"; returns 1 on success.
+int parsePlatformAddress(const char* text, int defaultPort, PlatformAddress* address);
+
+// --- Atomics ---
+// Acquire/release loads and stores for lock-free hand-off between threads
+// (GCC/Clang builtins, available in the gcc/MinGW toolchain this builds with).
+#define platformAtomicLoad(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define platformAtomicStore(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+// Stores 'desired' if *ptr equals *expected and returns 1; otherwise loads *ptr into *expected and returns 0.
+#define platformAtomicCompareExchange(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+// --- One-Time Initialization ---
+// For shared caches built on first use by whichever thread gets there first.
+// 'flag' is an int starting at 0. The first caller runs 'function' (which
+// returns 1 on success) while any others wait for it; once it has succeeded,
+// later calls return 1 straight away. After a failure the next call retries.
+// Storing 0 in the flag (with no call in progress) makes the next call run it again.
+typedef int (*PlatformOnceFunction)(void* arg);
+int runPlatformOnce(int* flag, PlatformOnceFunction function, void* arg);
+
+#endif // PLATFORM_H
@@ -0,0 +1,113 @@
+#include "profiler.h"
+#include "platform.h" // getPlatformTimeSeconds
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int profilerEnabled = 0;
+
+static const char* zoneNames[PROFILE_ZONE_COUNT] = {
+    "physics", "lap_detection", "track_render", "car_render", "hud_render", "frame"
+};
+
+// --- Profiler State ---
+static double zoneStart[PROFILE_ZONE_COUNT];       // Time of the open profileBegin per zone
+static double currentFrame[PROFILE_ZONE_COUNT];    // Time summed into the frame in progress (seconds)
+static float history[PROFILE_HISTORY_FRAMES][PROFILE_ZONE_COUNT]; // Ring buffer of completed frames (ms)
+static int historyNext = 0;                        // Slot the next completed frame goes into
+static int historyCount = 0;                       // Completed frames stored (up to PROFILE_HISTORY_FRAMES)
+static long long framesRecorded = 0;               // Total frames since reset (CSV frame numbers)
+static double frameStart = -1.0;                   // Start of the frame in progress (-1 = none yet)
+
+// --- Timers ---
+void profileBegin(ProfileZone zone) {
+    if (!profilerEnabled) return;
+    zoneStart[zone] = getPlatformTimeSeconds();
+}
+
+void profileEnd(ProfileZone zone) {
+    if (!profilerEnabled) return;
+    currentFrame[zone] += getPlatformTimeSeconds() - zoneStart[zone];
+}
+
+void profileEndFrame(void) {
+    if (!profilerEnabled) {
+        frameStart = -1.0; // Start a fresh frame when re-enabled
+        return;
+    }
+    double now = getPlatformTimeSeconds();
+    if (frameStart >= 0.0) {
+        currentFrame[PROFILE_FRAME] = now - frameStart;
+        for (int z = 0; z < PROFILE_ZONE_COUNT; ++z) {
+            history[historyNext][z] = (float)(currentFrame[z] * 1000.0);
+        }
+        historyNext = (historyNext + 1) % PROFILE_HISTORY_FRAMES;
+        if (historyCount < PROFILE_HISTORY_FRAMES) historyCount++;
+        framesRecorded++;
+    }
+    memset(currentFrame, 0, sizeof(currentFrame));
+    frameStart = now;
+}
+
+void resetProfiler(void) {
+    memset(currentFrame, 0, sizeof(currentFrame));
+    historyNext = 0;
+    historyCount = 0;
+    framesRecorded = 0;
+    frameStart = -1.0;
+}
+
+// --- Statistics ---
+const char* getProfileZoneName(ProfileZone zone) {
+    return (zone >= 0 && zone < PROFILE_ZONE_COUNT) ? zoneNames[zone] : "?";
+}
+
+static int compareFloats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+void getProfileStats(ProfileZone zone, ProfileStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->frames = historyCount;
+    if (historyCount == 0) return;
+
+    float sorted[PROFILE_HISTORY_FRAMES];
+    double sum = 0.0;
+    for (int i = 0; i < historyCount; ++i) {
+        sorted[i] = history[i][zone];
+        sum += sorted[i];
+    }
+    qsort(sorted, (size_t)historyCount, sizeof(float), compareFloats);
+    int p99Index = (historyCount * 99 + 99) / 100 - 1; // Nearest-rank percentile
+    stats->min_ms = sorted[0];
+    stats->max_ms = sorted[historyCount - 1];
+    stats->avg_ms = sum / historyCount;
+    stats->p99_ms = sorted[p99Index];
+    stats->last_ms = history[(historyNext + PROFILE_HISTORY_FRAMES - 1) % PROFILE_HISTORY_FRAMES][zone];
+}
+
+// --- CSV Export ---
+int writeProfileCSV(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Could not write profile to '%s'\n", path);
+        return 0;
+    }
+    fprintf(out, "frame");
+    for (int z = 0; z < PROFILE_ZONE_COUNT; ++z) fprintf(out, ",%s_ms", zoneNames[z]);
+    fprintf(out, "\n");
+
+    // Oldest frame first
+    int oldest = (historyNext + PROFILE_HISTORY_FRAMES - historyCount) % PROFILE_HISTORY_FRAMES;
+    long long firstFrame = framesRecorded - historyCount;
+    for (int i = 0; i < historyCount; ++i) {
+        const float* frame = history[(oldest + i) % PROFILE_HISTORY_FRAMES];
+        fprintf(out, "%lld", firstFrame + i);
+        for (int z = 0; z < PROFILE_ZONE_COUNT; ++z) fprintf(out, ",%.4f", frame[z]);
+        fprintf(out, "\n");
+    }
+    int ok = !ferror(out);
+    if (fclose(out) != 0) ok = 0;
+    return ok;
+}
@@ -0,0 +1,40 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// --- Frame Profiler ---
+// Scoped timers around the main parts of a frame. Time spent in each zone is
+// summed over a frame (e.g. several physics ticks), and the totals of the last
+// PROFILE_HISTORY_FRAMES frames are kept in a ring buffer for min/avg/p99
+// statistics, the HUD panel and CSV export. When profilerEnabled is 0 the
+// timers cost one branch each.
+
+#define PROFILE_HISTORY_FRAMES 256
+
+typedef enum {
+    PROFILE_PHYSICS,        // updateCar
+    PROFILE_LAP_DETECTION,  // Finish line checks and lap timing
+    PROFILE_TRACK_RENDER,   // Track surface, markings and guardrails
+    PROFILE_CAR_RENDER,     // Cars
+    PROFILE_HUD_RENDER,     // Lap timers and this panel
+    PROFILE_FRAME,          // Whole frame, measured between profileEndFrame calls
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+typedef struct {
+    double min_ms, avg_ms, p99_ms, max_ms; // Over the frames in the history
+    double last_ms;                        // Most recent completed frame
+    int frames;                            // Frames in the history (up to PROFILE_HISTORY_FRAMES)
+} ProfileStats;
+
+extern int profilerEnabled; // Defined in profiler.c, defaults to 0
+
+void profileBegin(ProfileZone zone);
+void profileEnd(ProfileZone zone);     // Adds the time since the matching profileBegin to this frame
+void profileEndFrame(void);            // Closes the current frame and pushes it into the history
+void resetProfiler(void);              // Clears the history
+
+const char* getProfileZoneName(ProfileZone zone);
+void getProfileStats(ProfileZone zone, ProfileStats* stats);
+int writeProfileCSV(const char* path); // One row per frame in the history; returns 1 on success
+
+#endif // PROFILER_H
@@ -0,0 +1,299 @@
+#include "replay.h"
+#include "sim_math.h" // SIM_PHYSICS_MODE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- File Layout ---
+// ReplayFileHeader, then 'data_size' bytes of runs. Each run is its tick
+// count as a little-endian base-128 varint followed by the input byte.
+
+// A Car as stored in the file: every field but the heading's cached
+// sine/cosine, which are rebuilt from the angle when read.
+typedef struct {
+    float x, y, z;
+    float prev_x, prev_z;
+    float angle;
+    float speed, acceleration_rate, braking_rate, friction, turn_speed, max_speed, max_reverse_speed;
+    int accelerating, braking, turning_left, turning_right;
+    float width, height, length;
+} ReplayFileCar;
+
+typedef struct {
+    unsigned int magic;            // REPLAY_FILE_MAGIC
+    unsigned int version;          // REPLAY_FILE_VERSION
+    int track;                     // TrackType
+    int tick_rate;
+    char track_path[REPLAY_TRACK_PATH_LENGTH];
+    char physics_mode[REPLAY_PHYSICS_MODE_LENGTH]; // SIM_PHYSICS_MODE, NUL-terminated
+    ReplayFileCar initial_car;
+    ReplayFileCar final_car;
+    int laps_completed, last_lap_ms, best_lap_ms;
+    unsigned int tick_count;
+    unsigned int run_count;
+    unsigned int data_size;        // Bytes of encoded runs after the header
+} ReplayFileHeader;
+
+#define REPLAY_MAX_RUN_BYTES 6 // 5 varint bytes for a 32-bit count plus the input byte
+
+static void packReplayCar(const Car* car, ReplayFileCar* out) {
+    memset(out, 0, sizeof(*out));
+    out->x = car->x; out->y = car->y; out->z = car->z;
+    out->prev_x = car->prev_x; out->prev_z = car->prev_z;
+    out->angle = car->angle;
+    out->speed = car->speed;
+    out->acceleration_rate = car->acceleration_rate;
+    out->braking_rate = car->braking_rate;
+    out->friction = car->friction;
+    out->turn_speed = car->turn_speed;
+    out->max_speed = car->max_speed;
+    out->max_reverse_speed = car->max_reverse_speed;
+    out->accelerating = car->accelerating; out->braking = car->braking;
+    out->turning_left = car->turning_left; out->turning_right = car->turning_right;
+    out->width = car->width; out->height = car->height; out->length = car->length;
+}
+
+static void unpackReplayCar(const ReplayFileCar* in, Car* car) {
+    memset(car, 0, sizeof(*car));
+    car->x = in->x; car->y = in->y; car->z = in->z;
+    car->prev_x = in->prev_x; car->prev_z = in->prev_z;
+    setCarAngle(car, in->angle);
+    car->speed = in->speed;
+    car->acceleration_rate = in->acceleration_rate;
+    car->braking_rate = in->braking_rate;
+    car->friction = in->friction;
+    car->turn_speed = in->turn_speed;
+    car->max_speed = in->max_speed;
+    car->max_reverse_speed = in->max_reverse_speed;
+    car->accelerating = in->accelerating; car->braking = in->braking;
+    car->turning_left = in->turning_left; car->turning_right = in->turning_right;
+    car->width = in->width; car->height = in->height; car->length = in->length;
+}
+
+// --- Recording ---
+void startReplay(Replay* replay, TrackType track, const char* trackPath, int tickRate, const Car* initialCar) {
+    memset(replay, 0, sizeof(*replay));
+    replay->track = track;
+    if (trackPath) strncpy(replay->track_path, trackPath, REPLAY_TRACK_PATH_LENGTH - 1);
+    replay->tick_rate = tickRate;
+    strncpy(replay->physics_mode, SIM_PHYSICS_MODE, REPLAY_PHYSICS_MODE_LENGTH - 1);
+    replay->initial_car = *initialCar;
+}
+
+void recordReplayTick(Replay* replay, unsigned char inputs) {
+    if (replay->failed) return;
+    // Extend the current run while the inputs stay the same
+    if (replay->run_count > 0) {
+        ReplayRun* last = &replay->runs[replay->run_count - 1];
+        if (last->inputs == inputs && last->ticks < 0xFFFFFFFFu) {
+            last->ticks++;
+            replay->tick_count++;
+            return;
+        }
+    }
+    if (replay->run_count == replay->run_capacity) {
+        unsigned int capacity = replay->run_capacity ? replay->run_capacity * 2 : 256;
+        ReplayRun* grown = (ReplayRun*)realloc(replay->runs, sizeof(ReplayRun) * capacity);
+        if (!grown) { replay->failed = 1; return; }
+        replay->runs = grown;
+        replay->run_capacity = capacity;
+    }
+    replay->runs[replay->run_count].ticks = 1;
+    replay->runs[replay->run_count].inputs = inputs;
+    replay->run_count++;
+    replay->tick_count++;
+}
+
+void truncateReplay(Replay* replay, unsigned int tickCount) {
+    if (tickCount >= replay->tick_count) return;
+    // Keep whole runs up to the cut, then the part of the run it falls in.
+    unsigned int kept = 0, i = 0;
+    while (i < replay->run_count && kept + replay->runs[i].ticks <= tickCount) kept += replay->runs[i++].ticks;
+    if (kept < tickCount) {
+        replay->runs[i].ticks = tickCount - kept;
+        i++;
+    }
+    replay->run_count = i;
+    replay->tick_count = tickCount;
+}
+
+unsigned char getReplayTickInputs(const SimTrack* track, unsigned char controls) {
+    unsigned char inputs = controls;
+    if (track->query_backend == TRACK_QUERY_GRID) inputs |= REPLAY_FLAG_GRID_BACKEND;
+    if (track->collision_response == TRACK_COLLISION_SWEPT) inputs |= REPLAY_FLAG_SWEPT_COLLISION;
+    return inputs;
+}
+
+void finishReplay(Replay* replay, const SimContext* sim) {
+    replay->final_car = sim->car;
+    replay->laps_completed = sim->laps_completed;
+    replay->last_lap_ms = sim->last_lap_time_ms;
+    replay->best_lap_ms = sim->best_lap_time_ms;
+}
+
+void freeReplay(Replay* replay) {
+    free(replay->runs);
+    memset(replay, 0, sizeof(*replay));
+}
+
+// --- Files ---
+int writeReplayFile(const Replay* replay, const char* path) {
+    if (replay->failed) {
+        fprintf(stderr, "Replay '%s': recording ran out of memory, not written\n", path);
+        return 0;
+    }
+    unsigned char* data = (unsigned char*)malloc((size_t)replay->run_count * REPLAY_MAX_RUN_BYTES + 1);
+    if (!data) return 0;
+    size_t size = 0;
+    for (unsigned int i = 0; i < replay->run_count; ++i) {
+        unsigned int ticks = replay->runs[i].ticks;
+        do {
+            unsigned char byte = ticks & 0x7F;
+            ticks >>= 7;
+            data[size++] = byte | (ticks ? 0x80 : 0);
+        } while (ticks);
+        data[size++] = replay->runs[i].inputs;
+    }
+
+    ReplayFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = REPLAY_FILE_MAGIC;
+    header.version = REPLAY_FILE_VERSION;
+    header.track = (int)replay->track;
+    header.tick_rate = replay->tick_rate;
+    memcpy(header.track_path, replay->track_path, REPLAY_TRACK_PATH_LENGTH);
+    memcpy(header.physics_mode, replay->physics_mode, REPLAY_PHYSICS_MODE_LENGTH);
+    packReplayCar(&replay->initial_car, &header.initial_car);
+    packReplayCar(&replay->final_car, &header.final_car);
+    header.laps_completed = replay->laps_completed;
+    header.last_lap_ms = replay->last_lap_ms;
+    header.best_lap_ms = replay->best_lap_ms;
+    header.tick_count = replay->tick_count;
+    header.run_count = replay->run_count;
+    header.data_size = (unsigned int)size;
+
+    FILE* out = fopen(path, "wb");
+    int ok = (out != NULL);
+    if (ok) ok = (fwrite(&header, sizeof(header), 1, out) == 1) && (size == 0 || fwrite(data, size, 1, out) == 1);
+    if (out && fclose(out) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Replay '%s': could not write\n", path);
+    free(data);
+    return ok;
+}
+
+int readReplayFile(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "Replay '%s': could not open\n", path);
+        return 0;
+    }
+    ReplayFileHeader header;
+    const char* error = NULL;
+    unsigned char* data = NULL;
+    if (fread(&header, sizeof(header), 1, in) != 1 || header.magic != REPLAY_FILE_MAGIC) {
+        error = "not a replay file";
+    } else if (header.version != REPLAY_FILE_VERSION) {
+        error = "unsupported version";
+    } else if (header.track < TRACK_RECT || header.track > TRACK_CUSTOM ||
+               header.tick_rate < 1 || header.tick_rate > SIM_MAX_TICK_RATE ||
+               header.data_size > (size_t)header.run_count * REPLAY_MAX_RUN_BYTES) {
+        error = "bad header";
+    } else {
+        data = (unsigned char*)malloc(header.data_size + 1);
+        replay->runs = (ReplayRun*)malloc(sizeof(ReplayRun) * (header.run_count + 1));
+        if (!data || !replay->runs) error = "out of memory";
+        else if (header.data_size > 0 && fread(data, header.data_size, 1, in) != 1) error = "truncated";
+    }
+    fclose(in);
+
+    // Decode the runs and check they add up to the recorded tick count
+    size_t pos = 0;
+    unsigned long long ticks = 0;
+    for (unsigned int i = 0; !error && i < header.run_count; ++i) {
+        unsigned int count = 0;
+        int shift = 0;
+        unsigned char byte;
+        do {
+            if (pos >= header.data_size || shift > 28) { error = "corrupt run data"; break; }
+            byte = data[pos++];
+            count |= (unsigned int)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        if (error) break;
+        if (pos >= header.data_size || count == 0) { error = "corrupt run data"; break; }
+        replay->runs[i].ticks = count;
+        replay->runs[i].inputs = data[pos++];
+        ticks += count;
+    }
+    if (!error && (pos != header.data_size || ticks != header.tick_count)) error = "corrupt run data";
+    free(data);
+    if (error) {
+        fprintf(stderr, "Replay '%s': %s\n", path, error);
+        freeReplay(replay);
+        return 0;
+    }
+
+    replay->track = (TrackType)header.track;
+    memcpy(replay->track_path, header.track_path, REPLAY_TRACK_PATH_LENGTH);
+    replay->track_path[REPLAY_TRACK_PATH_LENGTH - 1] = '\0';
+    memcpy(replay->physics_mode, header.physics_mode, REPLAY_PHYSICS_MODE_LENGTH);
+    replay->physics_mode[REPLAY_PHYSICS_MODE_LENGTH - 1] = '\0';
+    replay->tick_rate = header.tick_rate;
+    unpackReplayCar(&header.initial_car, &replay->initial_car);
+    unpackReplayCar(&header.final_car, &replay->final_car);
+    replay->laps_completed = header.laps_completed;
+    replay->last_lap_ms = header.last_lap_ms;
+    replay->best_lap_ms = header.best_lap_ms;
+    replay->tick_count = header.tick_count;
+    replay->run_count = replay->run_capacity = header.run_count;
+    return 1;
+}
+
+// --- Playback ---
+// Restores the settings a tick was recorded with.
+static void applyReplayFlags(SimTrack* track, unsigned char inputs) {
+    track->query_backend = (inputs & REPLAY_FLAG_GRID_BACKEND) ? TRACK_QUERY_GRID : TRACK_QUERY_ANALYTIC;
+    track->collision_response = (inputs & REPLAY_FLAG_SWEPT_COLLISION) ? TRACK_COLLISION_SWEPT : TRACK_COLLISION_STOP;
+}
+
+int runReplay(const Replay* replay, ReplayResult* result) {
+    memset(result, 0, sizeof(*result));
+    // The other physics mode would not reproduce the race, so don't report it as a mismatch
+    if (strcmp(replay->physics_mode, SIM_PHYSICS_MODE) != 0) {
+        fprintf(stderr, "Replay: recorded with %s physics, this build has %s physics (see SIM_DETERMINISTIC)\n",
+                replay->physics_mode, SIM_PHYSICS_MODE);
+        return 0;
+    }
+    // The file's track if it is already loaded (e.g. by the race that recorded it)
+    const struct TrackData* data = NULL;
+    if (replay->track == TRACK_CUSTOM && !(data = loadCustomTrack(replay->track_path))) return 0;
+
+    // Same step and clock as the game's fixed-step loop (see updateGame)
+    SimContext sim;
+    initSimContext(&sim, replay->track, replay->tick_rate);
+    sim.track.data = data;
+    if (replay->run_count > 0) {
+        applyReplayFlags(&sim.track, replay->runs[0].inputs);
+    }
+    initRace(&sim);
+    setRaceStartCar(&sim, &replay->initial_car);
+
+    for (unsigned int i = 0; i < replay->run_count; ++i) {
+        unsigned char inputs = replay->runs[i].inputs;
+        setCarControlBits(&sim.car, inputs);
+        applyReplayFlags(&sim.track, inputs);
+        for (unsigned int t = 0; t < replay->runs[i].ticks; ++t) {
+            updateRace(&sim);
+        }
+    }
+
+    result->ticks = (unsigned int)sim.ticks;
+    result->laps_completed = sim.laps_completed;
+    result->last_lap_ms = sim.last_lap_time_ms;
+    result->best_lap_ms = sim.best_lap_time_ms;
+    result->matches = memcmp(&sim.car, &replay->final_car, sizeof(Car)) == 0 &&
+                      sim.laps_completed == replay->laps_completed &&
+                      sim.last_lap_time_ms == replay->last_lap_ms && sim.best_lap_time_ms == replay->best_lap_ms;
+    return 1;
+}
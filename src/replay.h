@@ -0,0 +1,75 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "sim.h" // Car, TrackType, SimContext
+
+// --- Input Recording and Replay ---
+// A race is fully determined by its track, physics rate, the car's initial
+// state and the control bits applied on each tick, so recording those is
+// enough to re-run it exactly. The per-tick inputs are stored run-length
+// encoded (a 2-minute session is typically a few hundred runs), together with
+// the final state so a replay can check that it reproduced the race bit for
+// bit. Replays run headlessly as fast as the CPU allows ('headless --replay').
+// The libm and SIM_DETERMINISTIC builds give different bits for the same
+// inputs, so a replay records its build's physics mode and only runs on a
+// build with the same one.
+
+#define REPLAY_FILE_MAGIC 0x50523146u // "F1RP" read as a little-endian uint32
+#define REPLAY_FILE_VERSION 2 // 2: physics mode
+#define REPLAY_TRACK_PATH_LENGTH 256
+#define REPLAY_PHYSICS_MODE_LENGTH 16
+
+// Per-tick input byte: CAR_CONTROL_* bits plus the flags below
+#define REPLAY_FLAG_GRID_BACKEND 0x10 // Track queries used the distance grid on this tick
+#define REPLAY_FLAG_SWEPT_COLLISION 0x20 // Track collisions used the swept response (older replays: stop)
+
+typedef struct {
+    unsigned int ticks;     // Number of consecutive ticks with these inputs
+    unsigned char inputs;   // CAR_CONTROL_* bits | REPLAY_FLAG_*
+} ReplayRun;
+
+typedef struct {
+    // Setup
+    TrackType track;
+    char track_path[REPLAY_TRACK_PATH_LENGTH]; // Track file for TRACK_CUSTOM
+    int tick_rate;          // Physics ticks per second
+    char physics_mode[REPLAY_PHYSICS_MODE_LENGTH]; // SIM_PHYSICS_MODE of the recording build
+    Car initial_car;        // The context's car right after initRace
+
+    // Inputs
+    ReplayRun* runs;
+    unsigned int run_count, run_capacity;
+    unsigned int tick_count;
+    int failed;             // Set if an allocation failed while recording
+
+    // Result of the recorded race, checked by runReplay
+    Car final_car;
+    int laps_completed, last_lap_ms, best_lap_ms;
+} Replay;
+
+typedef struct {
+    unsigned int ticks;
+    int laps_completed, last_lap_ms, best_lap_ms;
+    int matches;            // Final car state and lap results identical to the recording
+} ReplayResult;
+
+// Recording. Call startReplay right after initRace, recordReplayTick before
+// each updateRace, and finishReplay when the race ends.
+void startReplay(Replay* replay, TrackType track, const char* trackPath, int tickRate, const Car* initialCar);
+void recordReplayTick(Replay* replay, unsigned char inputs);
+void truncateReplay(Replay* replay, unsigned int tickCount); // Drops the ticks after the first tickCount (e.g. after a rewind)
+unsigned char getReplayTickInputs(const SimTrack* track, unsigned char controls); // controls plus the flags for the track's settings
+void finishReplay(Replay* replay, const SimContext* sim); // Stores the race's state as the expected result
+void freeReplay(Replay* replay);
+
+int writeReplayFile(const Replay* replay, const char* path); // Returns 1 on success
+int readReplayFile(Replay* replay, const char* path);        // Returns 1 on success (prints the reason on failure)
+
+// Re-runs the race through initRace/updateRace in a context of its own, so it
+// leaves any other race untouched. For TRACK_CUSTOM the track file is shared
+// with any race already on it (see loadCustomTrack), or loaded if there is
+// none. Returns 1 if the replay could be run (prints the reason if not, e.g.
+// a different physics mode).
+int runReplay(const Replay* replay, ReplayResult* result);
+
+#endif // REPLAY_H
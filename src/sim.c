@@ -0,0 +1,289 @@
+#include "sim.h"          // Defines TrackType, Car, SimContext
+#include "track_grid.h"   // Distance grid backend for on-track queries
+#include "track_file.h"   // Custom track files
+#include "track_progress.h" // Progress round the lap for sector timing
+#include "profiler.h"     // Physics and lap detection timers
+#include "platform.h"     // Atomics for the custom track list
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Include BOTH track headers - the code uses constants from one based on the race's track
+#include "track_rect.h"
+#include "track_round.h"
+
+// --- Track Rules ---
+void initSimTrack(SimTrack* track, TrackType type) {
+    track->type = type;
+    track->data = NULL;
+    track->query_backend = TRACK_QUERY_ANALYTIC;       // Analytic track tests unless a caller opts in
+    track->collision_response = TRACK_COLLISION_SWEPT; // Slide along walls
+}
+
+// --- Custom Tracks ---
+// Appended to and never removed, so a slot's track stays valid for good.
+#define CUSTOM_TRACK_PATH_LENGTH 260
+
+static TrackData customTracks[MAX_CUSTOM_TRACKS];
+static char customTrackPaths[MAX_CUSTOM_TRACKS][CUSTOM_TRACK_PATH_LENGTH];
+static int customTrackCount = 0;
+static int customTrackLock = 0; // Held while loading (0 = free)
+
+const TrackData* loadCustomTrack(const char* path) {
+    int expected = 0;
+    while (!platformAtomicCompareExchange(&customTrackLock, &expected, 1)) {
+        expected = 0;
+        sleepPlatformMs(1); // Another thread is loading one (loads are rare)
+    }
+    const TrackData* found = NULL;
+    for (int i = 0; i < customTrackCount && !found; ++i) {
+        if (strcmp(customTrackPaths[i], path) == 0) found = &customTracks[i];
+    }
+    if (!found) {
+        int i = customTrackCount;
+        if (strlen(path) >= CUSTOM_TRACK_PATH_LENGTH) {
+            fprintf(stderr, "Track path too long: %s\n", path);
+        } else if (i == MAX_CUSTOM_TRACKS) {
+            fprintf(stderr, "Cannot load %s: already %d track files loaded\n", path, MAX_CUSTOM_TRACKS);
+        } else if (loadTrackFile(&customTracks[i], path)) {
+            strcpy(customTrackPaths[i], path);
+            customTrackCount = i + 1;
+            found = &customTracks[i];
+        }
+    }
+    platformAtomicStore(&customTrackLock, 0);
+    return found;
+}
+
+int getSimTrackSlot(const SimTrack* track) {
+    if (track->type != TRACK_CUSTOM) return (int)track->type;
+    return track->data ? TRACK_CUSTOM + (int)(track->data - customTracks) : -1;
+}
+
+// --- Finish Line Helper ---
+// Returns the X span of the finish line for the given track type.
+void getFinishLineXSpan(TrackType type, float* xStart, float* xEnd) {
+    if (type == TRACK_RECT) {
+        *xStart = RECT_FINISH_LINE_X_START;
+        *xEnd = RECT_FINISH_LINE_X_END;
+    } else { // TRACK_ROUNDED
+        *xStart = ROUND_FINISH_LINE_X_START;
+        *xEnd = ROUND_FINISH_LINE_X_END;
+    }
+}
+
+float getFinishLineSide(const SimTrack* track, float x, float z, int* withinSpan) {
+    TrackType type = track->type;
+    if (type == TRACK_CUSTOM) {
+        if (!track->data) { if (withinSpan) *withinSpan = 0; return -1.0f; }
+        const TrackFileHeader* h = track->data->header;
+        float dx = x - h->finish_x, dz = z - h->finish_z;
+        float across = dx * -h->finish_dir_z + dz * h->finish_dir_x; // Offset along the line
+        if (withinSpan) *withinSpan = (fabsf(across) <= h->finish_half_width);
+        return dx * h->finish_dir_x + dz * h->finish_dir_z;
+    }
+    // Built-in tracks: the line is at FINISH_LINE_Z, crossed moving +Z.
+    if (withinSpan) {
+        float xStart, xEnd;
+        getFinishLineXSpan(type, &xStart, &xEnd);
+        *withinSpan = (x >= xStart && x <= xEnd);
+    }
+    return z - FINISH_LINE_Z;
+}
+
+
+// --- Context Setup ---
+void initSimContext(SimContext* sim, TrackType track, int tickRate) {
+    memset(sim, 0, sizeof(*sim));
+    initSimTrack(&sim->track, track);
+    sim->tick_rate = (tickRate < 1) ? SIM_DEFAULT_TICK_RATE : tickRate;
+    sim->best_lap_time_ms = INT_MAX;
+    setRaceSectors(sim, DEFAULT_SECTOR_COUNT, NULL);
+    for (int i = 0; i < MAX_SECTORS; ++i) sim->best_sector_times_ms[i] = INT_MAX;
+}
+
+int getRaceTimeMs(const SimContext* sim) {
+    return (int)(sim->ticks * 1000 / sim->tick_rate);
+}
+
+float getRaceTickSeconds(const SimContext* sim) {
+    return (float)(1.0 / sim->tick_rate); // Same expression the game's fixed-step loop has always used
+}
+
+
+// --- Sectors ---
+void setRaceSectors(SimContext* sim, int count, const float* ends) {
+    if (count < 1) count = 1;
+    if (count > MAX_SECTORS) count = MAX_SECTORS;
+    sim->sector_count = count;
+    for (int i = 0; i < count - 1; ++i) {
+        sim->sector_ends[i] = ends ? ends[i] : (float)(i + 1) / (float)count;
+    }
+    sim->sector_ends[count - 1] = 1.0f;
+}
+
+static void startSectorTiming(SimContext* sim, int timeNowMs) {
+    sim->current_sector = 0;
+    sim->sector_start_time_ms = timeNowMs;
+    for (int i = 0; i < MAX_SECTORS; ++i) sim->current_sector_times_ms[i] = 0;
+}
+
+static void completeSector(SimContext* sim, int timeNowMs) {
+    int split = timeNowMs - sim->sector_start_time_ms;
+    sim->current_sector_times_ms[sim->current_sector] = split;
+    if (split > 0 && split < sim->best_sector_times_ms[sim->current_sector]) {
+        sim->best_sector_times_ms[sim->current_sector] = split;
+    }
+    sim->current_sector++;
+    sim->sector_start_time_ms = timeNowMs;
+}
+
+
+// --- Race Initialization ---
+// The lap state that depends on where the car starts.
+static void setStartPositionState(SimContext* sim) {
+    const SimTrack* track = &sim->track;
+    const TrackProgress* progress = getTrackProgress(track);
+    sim->track_progress = progress ? sampleTrackProgress(progress, sim->car.x, sim->car.z) : 0.0f;
+
+    // Determine initial finish line state based on the car's starting position
+    // relative to the finish line of the race's track.
+    int withinFinishLine;
+    float side = getFinishLineSide(track, sim->car.x, sim->car.z, &withinFinishLine);
+    // Set flag to true (1) only if starting exactly on or past the line (unlikely with current setup)
+    sim->crossed_finish_line_forward = (side >= 0.0f && withinFinishLine);
+}
+
+// Sets up the car, clock and timers for the context's track.
+void initRace(SimContext* sim) {
+    const SimTrack* track = &sim->track;
+    // Build the distance grid at track load so the first tick doesn't pay for it.
+    // The swept response uses it for wall normals whichever backend is active.
+    if (sim->track.query_backend == TRACK_QUERY_GRID || sim->track.collision_response == TRACK_COLLISION_SWEPT) {
+        getTrackGrid(track);
+    }
+    getTrackProgress(track); // Likewise for the progress table
+
+    initCar(&sim->car, track); // initCar is defined in car.c
+
+    // Initialize lap timing variables for the start of the race/reset.
+    sim->ticks = 0;
+    int timeNowMs = getRaceTimeMs(sim);
+    sim->lap_start_time_ms = timeNowMs;
+    sim->current_lap_time_ms = 0;
+    sim->last_lap_time_ms = 0;       // No previous lap yet on reset
+    sim->best_lap_time_ms = INT_MAX; // Reset best lap on reset (or load from save later)
+    sim->laps_completed = 0;
+
+    // Sector timing starts with the first lap.
+    startSectorTiming(sim, timeNowMs);
+    for (int i = 0; i < MAX_SECTORS; ++i) {
+        sim->last_sector_times_ms[i] = 0;
+        sim->best_sector_times_ms[i] = INT_MAX;
+    }
+    setStartPositionState(sim);
+}
+
+void setRaceStartCar(SimContext* sim, const Car* car) {
+    sim->car = *car;
+    setStartPositionState(sim);
+}
+
+
+// --- Race Update ---
+// Advances the clock and the car by one physics step and runs lap
+// timing/detection. Returns what happened as RACE_EVENT_* bits.
+int updateRace(SimContext* sim) {
+    int events = 0;
+    Car* car = &sim->car;
+    const SimTrack* track = &sim->track;
+    sim->ticks++;
+    int timeNowMs = getRaceTimeMs(sim);
+
+    // Update car physics, movement, and collision detection/response.
+    // This function (in car.c) tests against the context's track rules.
+    if (sim->profiled) profileBegin(PROFILE_PHYSICS);
+    if (updateCar(car, &sim->track, getRaceTickSeconds(sim))) events |= RACE_EVENT_COLLISION;
+    if (sim->profiled) profileEnd(PROFILE_PHYSICS);
+
+    if (sim->profiled) profileBegin(PROFILE_LAP_DETECTION);
+
+    // Update Lap Timers based on elapsed time.
+    if (timeNowMs >= sim->lap_start_time_ms) {
+        sim->current_lap_time_ms = timeNowMs - sim->lap_start_time_ms;
+    } else {
+        // Handle potential timer wrap-around or reset during gameplay.
+        sim->lap_start_time_ms = timeNowMs;
+        sim->current_lap_time_ms = 0;
+    }
+
+    // --- Lap Completion Logic ---
+    // Check if the car has crossed the finish line in the forward direction.
+    // On the built-in tracks 'side' is just the car's Z relative to FINISH_LINE_Z.
+    int movingForward = (car->speed > 0.1f); // Check speed for direction
+    int withinFinishLine; // The span is checked at the current position only
+    float side = getFinishLineSide(track, car->x, car->z, &withinFinishLine);
+    float prevSide = getFinishLineSide(track, car->prev_x, car->prev_z, NULL);
+
+
+    // --- Detect Crossing Finish Line FORWARD ---
+    // Conditions: crossed the line in the driving direction, moving forward, within its span.
+    if (prevSide < 0.0f && side >= 0.0f && movingForward && withinFinishLine) {
+        // Only count lap completion if the 'crossedForward' flag is already set (meaning
+        // we completed the previous part of the track and are genuinely finishing a lap).
+        if (sim->crossed_finish_line_forward == 1) {
+            // --- LAP COMPLETED ---
+            sim->last_lap_time_ms = sim->current_lap_time_ms; // Record the time
+            sim->laps_completed++;
+            events |= RACE_EVENT_LAP_COMPLETED;
+            // Update best lap if this one was faster (and valid).
+            if (sim->last_lap_time_ms > 0 && sim->last_lap_time_ms < sim->best_lap_time_ms) {
+                sim->best_lap_time_ms = sim->last_lap_time_ms;
+            }
+            // The finish line ends the last sector (if the others were all passed).
+            if (sim->current_sector == sim->sector_count - 1) completeSector(sim, timeNowMs);
+            for (int i = 0; i < MAX_SECTORS; ++i) sim->last_sector_times_ms[i] = sim->current_sector_times_ms[i];
+            startSectorTiming(sim, timeNowMs);
+            // Reset timer for the start of the *new* lap.
+            sim->lap_start_time_ms = timeNowMs;
+            sim->current_lap_time_ms = 0;
+            // The flag remains 1 as we start the next lap from past the line.
+        } else {
+            // This is the *first* time crossing forward (either started before the line
+            // or crossed backward then forward again). Set the flag and start the timer.
+            sim->crossed_finish_line_forward = 1; // Set flag to true
+            events |= RACE_EVENT_LAP_STARTED;
+            sim->lap_start_time_ms = timeNowMs;  // Start timing the first/next lap *now*.
+            sim->current_lap_time_ms = 0;
+            startSectorTiming(sim, timeNowMs);
+        }
+    }
+    // --- Detect Crossing Finish Line BACKWARD ---
+    // Conditions: crossed the line backward, within its span.
+    else if (prevSide >= 0.0f && side < 0.0f && withinFinishLine) {
+        // If the car goes backward over the line, reset the state flag. It will need
+        // to cross forward again to set the flag before completing the *next* lap.
+        sim->crossed_finish_line_forward = 0; // Set flag to false
+        events |= RACE_EVENT_CROSSED_BACK;
+    }
+
+    // --- Sector Splits ---
+    // A sector ends when the car's progress passes its end moving forward. The
+    // half-lap limit rejects the jump from the end of the lap back to 0.
+    const TrackProgress* progress = getTrackProgress(track);
+    if (progress) {
+        float prevProgress = sim->track_progress;
+        sim->track_progress = sampleTrackProgress(progress, car->x, car->z);
+        if (sim->crossed_finish_line_forward && sim->current_sector < sim->sector_count - 1) {
+            float sectorEnd = sim->sector_ends[sim->current_sector] * progress->length;
+            if (prevProgress < sectorEnd && sim->track_progress >= sectorEnd &&
+                sim->track_progress - prevProgress < progress->length * 0.5f) {
+                completeSector(sim, timeNowMs);
+                events |= RACE_EVENT_SECTOR_COMPLETED;
+            }
+        }
+    }
+    if (sim->profiled) profileEnd(PROFILE_LAP_DETECTION);
+    return events;
+}
@@ -0,0 +1,156 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "car.h" // Includes Car struct definition
+
+// --- Track Types ---
+// Enum defining the different available track geometries.
+typedef enum {
+    TRACK_RECT,      // The sharp-cornered rectangle
+    TRACK_ROUNDED,   // The rectangle with rounded corners
+    TRACK_CUSTOM     // Loaded from a track file (see loadCustomTrack)
+    // Add more track types here if needed (remember to update NUM_TRACK_OPTIONS)
+} TrackType;
+
+// --- Custom Tracks ---
+// TRACK_CUSTOM races on a binary track file built by trackgen (see
+// track_file.h). The file is memory-mapped read-only, so every process
+// running the same track shares one copy of its mesh and collision grid.
+// A loaded track stays mapped until the process exits, so races on it (and
+// the caches built from it) never lose it; loading the same path again
+// returns the same track. Safe to call from several threads.
+#define MAX_CUSTOM_TRACKS 8
+struct TrackData;
+const struct TrackData* loadCustomTrack(const char* path); // NULL on failure (prints the reason)
+
+// --- Track Query Backend ---
+// How on-track queries are answered: the analytic per-track tests, or the
+// precomputed distance grid from track_grid.c (same cost for any track shape).
+typedef enum {
+    TRACK_QUERY_ANALYTIC,
+    TRACK_QUERY_GRID
+} TrackQueryBackend;
+
+// --- Track Collision Response ---
+// What a car does when its next position would put a corner off the track:
+// stop dead where it was (the original response, tested at the end position
+// only), or sweep the box along the move and slide along the wall from the
+// point of impact (swept_collision.h).
+typedef enum {
+    TRACK_COLLISION_STOP,
+    TRACK_COLLISION_SWEPT
+} TrackCollisionResponse;
+
+// --- Track Rules ---
+// The track a race runs on and how it is queried and collided with. Every
+// function that tests a position against the track, or looks up something
+// built from it, takes one, so races with different tracks (including
+// different track files) or settings can run side by side.
+typedef struct SimTrack {
+    TrackType type;
+    const struct TrackData* data;                // Track file of a TRACK_CUSTOM track (from loadCustomTrack); NULL otherwise
+    TrackQueryBackend query_backend;             // TRACK_QUERY_ANALYTIC by default
+    TrackCollisionResponse collision_response;   // TRACK_COLLISION_SWEPT by default
+} SimTrack;
+
+void initSimTrack(SimTrack* track, TrackType type); // The default rules for a track (set 'data' for TRACK_CUSTOM)
+
+// Per-track caches (grids, progress tables) are indexed by this: the
+// TrackType for a built-in track, one slot per loaded file for custom ones.
+// Returns -1 for a custom track with no file.
+#define SIM_TRACK_SLOTS (TRACK_CUSTOM + MAX_CUSTOM_TRACKS)
+int getSimTrackSlot(const SimTrack* track);
+
+// --- Physics Rate ---
+// Fixed physics steps per second used by the game and the headless runner
+// unless overridden with --physics-hz. The car is integrated with the step
+// length, so a higher rate only makes the motion and collision checks finer.
+#define SIM_DEFAULT_TICK_RATE 60
+#define SIM_MAX_TICK_RATE 1000
+
+// --- Sectors ---
+// The lap is split into sectors at fractions of its length along the track's
+// progress coordinate (track_progress.h), and each sector is timed as the car
+// passes its end. Sector timing follows the lap timer: it starts when the
+// lap does, and the last sector ends on the finish line.
+#define MAX_SECTORS 8
+#define DEFAULT_SECTOR_COUNT 3
+
+// --- Simulation Context ---
+// One race: the track rules, the player's car, the race clock and the lap and
+// sector timing. This is the GL-free part of the game; the windowed game
+// (game.c), the headless runner, replays and the benchmarks each drive their
+// own context through initRace()/updateRace(). Contexts share nothing but
+// the read-only per-track caches (getTrackGrid, getTrackProgress, built once
+// by whichever initRace gets there first) and the loaded custom track, so
+// separate races can run on separate threads. Only a context with 'profiled'
+// set writes the frame profiler's global timers.
+typedef struct SimContext {
+    SimTrack track;
+    Car car;                          // The player's car
+    int profiled;                     // Time updateRace in the frame profiler (one context at a time; 0 by default)
+
+    // Clock: the race advances in fixed steps of 1 / tick_rate seconds, and
+    // its time in ms is ticks * 1000 / tick_rate.
+    int tick_rate;
+    long long ticks;                  // Ticks run since initRace
+
+    // Lap timing (ms on the race clock)
+    int lap_start_time_ms;            // Time the current lap started
+    int current_lap_time_ms;          // Duration of the current lap
+    int last_lap_time_ms;             // Duration of the last completed lap (0 = none)
+    int best_lap_time_ms;             // Duration of the best completed lap (INT_MAX = none)
+    int crossed_finish_line_forward;  // State flag for lap detection (0=false, 1=true)
+    int laps_completed;               // Laps completed since initRace
+
+    // Sectors
+    int sector_count;                 // Sectors per lap
+    float sector_ends[MAX_SECTORS];   // Fraction of the lap at which each sector ends (the last at 1)
+    int current_sector;               // Sector the car is timing (0 .. sector_count - 1)
+    int sector_start_time_ms;         // Time the current sector started
+    int current_sector_times_ms[MAX_SECTORS]; // Splits of the lap in progress (0 = not reached yet)
+    int last_sector_times_ms[MAX_SECTORS];    // Splits of the last completed lap (0 = missed)
+    int best_sector_times_ms[MAX_SECTORS];    // Best split of each sector (INT_MAX = none yet)
+    float track_progress;             // Car's distance round the lap from the finish line
+} SimContext;
+
+// Sets up a context for a track with the default rules and DEFAULT_SECTOR_COUNT
+// equal sectors (for TRACK_CUSTOM, set track.data too). Call initRace before
+// the first updateRace.
+void initSimContext(SimContext* sim, TrackType track, int tickRate);
+
+// Sets the sectors from the fractions of the lap at which each but the last
+// ends (count - 1 ascending values in (0, 1)); NULL gives equal sectors.
+// Takes effect at the next initRace.
+void setRaceSectors(SimContext* sim, int count, const float* ends);
+
+// --- Race Events ---
+// What happened during an updateRace tick (for telemetry and logging)
+#define RACE_EVENT_COLLISION      0x01 // The car hit the track edge (and was stopped or slid along it)
+#define RACE_EVENT_LAP_STARTED    0x02 // Crossed the line forward and started timing (first crossing)
+#define RACE_EVENT_LAP_COMPLETED  0x04 // Crossed the line forward and finished a lap (last_lap_time_ms is set)
+#define RACE_EVENT_CROSSED_BACK   0x08 // Crossed the line backward (the lap is void)
+#define RACE_EVENT_SECTOR_COMPLETED 0x10 // Passed the end of a sector before the finish line
+
+// --- Function Declarations ---
+void initRace(SimContext* sim);       // Resets the car, clock and lap state for sim->track
+void setRaceStartCar(SimContext* sim, const Car* car); // After initRace: starts from 'car' instead (e.g. a grid slot)
+int updateRace(SimContext* sim);      // One physics tick plus lap timing/detection; returns RACE_EVENT_* bits
+int getRaceTimeMs(const SimContext* sim);        // Race clock after the last tick
+float getRaceTickSeconds(const SimContext* sim); // Length of a tick (the step the car is integrated with)
+
+// The car on its own, for callers that run many cars without lap timing
+// (e.g. the sweep runner's worker threads)
+void initCar(Car* car, const SimTrack* track);  // Default tuning, on the track's starting grid
+int updateCar(Car* car, const SimTrack* track, float deltaTime); // Returns 1 if the car hit the track edge this tick
+
+// Whether (x, z) is on the track, by the track's query backend
+int isPositionOnTrack(const SimTrack* track, float x, float z);
+
+// Finish line X span for the built-in tracks (the line itself sits at FINISH_LINE_Z)
+void getFinishLineXSpan(TrackType type, float* xStart, float* xEnd);
+// Signed distance of (x, z) past the finish line in the driving direction;
+// *withinSpan (may be NULL) is set if the point is level with the line (between its ends).
+float getFinishLineSide(const SimTrack* track, float x, float z, int* withinSpan);
+
+#endif // SIM_H
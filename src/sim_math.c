@@ -0,0 +1,191 @@
+#include "sim_math.h"
+#include <math.h>
+
+#ifdef SIM_DETERMINISTIC
+// sin(k * 90 / SIM_TRIG_STEPS degrees) rounded to float, for k = 0..SIM_TRIG_STEPS.
+// Stored rather than computed at startup so no libm call is involved.
+static const float quarterSine[SIM_TRIG_STEPS + 1] = {
+    0.0f, 0.00153398013f, 0.00306795677f, 0.00460192608f, 0.00613588467f, 0.00766982883f, 0.00920375437f, 0.0107376594f,
+    0.0122715384f, 0.0138053885f, 0.015339206f, 0.0168729872f, 0.0184067301f, 0.0199404284f, 0.0214740802f, 0.0230076816f,
+    0.024541229f, 0.0260747187f, 0.027608145f, 0.029141508f, 0.030674804f, 0.0322080255f, 0.0337411724f, 0.0352742374f,
+    0.0368072242f, 0.0383401215f, 0.0398729257f, 0.0414056405f, 0.0429382585f, 0.0444707721f, 0.0460031815f, 0.0475354828f,
+    0.0490676761f, 0.0505997501f, 0.052131705f, 0.0536635369f, 0.0551952459f, 0.0567268208f, 0.0582582653f, 0.0597895719f,
+    0.061320737f, 0.0628517568f, 0.0643826276f, 0.0659133494f, 0.0674439222f, 0.068974331f, 0.070504576f, 0.0720346496f,
+    0.0735645667f, 0.0750942975f, 0.0766238645f, 0.0781532452f, 0.0796824396f, 0.0812114477f, 0.0827402622f, 0.0842688903f,
+    0.0857973099f, 0.0873255357f, 0.0888535529f, 0.0903813615f, 0.0919089541f, 0.093436338f, 0.0949634984f, 0.0964904279f,
+    0.0980171412f, 0.0995436162f, 0.10106986f, 0.102595866f, 0.104121633f, 0.105647154f, 0.107172422f, 0.108697444f,
+    0.110222206f, 0.111746714f, 0.113270953f, 0.114794925f, 0.116318628f, 0.117842063f, 0.119365215f, 0.120888084f,
+    0.122410677f, 0.123932973f, 0.125454977f, 0.126976699f, 0.128498107f, 0.130019218f, 0.13154003f, 0.13306053f,
+    0.134580702f, 0.136100575f, 0.137620121f, 0.139139339f, 0.140658244f, 0.142176807f, 0.143695027f, 0.145212919f,
+    0.146730468f, 0.148247674f, 0.149764538f, 0.151281044f, 0.152797192f, 0.154312968f, 0.155828401f, 0.157343462f,
+    0.15885815f, 0.160372451f, 0.161886394f, 0.16339995f, 0.164913118f, 0.166425899f, 0.167938292f, 0.169450298f,
+    0.170961887f, 0.172473088f, 0.173983872f, 0.175494254f, 0.177004218f, 0.178513765f, 0.180022895f, 0.181531608f,
+    0.183039889f, 0.184547737f, 0.186055154f, 0.187562123f, 0.18906866f, 0.19057475f, 0.192080393f, 0.19358559f,
+    0.195090324f, 0.196594596f, 0.198098406f, 0.199601755f, 0.201104641f, 0.202607036f, 0.204108968f, 0.205610409f,
+    0.207111374f, 0.208611846f, 0.210111842f, 0.211611331f, 0.213110313f, 0.214608818f, 0.216106802f, 0.21760428f,
+    0.219101235f, 0.220597684f, 0.222093627f, 0.223589033f, 0.225083917f, 0.226578265f, 0.228072077f, 0.229565367f,
+    0.231058106f, 0.232550308f, 0.234041959f, 0.235533059f, 0.237023607f, 0.238513589f, 0.24000302f, 0.241491884f,
+    0.242980182f, 0.244467899f, 0.24595505f, 0.24744162f, 0.248927608f, 0.250413001f, 0.251897812f, 0.253382027f,
+    0.254865646f, 0.25634867f, 0.257831097f, 0.259312928f, 0.260794103f, 0.262274712f, 0.263754666f, 0.265234023f,
+    0.266712755f, 0.268190861f, 0.269668311f, 0.271145165f, 0.272621363f, 0.274096906f, 0.275571823f, 0.277046084f,
+    0.27851969f, 0.27999264f, 0.281464934f, 0.282936573f, 0.284407526f, 0.285877824f, 0.287347466f, 0.288816422f,
+    0.290284663f, 0.291752249f, 0.293219149f, 0.294685364f, 0.296150893f, 0.297615707f, 0.299079835f, 0.300543249f,
+    0.302005947f, 0.303467959f, 0.304929227f, 0.306389809f, 0.307849646f, 0.309308767f, 0.310767144f, 0.312224805f,
+    0.313681751f, 0.315137923f, 0.316593379f, 0.31804809f, 0.319502026f, 0.320955247f, 0.322407693f, 0.323859364f,
+    0.32531029f, 0.326760441f, 0.328209847f, 0.329658449f, 0.331106305f, 0.332553357f, 0.333999664f, 0.335445136f,
+    0.336889863f, 0.338333756f, 0.339776874f, 0.341219217f, 0.342660725f, 0.344101429f, 0.345541328f, 0.346980423f,
+    0.348418683f, 0.349856138f, 0.351292759f, 0.352728546f, 0.354163527f, 0.355597675f, 0.357030958f, 0.358463407f,
+    0.359895051f, 0.3613258f, 0.362755716f, 0.364184797f, 0.365612984f, 0.367040336f, 0.368466824f, 0.369892448f,
+    0.371317208f, 0.372741073f, 0.374164075f, 0.375586182f, 0.377007425f, 0.378427744f, 0.379847199f, 0.381265759f,
+    0.382683426f, 0.384100199f, 0.385516047f, 0.386931002f, 0.388345033f, 0.38975817f, 0.391170382f, 0.392581671f,
+    0.393992037f, 0.395401478f, 0.396809995f, 0.398217559f, 0.399624199f, 0.401029885f, 0.402434647f, 0.403838456f,
+    0.405241311f, 0.406643212f, 0.408044159f, 0.409444153f, 0.410843164f, 0.41224122f, 0.413638324f, 0.415034413f,
+    0.416429549f, 0.417823702f, 0.419216901f, 0.420609087f, 0.422000259f, 0.423390478f, 0.424779683f, 0.426167876f,
+    0.427555084f, 0.42894128f, 0.430326492f, 0.43171066f, 0.433093816f, 0.434475958f, 0.435857087f, 0.437237173f,
+    0.438616246f, 0.439994276f, 0.441371262f, 0.442747235f, 0.444122136f, 0.445496023f, 0.446868837f, 0.448240608f,
+    0.449611336f, 0.450980991f, 0.452349573f, 0.453717113f, 0.455083579f, 0.456448972f, 0.457813293f, 0.45917654f,
+    0.460538715f, 0.461899787f, 0.463259786f, 0.464618683f, 0.465976506f, 0.467333198f, 0.468688816f, 0.470043331f,
+    0.471396744f, 0.472749025f, 0.474100202f, 0.475450277f, 0.47679922f, 0.47814706f, 0.479493767f, 0.480839342f,
+    0.482183784f, 0.483527064f, 0.484869242f, 0.486210287f, 0.487550169f, 0.48888889f, 0.490226477f, 0.491562903f,
+    0.492898196f, 0.494232297f, 0.495565265f, 0.496897042f, 0.498227656f, 0.499557108f, 0.500885367f, 0.502212465f,
+    0.50353837f, 0.504863083f, 0.506186664f, 0.507508993f, 0.50883013f, 0.510150075f, 0.511468828f, 0.512786388f,
+    0.514102757f, 0.515417874f, 0.516731799f, 0.518044531f, 0.519356012f, 0.520666242f, 0.521975279f, 0.523283124f,
+    0.524589658f, 0.525895f, 0.527199149f, 0.528501987f, 0.529803634f, 0.531104028f, 0.532403111f, 0.533701003f,
+    0.534997642f, 0.53629297f, 0.537587047f, 0.538879931f, 0.540171444f, 0.541461766f, 0.542750776f, 0.544038534f,
+    0.545324981f, 0.546610177f, 0.547894061f, 0.549176633f, 0.550457954f, 0.551737964f, 0.553016722f, 0.554294109f,
+    0.555570245f, 0.556845009f, 0.558118522f, 0.559390724f, 0.560661554f, 0.561931133f, 0.563199341f, 0.564466238f,
+    0.565731823f, 0.566996038f, 0.568258941f, 0.569520533f, 0.570780754f, 0.572039604f, 0.573297143f, 0.57455337f,
+    0.575808167f, 0.577061653f, 0.578313768f, 0.579564571f, 0.580813944f, 0.582062006f, 0.583308637f, 0.584553957f,
+    0.585797846f, 0.587040365f, 0.588281572f, 0.589521289f, 0.590759695f, 0.59199667f, 0.593232274f, 0.594466507f,
+    0.59569931f, 0.596930683f, 0.598160684f, 0.599389315f, 0.600616455f, 0.601842225f, 0.603066623f, 0.604289532f,
+    0.605511069f, 0.606731117f, 0.607949793f, 0.609167039f, 0.610382795f, 0.61159718f, 0.612810075f, 0.61402154f,
+    0.615231574f, 0.616440177f, 0.61764729f, 0.618852973f, 0.620057225f, 0.621259987f, 0.622461259f, 0.623661101f,
+    0.624859512f, 0.626056373f, 0.627251804f, 0.628445745f, 0.629638255f, 0.630829215f, 0.632018745f, 0.633206785f,
+    0.634393275f, 0.635578334f, 0.636761844f, 0.637943923f, 0.639124453f, 0.640303493f, 0.641481042f, 0.642657042f,
+    0.643831551f, 0.645004511f, 0.64617604f, 0.64734596f, 0.64851439f, 0.64968133f, 0.65084666f, 0.65201056f,
+    0.653172851f, 0.654333591f, 0.655492842f, 0.656650543f, 0.657806695f, 0.658961296f, 0.660114348f, 0.66126585f,
+    0.662415802f, 0.663564146f, 0.664710999f, 0.665856242f, 0.666999936f, 0.668142021f, 0.669282615f, 0.670421541f,
+    0.671558976f, 0.672694743f, 0.673829019f, 0.674961627f, 0.676092684f, 0.677222192f, 0.678350031f, 0.679476321f,
+    0.680601001f, 0.681724072f, 0.682845533f, 0.683965385f, 0.685083687f, 0.686200321f, 0.687315345f, 0.68842876f,
+    0.689540565f, 0.690650702f, 0.691759229f, 0.692866147f, 0.693971455f, 0.695075095f, 0.696177125f, 0.697277486f,
+    0.698376238f, 0.699473321f, 0.700568795f, 0.7016626f, 0.702754736f, 0.703845263f, 0.704934061f, 0.706021249f,
+    0.707106769f, 0.70819062f, 0.709272802f, 0.710353374f, 0.711432219f, 0.712509394f, 0.71358484f, 0.714658678f,
+    0.715730846f, 0.716801286f, 0.717870057f, 0.718937099f, 0.720002532f, 0.721066177f, 0.722128212f, 0.72318846f,
+    0.724247098f, 0.725303948f, 0.726359129f, 0.727412641f, 0.728464365f, 0.72951442f, 0.730562747f, 0.731609404f,
+    0.732654274f, 0.733697414f, 0.734738886f, 0.73577857f, 0.736816585f, 0.737852812f, 0.73888731f, 0.73992008f,
+    0.740951121f, 0.741980433f, 0.743007958f, 0.744033754f, 0.745057762f, 0.746080101f, 0.747100592f, 0.748119354f,
+    0.749136388f, 0.750151634f, 0.751165152f, 0.752176821f, 0.753186822f, 0.754194975f, 0.755201399f, 0.756205976f,
+    0.757208824f, 0.758209884f, 0.759209216f, 0.760206699f, 0.761202395f, 0.762196302f, 0.763188422f, 0.764178753f,
+    0.765167236f, 0.766153991f, 0.767138898f, 0.768122017f, 0.769103348f, 0.770082831f, 0.771060526f, 0.772036374f,
+    0.773010433f, 0.773982704f, 0.774953127f, 0.775921702f, 0.77688849f, 0.777853429f, 0.778816521f, 0.779777765f,
+    0.780737221f, 0.781694829f, 0.78265059f, 0.783604503f, 0.784556568f, 0.785506845f, 0.786455214f, 0.787401736f,
+    0.78834641f, 0.789289236f, 0.790230215f, 0.791169345f, 0.792106569f, 0.793041945f, 0.793975472f, 0.794907153f,
+    0.795836926f, 0.796764791f, 0.797690868f, 0.798614979f, 0.799537241f, 0.800457656f, 0.801376164f, 0.802292824f,
+    0.803207517f, 0.804120362f, 0.805031359f, 0.80594039f, 0.806847572f, 0.807752848f, 0.808656156f, 0.809557617f,
+    0.81045717f, 0.811354876f, 0.812250614f, 0.813144386f, 0.81403631f, 0.814926326f, 0.815814435f, 0.816700578f,
+    0.817584813f, 0.81846714f, 0.819347501f, 0.820225954f, 0.8211025f, 0.821977139f, 0.82284981f, 0.823720515f,
+    0.824589312f, 0.825456142f, 0.826321065f, 0.827184021f, 0.82804507f, 0.828904092f, 0.829761207f, 0.830616415f,
+    0.831469595f, 0.832320869f, 0.833170176f, 0.834017515f, 0.834862888f, 0.835706294f, 0.836547732f, 0.837387204f,
+    0.838224709f, 0.839060247f, 0.839893818f, 0.840725362f, 0.841554999f, 0.84238261f, 0.843208253f, 0.84403187f,
+    0.84485358f, 0.845673263f, 0.84649092f, 0.847306609f, 0.848120332f, 0.848932028f, 0.849741757f, 0.850549459f,
+    0.851355195f, 0.852158904f, 0.852960587f, 0.853760302f, 0.854557991f, 0.855353653f, 0.856147349f, 0.856938958f,
+    0.857728601f, 0.858516216f, 0.859301805f, 0.860085368f, 0.860866964f, 0.861646473f, 0.862423956f, 0.863199413f,
+    0.863972843f, 0.864744246f, 0.865513623f, 0.866280973f, 0.867046237f, 0.867809474f, 0.868570685f, 0.86932987f,
+    0.870086968f, 0.87084204f, 0.871595085f, 0.872346044f, 0.873094976f, 0.873841822f, 0.874586642f, 0.875329375f,
+    0.876070082f, 0.876808703f, 0.877545297f, 0.878279805f, 0.879012227f, 0.879742622f, 0.880470872f, 0.881197095f,
+    0.881921291f, 0.882643342f, 0.883363366f, 0.884081244f, 0.884797096f, 0.885510862f, 0.886222541f, 0.886932135f,
+    0.887639642f, 0.888345063f, 0.889048338f, 0.889749587f, 0.890448749f, 0.891145766f, 0.891840696f, 0.892533541f,
+    0.893224299f, 0.893912971f, 0.894599497f, 0.895283937f, 0.895966232f, 0.8966465f, 0.897324562f, 0.898000598f,
+    0.898674488f, 0.899346232f, 0.900015891f, 0.900683403f, 0.901348829f, 0.902012169f, 0.902673304f, 0.903332353f,
+    0.903989315f, 0.904644072f, 0.905296743f, 0.905947268f, 0.906595707f, 0.907242f, 0.907886088f, 0.90852809f,
+    0.909168005f, 0.909805715f, 0.910441279f, 0.911074758f, 0.91170603f, 0.912335157f, 0.912962198f, 0.913587034f,
+    0.914209783f, 0.914830327f, 0.915448725f, 0.916064978f, 0.916679084f, 0.917290986f, 0.917900801f, 0.91850841f,
+    0.919113874f, 0.919717133f, 0.920318305f, 0.920917213f, 0.921514034f, 0.92210865f, 0.92270112f, 0.923291445f,
+    0.923879504f, 0.924465477f, 0.925049245f, 0.925630808f, 0.926210225f, 0.926787496f, 0.927362502f, 0.927935421f,
+    0.928506076f, 0.929074585f, 0.929640889f, 0.930205047f, 0.93076694f, 0.931326687f, 0.931884289f, 0.932439625f,
+    0.932992816f, 0.933543801f, 0.934092522f, 0.934639156f, 0.935183525f, 0.935725689f, 0.936265647f, 0.93680346f,
+    0.937339008f, 0.93787235f, 0.938403547f, 0.938932478f, 0.939459205f, 0.939983726f, 0.940506041f, 0.941026151f,
+    0.941544056f, 0.942059755f, 0.94257319f, 0.943084419f, 0.943593442f, 0.944100261f, 0.944604814f, 0.945107222f,
+    0.945607305f, 0.946105242f, 0.946600914f, 0.947094381f, 0.947585583f, 0.948074579f, 0.94856137f, 0.949045897f,
+    0.949528158f, 0.950008273f, 0.950486064f, 0.950961649f, 0.95143503f, 0.951906145f, 0.952374995f, 0.95284164f,
+    0.953306019f, 0.953768194f, 0.954228103f, 0.954685748f, 0.955141187f, 0.955594361f, 0.95604527f, 0.956493914f,
+    0.956940353f, 0.957384527f, 0.957826436f, 0.958266079f, 0.958703458f, 0.959138632f, 0.95957154f, 0.960002124f,
+    0.960430503f, 0.960856616f, 0.961280465f, 0.961702049f, 0.962121427f, 0.962538481f, 0.962953269f, 0.963365793f,
+    0.963776052f, 0.964184046f, 0.964589775f, 0.964993238f, 0.965394437f, 0.965793371f, 0.966189981f, 0.966584384f,
+    0.966976464f, 0.967366278f, 0.967753828f, 0.968139112f, 0.968522072f, 0.968902826f, 0.969281256f, 0.969657362f,
+    0.970031261f, 0.970402837f, 0.970772147f, 0.971139133f, 0.971503913f, 0.97186631f, 0.972226501f, 0.972584367f,
+    0.972939968f, 0.973293245f, 0.973644257f, 0.973992944f, 0.974339366f, 0.974683523f, 0.975025356f, 0.975364864f,
+    0.975702107f, 0.976037085f, 0.976369739f, 0.976700068f, 0.977028131f, 0.977353871f, 0.977677345f, 0.977998495f,
+    0.97831738f, 0.97863394f, 0.978948176f, 0.979260147f, 0.979569793f, 0.979877114f, 0.980182111f, 0.980484843f,
+    0.980785251f, 0.981083393f, 0.981379211f, 0.981672704f, 0.981963873f, 0.982252717f, 0.982539296f, 0.982823551f,
+    0.983105481f, 0.983385086f, 0.983662426f, 0.983937442f, 0.984210074f, 0.984480441f, 0.984748483f, 0.98501426f,
+    0.985277653f, 0.985538721f, 0.985797524f, 0.986053944f, 0.986308098f, 0.986559927f, 0.986809373f, 0.987056553f,
+    0.987301409f, 0.987543941f, 0.987784147f, 0.988022029f, 0.988257587f, 0.98849082f, 0.988721669f, 0.988950253f,
+    0.989176512f, 0.989400446f, 0.989621997f, 0.989841282f, 0.990058184f, 0.99027282f, 0.990485072f, 0.990695f,
+    0.990902662f, 0.991107941f, 0.991310835f, 0.991511464f, 0.991709769f, 0.991905689f, 0.992099285f, 0.992290616f,
+    0.992479563f, 0.992666125f, 0.992850423f, 0.993032336f, 0.993211925f, 0.993389189f, 0.993564129f, 0.993736744f,
+    0.993906975f, 0.994074881f, 0.994240463f, 0.99440366f, 0.994564593f, 0.994723141f, 0.994879305f, 0.995033205f,
+    0.99518472f, 0.99533391f, 0.995480776f, 0.995625257f, 0.995767415f, 0.995907247f, 0.996044695f, 0.996179819f,
+    0.996312618f, 0.996443033f, 0.996571124f, 0.996696889f, 0.996820271f, 0.996941328f, 0.997060061f, 0.997176409f,
+    0.997290432f, 0.997402132f, 0.997511446f, 0.997618437f, 0.997723043f, 0.997825325f, 0.997925282f, 0.998022854f,
+    0.998118103f, 0.998211026f, 0.998301566f, 0.998389721f, 0.998475552f, 0.998559058f, 0.998640239f, 0.998719037f,
+    0.99879545f, 0.998869538f, 0.998941302f, 0.999010682f, 0.999077737f, 0.999142408f, 0.999204755f, 0.999264777f,
+    0.999322355f, 0.999377668f, 0.999430597f, 0.999481201f, 0.999529421f, 0.999575317f, 0.999618828f, 0.999660015f,
+    0.999698818f, 0.999735296f, 0.99976939f, 0.999801159f, 0.999830604f, 0.999857664f, 0.99988234f, 0.999904692f,
+    0.999924719f, 0.999942362f, 0.999957621f, 0.999970615f, 0.999981165f, 0.99998939f, 0.999995291f, 0.999998808f,
+    1.0f,
+};
+
+void getHeadingSinCos(float angleDeg, float* sinOut, float* cosOut) {
+    const float fullTurn = 4.0f * SIM_TRIG_STEPS;
+    float steps = angleDeg * ((float)SIM_TRIG_STEPS / 90.0f);
+    if (!(steps >= 0.0f && steps < fullTurn)) {
+        steps = fmodf(steps, fullTurn); // Exact
+        if (steps < 0.0f) steps += fullTurn;
+        if (!(steps >= 0.0f && steps < fullTurn)) steps = 0.0f; // NaN, or -tiny rounded up to a full turn
+    }
+    int step = (int)steps;
+    float frac = steps - (float)step;
+    int i = step % SIM_TRIG_STEPS;
+    // Sine and cosine within the quadrant, then rotated into place
+    float s = quarterSine[i] + (quarterSine[i + 1] - quarterSine[i]) * frac;
+    float c = quarterSine[SIM_TRIG_STEPS - i] + (quarterSine[SIM_TRIG_STEPS - i - 1] - quarterSine[SIM_TRIG_STEPS - i]) * frac;
+    switch (step / SIM_TRIG_STEPS) {
+        case 0:  *sinOut = s;  *cosOut = c;  break;
+        case 1:  *sinOut = c;  *cosOut = -s; break;
+        case 2:  *sinOut = -s; *cosOut = -c; break;
+        default: *sinOut = -c; *cosOut = s;  break;
+    }
+}
+
+float getHeadingAngle(float sinA, float cosA) {
+    float ax = fabsf(sinA), az = fabsf(cosA);
+    float big = fmaxf(ax, az);
+    if (!(big > 0.0f)) return 0.0f;
+    // atan of t in [0, 1] in degrees (odd minimax polynomial), then unfolded by octant
+    float t = fminf(ax, az) / big;
+    float t2 = t * t;
+    float a = t * (57.2944f + t2 * (-19.0579f + t2 * (11.0893f + t2 * (-6.67110f + t2 * (3.01681f + t2 * -0.671575f)))));
+    if (ax > az) a = 90.0f - a;
+    if (cosA < 0.0f) a = 180.0f - a;
+    return (sinA < 0.0f) ? -a : a;
+}
+#else
+void getHeadingSinCos(float angleDeg, float* sinOut, float* cosOut) {
+    float angleRad = angleDeg * M_PI / 180.0f; // Same conversion the physics always used
+    *sinOut = sinf(angleRad);
+    *cosOut = cosf(angleRad);
+}
+
+float getHeadingAngle(float sinA, float cosA) {
+    return atan2f(sinA, cosA) * (float)(180.0 / M_PI);
+}
+#endif
+
+
+// --- State Checksums ---
+unsigned int hashSimBytes(unsigned int hash, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
@@ -0,0 +1,53 @@
+#ifndef SIM_MATH_H
+#define SIM_MATH_H
+
+#include <stddef.h>
+
+// --- Simulation Math ---
+// The heading trigonometry of the car physics and collision code, in one
+// place so it can be swapped for a reproducible version.
+//
+// By default it is sinf/cosf of the heading in radians, whose last bits
+// depend on the C library (and can change with its version). Built with
+// SIM_DETERMINISTIC ('make SIM_DETERMINISTIC=1') it instead interpolates a
+// quarter-wave sine table compiled into the library, using only +, -, * and
+// conversions. Those are correctly rounded under IEEE 754, as are the sqrtf,
+// fmodf and fabsf/fminf/fmaxf the rest of the physics uses, so with
+// contraction into FMAs turned off and every float rounded to 32 bits (the
+// Makefile passes -ffp-contract=off and SSE2 math, since x87 code on 32-bit
+// x86 keeps wider intermediates) a race gives the same bits whatever the
+// compiler, optimization level or C library. Replays and
+// netplay then only need the inputs. The two modes steer slightly
+// differently, so a replay recorded in one does not match in the other.
+// 'make detcheck' records a race in a -O0 build and replays it in an -O3 one.
+
+// --- Angle Units ---
+// math.h only defines M_PI outside strict C99, so it is defined here for
+// every file that converts between degrees and radians.
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#define DEG_TO_RAD(angle) ((angle) * M_PI / 180.0f)
+#define RAD_TO_DEG(angle) ((angle) * 180.0f / M_PI)
+
+#define SIM_TRIG_STEPS 1024 // Table steps per quarter turn (deterministic mode)
+#ifdef SIM_DETERMINISTIC
+#define SIM_PHYSICS_MODE "deterministic"
+#else
+#define SIM_PHYSICS_MODE "libm"
+#endif
+
+// Sine and cosine of a heading in degrees (any value; Car.angle convention).
+void getHeadingSinCos(float angleDeg, float* sinOut, float* cosOut);
+// Heading in degrees, [-180, 180], of the direction (sinA, cosA) (X and Z
+// parts, any length): the inverse of getHeadingSinCos. In deterministic mode
+// a polynomial good to about 0.001 degrees.
+float getHeadingAngle(float sinA, float cosA);
+
+// --- State Checksums ---
+// FNV-1a, for checking that two runs ended in the same state. Start from
+// SIM_HASH_SEED and feed each part in turn.
+#define SIM_HASH_SEED 2166136261u
+unsigned int hashSimBytes(unsigned int hash, const void* data, size_t size);
+
+#endif // SIM_MATH_H
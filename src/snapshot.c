@@ -0,0 +1,174 @@
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Fixed-size start of every snapshot. The parts follow in this order:
+// SimContext, batch cars, drivers, standings.
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int size;        // Whole snapshot in bytes
+    int car_count;            // Batch cars saved (-1 = no batch)
+    int driver_count;         // AI drivers saved (-1 = none)
+    int standings_count;      // Standings entries saved (-1 = no standings)
+    int checkpoint_count;     // Standings checkpoints saved
+    long long ticks;          // sim->ticks when saved
+} SimSnapshotHeader;
+
+// Per-car batch arrays saved (x, z, prev_x, prev_z, angle, sin_a, cos_a, speed), plus the control bytes
+#define SNAPSHOT_BATCH_FLOATS 8
+
+// Describes the layout 'state' would be saved with.
+static void makeHeader(const SimState* state, SimSnapshotHeader* header) {
+    memset(header, 0, sizeof(*header));
+    header->magic = SIM_SNAPSHOT_MAGIC;
+    header->version = SIM_SNAPSHOT_VERSION;
+    header->car_count = state->cars ? state->cars->count : -1;
+    header->driver_count = (state->cars && state->drivers) ? state->cars->count : -1;
+    header->standings_count = state->standings ? state->standings->count : -1;
+    header->checkpoint_count = state->standings ? state->standings->checkpoint_count : 0;
+    header->ticks = state->sim->ticks;
+
+    size_t size = sizeof(SimSnapshotHeader) + sizeof(SimContext);
+    if (header->car_count > 0) {
+        size_t n = (size_t)header->car_count;
+        size += n * SNAPSHOT_BATCH_FLOATS * sizeof(float) + n;
+    }
+    if (header->driver_count > 0) size += (size_t)header->driver_count * sizeof(AIDriver);
+    if (header->standings_count >= 0) {
+        size_t n = (size_t)header->standings_count;
+        size += n * (4 * sizeof(int) + 2 * sizeof(float));            // Per-entry arrays
+        size += (size_t)header->checkpoint_count * 2 * sizeof(int);   // Leader's checkpoint passes
+        size += sizeof(int);                                          // swaps
+    }
+    header->size = (unsigned int)size;
+}
+
+size_t getSimSnapshotSize(const SimState* state) {
+    SimSnapshotHeader header;
+    makeHeader(state, &header);
+    return header.size;
+}
+
+// --- Copying ---
+// Both directions walk the same layout; 'save' picks which way each part goes.
+static unsigned char* copyPart(unsigned char* p, void* live, size_t bytes, int save) {
+    if (bytes == 0) return p;
+    if (save) memcpy(p, live, bytes);
+    else memcpy(live, p, bytes);
+    return p + bytes;
+}
+
+static void copyState(const SimState* state, const SimSnapshotHeader* header, unsigned char* p, int save) {
+    p = copyPart(p, state->sim, sizeof(SimContext), save);
+    if (header->car_count > 0) {
+        CarBatch* b = state->cars;
+        size_t bytes = (size_t)header->car_count * sizeof(float);
+        p = copyPart(p, b->x, bytes, save);
+        p = copyPart(p, b->z, bytes, save);
+        p = copyPart(p, b->prev_x, bytes, save);
+        p = copyPart(p, b->prev_z, bytes, save);
+        p = copyPart(p, b->angle, bytes, save);
+        p = copyPart(p, b->sin_a, bytes, save);
+        p = copyPart(p, b->cos_a, bytes, save);
+        p = copyPart(p, b->speed, bytes, save);
+        p = copyPart(p, b->controls, (size_t)header->car_count, save);
+    }
+    if (header->driver_count > 0) {
+        p = copyPart(p, state->drivers, (size_t)header->driver_count * sizeof(AIDriver), save);
+    }
+    if (header->standings_count >= 0) {
+        Standings* s = state->standings;
+        size_t ints = (size_t)header->standings_count * sizeof(int);
+        size_t floats = (size_t)header->standings_count * sizeof(float);
+        size_t checkpoints = (size_t)header->checkpoint_count * sizeof(int);
+        p = copyPart(p, s->laps, ints, save);
+        p = copyPart(p, s->checkpoint, ints, save);
+        p = copyPart(p, s->order, ints, save);
+        p = copyPart(p, s->position, ints, save);
+        p = copyPart(p, s->lap_progress, floats, save);
+        p = copyPart(p, s->distance, floats, save);
+        p = copyPart(p, s->checkpoint_lap, checkpoints, save);
+        p = copyPart(p, s->checkpoint_time_ms, checkpoints, save);
+        copyPart(p, &s->swaps, sizeof(int), save);
+    }
+}
+
+void saveSimSnapshot(const SimState* state, void* buffer) {
+    SimSnapshotHeader header;
+    makeHeader(state, &header);
+    memcpy(buffer, &header, sizeof(header));
+    copyState(state, &header, (unsigned char*)buffer + sizeof(header), 1);
+}
+
+int restoreSimSnapshot(const SimState* state, const void* buffer) {
+    SimSnapshotHeader saved, expected;
+    memcpy(&saved, buffer, sizeof(saved));
+    makeHeader(state, &expected);
+    if (saved.magic != SIM_SNAPSHOT_MAGIC || saved.version != SIM_SNAPSHOT_VERSION ||
+        saved.size != expected.size || saved.car_count != expected.car_count ||
+        saved.driver_count != expected.driver_count || saved.standings_count != expected.standings_count ||
+        saved.checkpoint_count != expected.checkpoint_count) {
+        return 0;
+    }
+    copyState(state, &saved, (unsigned char*)buffer + sizeof(saved), 0);
+    return 1;
+}
+
+long long getSimSnapshotTicks(const void* buffer) {
+    SimSnapshotHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    return header.ticks;
+}
+
+
+// --- Keyframe Ring ---
+int initSnapshotRing(SnapshotRing* ring, const SimState* state, int capacity, int interval) {
+    memset(ring, 0, sizeof(*ring));
+    if (capacity < 1) capacity = 1;
+    if (interval < 1) interval = 1;
+    ring->frame_size = getSimSnapshotSize(state);
+    ring->storage = (unsigned char*)malloc(ring->frame_size * (size_t)capacity);
+    if (!ring->storage) return 0;
+    ring->capacity = capacity;
+    ring->interval = interval;
+    return 1;
+}
+
+void freeSnapshotRing(SnapshotRing* ring) {
+    free(ring->storage);
+    memset(ring, 0, sizeof(*ring));
+}
+
+static unsigned char* getRingFrame(const SnapshotRing* ring, int slot) {
+    return ring->storage + ring->frame_size * (size_t)slot;
+}
+
+void updateSnapshotRing(SnapshotRing* ring, const SimState* state) {
+    long long ticks = state->sim->ticks;
+    if (!ring->storage || ticks % ring->interval != 0) return;
+    // Already held, e.g. the keyframe just rewound to
+    if (ring->count > 0 && getSimSnapshotTicks(getRingFrame(ring, ring->newest)) == ticks) return;
+    ring->newest = (ring->count > 0) ? (ring->newest + 1) % ring->capacity : 0;
+    if (ring->count < ring->capacity) ring->count++;
+    saveSimSnapshot(state, getRingFrame(ring, ring->newest));
+}
+
+long long rewindSnapshotRing(SnapshotRing* ring, const SimState* state, long long ticks) {
+    if (ring->count == 0) return 0;
+    long long now = state->sim->ticks;
+    long long target = now - ticks;
+    // Newest first; stop at the first keyframe old enough, or the oldest held.
+    int back = 0;
+    while (back < ring->count - 1 &&
+           getSimSnapshotTicks(getRingFrame(ring, (ring->newest - back + ring->capacity) % ring->capacity)) > target) {
+        back++;
+    }
+    int slot = (ring->newest - back + ring->capacity) % ring->capacity;
+    const unsigned char* frame = getRingFrame(ring, slot);
+    long long frameTicks = getSimSnapshotTicks(frame);
+    if (frameTicks >= now || !restoreSimSnapshot(state, frame)) return 0;
+    ring->newest = slot;
+    ring->count -= back;
+    return now - frameTicks;
+}
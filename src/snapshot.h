@@ -0,0 +1,73 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include "sim.h"       // SimContext
+#include "car_batch.h" // CarBatch
+#include "ai_driver.h" // AIDriver
+#include "standings.h" // Standings
+
+// --- Race Snapshots ---
+// A snapshot is a copy of everything a race's future depends on, written
+// into a caller-owned buffer: the SimContext (track rules, player car, tick
+// clock, lap and sector timing, finish line flag) and optionally a CarBatch's
+// per-car state, its AI drivers and the standings. Restoring it and running
+// the same inputs gives bit-identical ticks, so a race can be rewound or
+// branched into many what-if rollouts without re-simulating from the start.
+//
+// The buffer is plain bytes (no pointers), laid out as a versioned header
+// followed by each part in a fixed order, so saving and restoring are a few
+// memcpy calls. What it does not hold is shared by every snapshot of a race
+// and must not change between save and restore: the car tuning of a batch,
+// the racing line, the track itself and the standings' track coordinates.
+// The simulation has no random state of its own (runs are seeded by their
+// callers), so there is none to capture.
+
+#define SIM_SNAPSHOT_MAGIC 0x4E533146u // "F1SN" read as a little-endian uint32
+#define SIM_SNAPSHOT_VERSION 2 // 2: Car and CarBatch carry the heading's sine/cosine
+
+// The live state a snapshot is taken from and restored into. Only sim is
+// required; drivers (one per batch car) needs cars.
+typedef struct {
+    SimContext* sim;
+    CarBatch* cars;       // May be NULL
+    AIDriver* drivers;    // May be NULL
+    Standings* standings; // May be NULL
+} SimState;
+
+// Bytes needed for a snapshot of 'state' (fixed while its car counts are).
+size_t getSimSnapshotSize(const SimState* state);
+// Writes the state into 'buffer' (at least getSimSnapshotSize bytes).
+void saveSimSnapshot(const SimState* state, void* buffer);
+// Restores the state from 'buffer'. Returns 0, leaving the state untouched,
+// if the snapshot is of another version or its layout (parts present, car
+// and checkpoint counts) does not match 'state'.
+int restoreSimSnapshot(const SimState* state, const void* buffer);
+// Race tick the snapshot was taken at.
+long long getSimSnapshotTicks(const void* buffer);
+
+// --- Keyframe Ring ---
+// The last 'capacity' snapshots taken every 'interval' ticks, in one
+// preallocated block, for rewinding a race by up to capacity * interval
+// ticks. Keyframes newer than the one rewound to are dropped.
+typedef struct {
+    int capacity;         // Keyframes kept
+    int interval;         // Race ticks between keyframes
+    int count;            // Keyframes held
+    int newest;           // Slot of the newest keyframe
+    size_t frame_size;    // getSimSnapshotSize of the state
+    unsigned char* storage;
+} SnapshotRing;
+
+// Returns 1 on success. 'state' only sets the frame size; pass the same
+// layout to the other calls.
+int initSnapshotRing(SnapshotRing* ring, const SimState* state, int capacity, int interval);
+void freeSnapshotRing(SnapshotRing* ring);
+// Call after each tick: takes a keyframe on every interval'th race tick.
+void updateSnapshotRing(SnapshotRing* ring, const SimState* state);
+// Restores the newest keyframe at least 'ticks' ticks before the race's
+// current tick (or the oldest one held). Returns the ticks rewound, or 0 if
+// there is no keyframe to go back to.
+long long rewindSnapshotRing(SnapshotRing* ring, const SimState* state, long long ticks);
+
+#endif // SNAPSHOT_H
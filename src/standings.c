@@ -0,0 +1,155 @@
+#include "standings.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STANDINGS_NO_LAP (-2) // Checkpoint lap before any car has passed (cars start on lap -1)
+
+// --- Allocation ---
+int initStandings(Standings* standings, int capacity, const TrackProgress* progress) {
+    memset(standings, 0, sizeof(*standings));
+    if (!progress) return 0;
+    if (capacity < 1) capacity = 1;
+    int checkpoints = (int)(progress->length / STANDINGS_CHECKPOINT_SPACING) + 1;
+
+    size_t perCar = (size_t)capacity * sizeof(int);
+    size_t total = 4 * perCar + (size_t)capacity * sizeof(float) * 2 + (size_t)checkpoints * 2 * sizeof(int);
+    unsigned char* block = (unsigned char*)malloc(total);
+    if (!block) return 0;
+
+    unsigned char* p = block;
+    standings->laps = (int*)p;                 p += perCar;
+    standings->checkpoint = (int*)p;           p += perCar;
+    standings->order = (int*)p;                p += perCar;
+    standings->position = (int*)p;             p += perCar;
+    standings->lap_progress = (float*)p;       p += (size_t)capacity * sizeof(float);
+    standings->distance = (float*)p;           p += (size_t)capacity * sizeof(float);
+    standings->checkpoint_lap = (int*)p;       p += (size_t)checkpoints * sizeof(int);
+    standings->checkpoint_time_ms = (int*)p;
+
+    for (int b = 0; b < checkpoints; ++b) {
+        standings->checkpoint_lap[b] = STANDINGS_NO_LAP;
+        standings->checkpoint_time_ms[b] = 0;
+    }
+    standings->progress = progress;
+    standings->capacity = capacity;
+    standings->checkpoint_count = checkpoints;
+    standings->checkpoint_spacing = progress->length / (float)checkpoints;
+    standings->storage = block;
+    return 1;
+}
+
+void freeStandings(Standings* standings) {
+    free(standings->storage);
+    memset(standings, 0, sizeof(*standings));
+}
+
+
+// --- Helpers ---
+// Checkpoint number counted from the start of lap 0 (negative on lap -1).
+static int getCheckpoint(const Standings* standings, int laps, float lapProgress) {
+    int b = (int)(lapProgress / standings->checkpoint_spacing);
+    if (b > standings->checkpoint_count - 1) b = standings->checkpoint_count - 1;
+    return laps * standings->checkpoint_count + b;
+}
+
+// Splits a checkpoint number into its lap and its checkpoint within the lap.
+static int splitCheckpoint(const Standings* standings, int checkpoint, int* lap) {
+    int n = standings->checkpoint_count;
+    *lap = (checkpoint >= 0) ? checkpoint / n : -((-checkpoint + n - 1) / n);
+    return checkpoint - *lap * n;
+}
+
+
+// --- Updates ---
+int addStandingsEntry(Standings* standings, float x, float z) {
+    if (standings->count >= standings->capacity) return -1;
+    int id = standings->count++;
+    float p = sampleTrackProgress(standings->progress, x, z);
+    standings->laps[id] = (p > standings->progress->length * 0.5f) ? -1 : 0; // Behind the line: not started
+    standings->lap_progress[id] = p;
+    standings->distance[id] = (float)standings->laps[id] * standings->progress->length + p;
+    standings->checkpoint[id] = getCheckpoint(standings, standings->laps[id], p);
+    // New entries go to the back; the next sortStandings moves them into place.
+    standings->order[id] = id;
+    standings->position[id] = id;
+    return id;
+}
+
+void updateStandingsEntry(Standings* standings, int id, float x, float z, int timeNowMs) {
+    float length = standings->progress->length;
+    float p = sampleTrackProgress(standings->progress, x, z);
+
+    // --- Laps: progress wrapping past the finish line ---
+    float delta = p - standings->lap_progress[id];
+    if (delta < -length * 0.5f) standings->laps[id]++;
+    else if (delta > length * 0.5f) standings->laps[id]--;
+    standings->lap_progress[id] = p;
+    standings->distance[id] = (float)standings->laps[id] * length + p;
+
+    // --- Checkpoints passed since the last tick ---
+    // The first car past a checkpoint on a lap is the leader there; its time is kept for the gaps.
+    int checkpoint = getCheckpoint(standings, standings->laps[id], p);
+    int first = standings->checkpoint[id] + 1;
+    if (first < checkpoint - standings->checkpoint_count + 1) first = checkpoint - standings->checkpoint_count + 1;
+    for (int c = first; c <= checkpoint; ++c) {
+        int lap;
+        int b = splitCheckpoint(standings, c, &lap);
+        if (lap > standings->checkpoint_lap[b]) {
+            standings->checkpoint_lap[b] = lap;
+            standings->checkpoint_time_ms[b] = timeNowMs;
+        }
+    }
+    standings->checkpoint[id] = checkpoint;
+}
+
+void updateStandingsEntries(Standings* standings, int firstId, int count, const float* x, const float* z, int timeNowMs) {
+    for (int i = 0; i < count; ++i) updateStandingsEntry(standings, firstId + i, x[i], z[i], timeNowMs);
+}
+
+
+// --- Ordering ---
+void sortStandings(Standings* standings) {
+    int* order = standings->order;
+    int* position = standings->position;
+    const float* distance = standings->distance;
+    int swaps = 0;
+    for (int i = 1; i < standings->count; ++i) {
+        int id = order[i];
+        float d = distance[id];
+        int j = i - 1;
+        // Ahead: further round, or level and numbered lower (keeps the order stable)
+        while (j >= 0 && (d > distance[order[j]] || (d == distance[order[j]] && id < order[j]))) {
+            order[j + 1] = order[j];
+            position[order[j + 1]] = j + 1;
+            --j;
+            ++swaps;
+        }
+        order[j + 1] = id;
+        position[id] = j + 1;
+    }
+    standings->swaps = swaps;
+}
+
+
+// --- Queries ---
+float getStandingsDistance(const Standings* standings, int id) {
+    return standings->distance[id];
+}
+
+int getStandingsLaps(const Standings* standings, int id) {
+    return standings->laps[id] > 0 ? standings->laps[id] : 0;
+}
+
+int getStandingsGapMs(const Standings* standings, int id, int timeNowMs, int* lapsBehind) {
+    if (lapsBehind) *lapsBehind = 0;
+    if (standings->position[id] == 0) return 0;
+    int lap;
+    int b = splitCheckpoint(standings, standings->checkpoint[id], &lap);
+    int leaderLap = standings->checkpoint_lap[b];
+    if (leaderLap > lap) {
+        if (lapsBehind) *lapsBehind = leaderLap - lap;
+        return 0;
+    }
+    if (leaderLap < lap) return 0; // Nobody has been here on this lap before (not yet sorted)
+    return timeNowMs - standings->checkpoint_time_ms[b];
+}
@@ -0,0 +1,69 @@
+#ifndef STANDINGS_H
+#define STANDINGS_H
+
+#include "track_progress.h" // TrackProgress
+
+// --- Race Standings ---
+// Race order and gaps for a field of competitors (the player, opponents,
+// a --cars field). Each competitor's distance raced is its laps plus its
+// progress round the lap (track_progress.h). Laps are counted when progress
+// wraps past the finish line, so every car is judged the same way.
+//
+// Ordering: the order array is kept sorted by distance raced with an
+// insertion sort each tick. From one tick to the next only cars that are
+// overtaking change places, so the sort does one pass over the field plus
+// one step per place changed, instead of a full sort.
+//
+// Gaps: the lap is divided into checkpoints STANDINGS_CHECKPOINT_SPACING
+// apart, each holding the time and lap at which the leader (whoever got
+// there first) last passed it. A car's gap to the leader is the time since
+// the leader passed the checkpoint the car is at, which costs one lookup.
+
+#define STANDINGS_CHECKPOINT_SPACING 1.0f // World units between gap checkpoints
+
+typedef struct {
+    const TrackProgress* progress;
+    int capacity;
+    int count;              // Competitors; numbered 0 .. count - 1
+    int* laps;              // Finish line crossings (-1 until a car first crosses it)
+    float* lap_progress;    // Progress round the current lap
+    float* distance;        // Distance raced: laps * track length + lap_progress
+    int* checkpoint;        // Last checkpoint reached, counted from the start of lap 0
+    int* order;             // Competitors from the leader down
+    int* position;          // Index into order of each competitor
+
+    int checkpoint_count;   // Checkpoints per lap
+    float checkpoint_spacing;
+    int* checkpoint_lap;    // Lap on which the leader last passed each checkpoint
+    int* checkpoint_time_ms;
+
+    int swaps;              // Places changed by the last sortStandings
+    void* storage;
+} Standings;
+
+// 'progress' is the track's coordinates (getTrackProgress). Returns 1 on success.
+int initStandings(Standings* standings, int capacity, const TrackProgress* progress);
+void freeStandings(Standings* standings);
+
+// Adds a competitor at (x, z) on the starting grid and returns its number, or
+// -1 if full. Cars behind the finish line start on lap -1, so crossing the
+// line starts lap 0, as in sim.c.
+int addStandingsEntry(Standings* standings, float x, float z);
+
+// Moves competitor 'id' to (x, z), once per tick after the physics.
+void updateStandingsEntry(Standings* standings, int id, float x, float z, int timeNowMs);
+// The same for 'count' competitors from 'firstId' (e.g. a CarBatch's x/z arrays).
+void updateStandingsEntries(Standings* standings, int firstId, int count, const float* x, const float* z, int timeNowMs);
+
+// Restores the race order after the updates of a tick.
+void sortStandings(Standings* standings);
+
+// Distance raced by a competitor (laps * track length + progress).
+float getStandingsDistance(const Standings* standings, int id);
+// Completed laps of a competitor (0 until it has crossed the line twice).
+int getStandingsLaps(const Standings* standings, int id);
+// Gap of a competitor to the leader in ms; *lapsBehind (may be NULL) is set
+// to the number of laps the leader is ahead, in which case the time is 0.
+int getStandingsGapMs(const Standings* standings, int id, int timeNowMs, int* lapsBehind);
+
+#endif // STANDINGS_H
@@ -0,0 +1,433 @@
+// Handling sweep runner.
+// Runs headless autopilot laps for every combination of the car's handling
+// parameters over the given ranges, on the built-in tracks, and reports the
+// lap time distribution of each configuration. Each configuration is raced
+// several times from slightly randomized start positions (Monte-Carlo), and
+// all races run in parallel on a work-stealing task pool (task_pool.c).
+//
+// Each task owns its SimContext (the shared track caches are only read once
+// built), so any number of races can run at once.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim.h"
+#include "driver.h"
+#include "task_pool.h"
+#include "platform.h" // getPlatformTimeSeconds
+#include "track_grid.h" // getTrackGrid, built before the workers start
+
+#define SWEEP_MAX_STEPS 64              // Values per parameter range
+#define SWEEP_DEFAULT_RUNS 16
+#define SWEEP_DEFAULT_LAPS 5
+#define SWEEP_SECONDS_PER_LAP 60.0      // Race time limit per lap, in case the car gets stuck
+
+// --- Parameter Ranges ---
+typedef enum {
+    PARAM_ACCELERATION,
+    PARAM_BRAKING,
+    PARAM_FRICTION,
+    PARAM_TURN_SPEED,
+    PARAM_MAX_SPEED,
+    PARAM_COUNT
+} SweepParam;
+
+static const char* const paramOptions[PARAM_COUNT] = { "--accel", "--brake", "--friction", "--turn", "--max-speed" };
+static const char* const paramLabels[PARAM_COUNT] = { "accel", "brake", "friction", "turn", "max_speed" };
+
+typedef struct {
+    float min, max;
+    int steps; // Number of evenly spaced values from min to max (1 = just min)
+} ParamRange;
+
+static float getParamValue(const ParamRange* range, int step) {
+    if (range->steps <= 1) return range->min;
+    return range->min + (range->max - range->min) * (float)step / (float)(range->steps - 1);
+}
+
+static float* getTuningField(CarTuning* tuning, SweepParam param) {
+    switch (param) {
+        case PARAM_ACCELERATION: return &tuning->acceleration_rate;
+        case PARAM_BRAKING:      return &tuning->braking_rate;
+        case PARAM_FRICTION:     return &tuning->friction;
+        case PARAM_TURN_SPEED:   return &tuning->turn_speed;
+        default:                 return &tuning->max_speed;
+    }
+}
+
+// Parses "V" or "MIN:MAX:STEPS". Returns 1 on success.
+static int parseRange(const char* text, ParamRange* range) {
+    float min, max;
+    int steps;
+    char extra;
+    if (sscanf(text, "%f:%f:%d%c", &min, &max, &steps, &extra) == 3) {
+        if (steps < 1 || steps > SWEEP_MAX_STEPS) return 0;
+        range->min = min; range->max = max; range->steps = steps;
+        return 1;
+    }
+    if (sscanf(text, "%f%c", &min, &extra) == 1) {
+        range->min = range->max = min; range->steps = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// --- Driver Policies ---
+// Autopilot variants that differ in how hard they take the corners.
+typedef struct {
+    const char* name;
+    float corner_speed;
+} DriverPolicy;
+
+static const DriverPolicy driverPolicies[] = {
+    {"autopilot",  AUTOPILOT_CORNER_SPEED},
+    {"cautious",   AUTOPILOT_CORNER_SPEED * 0.7f},
+    {"aggressive", AUTOPILOT_CORNER_SPEED * 1.4f},
+};
+#define DRIVER_POLICY_COUNT ((int)(sizeof(driverPolicies) / sizeof(driverPolicies[0])))
+
+// --- Sweep Setup ---
+// Races are numbered config-major: race = (config * trackCount + track) * runs + run.
+typedef struct {
+    ParamRange ranges[PARAM_COUNT];
+    int configCount;
+    TrackType tracks[2];
+    int trackCount;
+    int runs;
+    int laps;
+    int tickRate;
+    float jitter;        // Start position offset across the track, +/- units
+    float headingJitter; // Start heading offset, +/- degrees
+    unsigned int seed;
+    const DriverPolicy* driver;
+
+    // Results, laps slots per race
+    int* lapTimesMs;
+    int* lapCounts;
+} Sweep;
+
+// Configuration index -> tuning. The first parameter varies fastest.
+static void getConfigTuning(const Sweep* sweep, int config, CarTuning* tuning) {
+    getDefaultCarTuning(tuning);
+    for (int p = 0; p < PARAM_COUNT; ++p) {
+        const ParamRange* range = &sweep->ranges[p];
+        *getTuningField(tuning, (SweepParam)p) = getParamValue(range, config % range->steps);
+        config /= range->steps;
+    }
+}
+
+// Per-race generator, seeded from the race index so results do not depend
+// on which worker runs which race.
+static unsigned int hashSeed(unsigned int seed, unsigned int index) {
+    unsigned int h = seed ^ (index * 0x9E3779B9u);
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static float randomRange(unsigned int* state, float lo, float hi) {
+    *state = *state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(*state >> 8) / 16777216.0f;
+}
+
+// --- One Race ---
+// A SimContext driven through updateRace, so the laps are timed by the same
+// rules as every other race (start line state, voided laps, the clock).
+static void runSweepRace(void* context, int race, int workerIndex) {
+    Sweep* sweep = (Sweep*)context;
+    (void)workerIndex;
+    int run = race % sweep->runs;
+    int trackSlot = (race / sweep->runs) % sweep->trackCount;
+    int config = race / (sweep->runs * sweep->trackCount);
+    TrackType track = sweep->tracks[trackSlot];
+    int* lapTimes = &sweep->lapTimesMs[(size_t)race * sweep->laps];
+
+    CarTuning tuning;
+    getConfigTuning(sweep, config, &tuning);
+    SimContext sim;
+    initSimContext(&sim, track, sweep->tickRate);
+    initRace(&sim);
+    Car car = sim.car;
+    applyCarTuning(&car, &tuning);
+
+    // Random start: shifted across the track and turned slightly. The same run
+    // number gets the same start for every configuration.
+    unsigned int rng = hashSeed(sweep->seed, (unsigned int)(trackSlot * sweep->runs + run));
+    float offset = randomRange(&rng, -sweep->jitter, sweep->jitter);
+    car.x += car.heading_cos * offset;  // Perpendicular to the heading
+    car.z -= car.heading_sin * offset;
+    setCarAngle(&car, fmodf(car.angle + randomRange(&rng, -sweep->headingJitter, sweep->headingJitter) + 360.0f, 360.0f));
+    car.prev_x = car.x; car.prev_z = car.z;
+    setRaceStartCar(&sim, &car);
+
+    Autopilot pilot;
+    initAutopilot(&pilot, &sim.track, &sim.car);
+    pilot.corner_speed = sweep->driver->corner_speed;
+
+    long long maxTicks = (long long)(SWEEP_SECONDS_PER_LAP * sweep->laps * sweep->tickRate);
+    while (sim.ticks < maxTicks && sim.laps_completed < sweep->laps) {
+        updateAutopilot(&pilot, &sim.car);
+        if (updateRace(&sim) & RACE_EVENT_LAP_COMPLETED) {
+            lapTimes[sim.laps_completed - 1] = sim.last_lap_time_ms;
+        }
+    }
+    sweep->lapCounts[race] = sim.laps_completed;
+}
+
+// --- Report ---
+typedef struct {
+    int laps;        // Laps completed over all runs
+    int unfinished;  // Runs that hit the time limit before completing every lap
+    double best, p10, median, mean, p90, worst, stddev; // Seconds
+} LapStats;
+
+static int compareInts(const void* a, const void* b) {
+    int ia = *(const int*)a, ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+// Lap time distribution of one configuration on one track. 'scratch' holds
+// runs * laps ints.
+static void getLapStats(const Sweep* sweep, int config, int trackSlot, int* scratch, LapStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    int firstRace = (config * sweep->trackCount + trackSlot) * sweep->runs;
+    double sum = 0.0;
+    for (int run = 0; run < sweep->runs; ++run) {
+        int race = firstRace + run;
+        int count = sweep->lapCounts[race];
+        if (count < sweep->laps) stats->unfinished++;
+        for (int i = 0; i < count; ++i) {
+            int ms = sweep->lapTimesMs[(size_t)race * sweep->laps + i];
+            scratch[stats->laps++] = ms;
+            sum += ms;
+        }
+    }
+    int n = stats->laps;
+    if (n == 0) return;
+    qsort(scratch, (size_t)n, sizeof(int), compareInts);
+    double mean = sum / n, var = 0.0;
+    for (int i = 0; i < n; ++i) var += (scratch[i] - mean) * (scratch[i] - mean);
+    stats->best = scratch[0] / 1000.0;
+    stats->p10 = scratch[(n - 1) / 10] / 1000.0;
+    stats->median = scratch[(n - 1) / 2] / 1000.0;
+    stats->p90 = scratch[(n - 1) * 9 / 10] / 1000.0;
+    stats->worst = scratch[n - 1] / 1000.0;
+    stats->mean = mean / 1000.0;
+    stats->stddev = sqrt(var / n) / 1000.0;
+}
+
+static const char* getTrackLabel(TrackType track) {
+    return track == TRACK_RECT ? "rect" : "round";
+}
+
+// Prints the summary table and, if paths are given, writes it as CSV and/or
+// every individual lap time as CSV.
+static int writeReport(const Sweep* sweep, const char* csvPath, const char* lapsPath) {
+    int* scratch = (int*)malloc((size_t)sweep->runs * sweep->laps * sizeof(int));
+    if (!scratch) return 0;
+    FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+    FILE* lapsCsv = lapsPath ? fopen(lapsPath, "w") : NULL;
+    if ((csvPath && !csv) || (lapsPath && !lapsCsv)) {
+        fprintf(stderr, "Cannot write '%s'\n", (csvPath && !csv) ? csvPath : lapsPath);
+        if (csv) fclose(csv);
+        if (lapsCsv) fclose(lapsCsv);
+        free(scratch);
+        return 0;
+    }
+    if (csv) {
+        fprintf(csv, "config,track");
+        for (int p = 0; p < PARAM_COUNT; ++p) fprintf(csv, ",%s", paramLabels[p]);
+        fprintf(csv, ",laps,unfinished_runs,best_s,p10_s,median_s,mean_s,p90_s,worst_s,stddev_s\n");
+    }
+    if (lapsCsv) {
+        fprintf(lapsCsv, "config,track");
+        for (int p = 0; p < PARAM_COUNT; ++p) fprintf(lapsCsv, ",%s", paramLabels[p]);
+        fprintf(lapsCsv, ",run,lap,lap_ms\n");
+    }
+
+    printf("%6s %-5s %6s %6s %8s %6s %9s %5s %4s %8s %8s %8s %8s %8s %8s %7s\n",
+           "config", "track", "accel", "brake", "friction", "turn", "max_speed",
+           "laps", "dnf", "best", "p10", "median", "mean", "p90", "worst", "stddev");
+    for (int config = 0; config < sweep->configCount; ++config) {
+        CarTuning tuning;
+        getConfigTuning(sweep, config, &tuning);
+        float values[PARAM_COUNT];
+        for (int p = 0; p < PARAM_COUNT; ++p) values[p] = *getTuningField(&tuning, (SweepParam)p);
+        for (int t = 0; t < sweep->trackCount; ++t) {
+            const char* trackName = getTrackLabel(sweep->tracks[t]);
+            LapStats stats;
+            getLapStats(sweep, config, t, scratch, &stats);
+            printf("%6d %-5s %6.2f %6.2f %8.2f %6.1f %9.2f %5d %4d %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %7.3f\n",
+                   config, trackName, values[0], values[1], values[2], values[3], values[4],
+                   stats.laps, stats.unfinished, stats.best, stats.p10, stats.median,
+                   stats.mean, stats.p90, stats.worst, stats.stddev);
+            if (csv) {
+                fprintf(csv, "%d,%s", config, trackName);
+                for (int p = 0; p < PARAM_COUNT; ++p) fprintf(csv, ",%g", values[p]);
+                fprintf(csv, ",%d,%d,%.3f,%.3f,%.3f,%.4f,%.3f,%.3f,%.4f\n", stats.laps, stats.unfinished,
+                        stats.best, stats.p10, stats.median, stats.mean, stats.p90, stats.worst, stats.stddev);
+            }
+            if (lapsCsv) {
+                int firstRace = (config * sweep->trackCount + t) * sweep->runs;
+                for (int run = 0; run < sweep->runs; ++run) {
+                    int race = firstRace + run;
+                    for (int lap = 0; lap < sweep->lapCounts[race]; ++lap) {
+                        fprintf(lapsCsv, "%d,%s", config, trackName);
+                        for (int p = 0; p < PARAM_COUNT; ++p) fprintf(lapsCsv, ",%g", values[p]);
+                        fprintf(lapsCsv, ",%d,%d,%d\n", run, lap + 1, sweep->lapTimesMs[(size_t)race * sweep->laps + lap]);
+                    }
+                }
+            }
+        }
+    }
+    free(scratch);
+    int ok = 1;
+    if (csv && fclose(csv) != 0) ok = 0;
+    if (lapsCsv && fclose(lapsCsv) != 0) ok = 0;
+    return ok;
+}
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [--track rect|round|both] [--accel R] [--brake R] [--friction R] [--turn R]\n"
+           "       [--max-speed R] [--driver autopilot|cautious|aggressive] [--runs N] [--laps N]\n"
+           "       [--jitter U] [--heading-jitter DEG] [--seed N] [--threads N] [--physics-hz N]\n"
+           "       [--csv FILE] [--laps-csv FILE]\n", prog);
+    printf("  R is a single value or MIN:MAX:STEPS (at most %d steps); parameters not given\n", SWEEP_MAX_STEPS);
+    printf("  keep the defaults from initCar. Every combination is one configuration.\n");
+    printf("  --track           Track(s) to race each configuration on (default: both)\n");
+    printf("  --driver          Autopilot policy: corner speed %.0f / %.0f / %.0f (default: autopilot)\n",
+           driverPolicies[0].corner_speed, driverPolicies[1].corner_speed, driverPolicies[2].corner_speed);
+    printf("  --runs            Races per configuration and track (default: %d)\n", SWEEP_DEFAULT_RUNS);
+    printf("  --laps            Laps per race (default: %d)\n", SWEEP_DEFAULT_LAPS);
+    printf("  --jitter          Random start offset across the track, +/- units (default: 1)\n");
+    printf("  --heading-jitter  Random start heading offset, +/- degrees (default: 2)\n");
+    printf("  --seed            Seed for the random starts (default: 1)\n");
+    printf("  --threads         Worker threads (default: one per logical processor)\n");
+    printf("  --physics-hz      Physics ticks per simulated second (default: %d)\n", SIM_DEFAULT_TICK_RATE);
+    printf("  --csv             Write the summary table as CSV\n");
+    printf("  --laps-csv        Write every lap time as CSV\n");
+}
+
+int main(int argc, char** argv) {
+    Sweep sweep;
+    memset(&sweep, 0, sizeof(sweep));
+    CarTuning defaults;
+    getDefaultCarTuning(&defaults);
+    for (int p = 0; p < PARAM_COUNT; ++p) {
+        float value = *getTuningField(&defaults, (SweepParam)p);
+        sweep.ranges[p].min = sweep.ranges[p].max = value;
+        sweep.ranges[p].steps = 1;
+    }
+    sweep.tracks[0] = TRACK_RECT; sweep.tracks[1] = TRACK_ROUNDED;
+    sweep.trackCount = 2;
+    sweep.runs = SWEEP_DEFAULT_RUNS;
+    sweep.laps = SWEEP_DEFAULT_LAPS;
+    sweep.tickRate = SIM_DEFAULT_TICK_RATE;
+    sweep.jitter = 1.0f;
+    sweep.headingJitter = 2.0f;
+    sweep.seed = 1u;
+    sweep.driver = &driverPolicies[0];
+    int threads = 0;
+    const char* csvPath = NULL;
+    const char* lapsPath = NULL;
+
+    // --- Parse Command Line ---
+    for (int i = 1; i < argc; ++i) {
+        int param = -1;
+        for (int p = 0; p < PARAM_COUNT; ++p) {
+            if (strcmp(argv[i], paramOptions[p]) == 0) param = p;
+        }
+        if (param >= 0 && i + 1 < argc) {
+            if (!parseRange(argv[++i], &sweep.ranges[param])) {
+                fprintf(stderr, "%s: expected a value or MIN:MAX:STEPS (1-%d steps), got '%s'\n",
+                        paramOptions[param], SWEEP_MAX_STEPS, argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--track") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "rect") == 0) { sweep.tracks[0] = TRACK_RECT; sweep.trackCount = 1; }
+            else if (strcmp(name, "round") == 0) { sweep.tracks[0] = TRACK_ROUNDED; sweep.trackCount = 1; }
+            else if (strcmp(name, "both") == 0) { sweep.tracks[0] = TRACK_RECT; sweep.tracks[1] = TRACK_ROUNDED; sweep.trackCount = 2; }
+            else { fprintf(stderr, "Unknown track '%s'\n", name); return 1; }
+        } else if (strcmp(argv[i], "--driver") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            sweep.driver = NULL;
+            for (int d = 0; d < DRIVER_POLICY_COUNT; ++d) {
+                if (strcmp(name, driverPolicies[d].name) == 0) sweep.driver = &driverPolicies[d];
+            }
+            if (!sweep.driver) { fprintf(stderr, "Unknown driver policy '%s'\n", name); return 1; }
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            sweep.runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--laps") == 0 && i + 1 < argc) {
+            sweep.laps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            sweep.jitter = fabsf((float)atof(argv[++i]));
+        } else if (strcmp(argv[i], "--heading-jitter") == 0 && i + 1 < argc) {
+            sweep.headingJitter = fabsf((float)atof(argv[++i]));
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            sweep.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--physics-hz") == 0 && i + 1 < argc) {
+            sweep.tickRate = atoi(argv[++i]);
+            if (sweep.tickRate < 1 || sweep.tickRate > SIM_MAX_TICK_RATE) {
+                fprintf(stderr, "--physics-hz must be between 1 and %d\n", SIM_MAX_TICK_RATE);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--laps-csv") == 0 && i + 1 < argc) {
+            lapsPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+    if (sweep.runs < 1) sweep.runs = 1;
+    if (sweep.laps < 1) sweep.laps = 1;
+    sweep.configCount = 1;
+    for (int p = 0; p < PARAM_COUNT; ++p) sweep.configCount *= sweep.ranges[p].steps;
+    long long raceCount = (long long)sweep.configCount * sweep.trackCount * sweep.runs;
+    if (raceCount > 0x7FFFFFFF / sweep.laps) {
+        fprintf(stderr, "Too many races (%lld); reduce the steps or --runs\n", raceCount);
+        return 1;
+    }
+
+    sweep.lapTimesMs = (int*)malloc((size_t)raceCount * sweep.laps * sizeof(int));
+    sweep.lapCounts = (int*)calloc((size_t)raceCount, sizeof(int));
+    if (!sweep.lapTimesMs || !sweep.lapCounts) {
+        fprintf(stderr, "Failed to allocate results for %lld races\n", raceCount);
+        free(sweep.lapTimesMs); free(sweep.lapCounts);
+        return 1;
+    }
+
+    // Warm-up: the autopilot's centerline paths and the swept collision's
+    // distance grids are built once on first use, so build them here to keep
+    // that cost out of the timed run below.
+    for (int t = 0; t < sweep.trackCount; ++t) {
+        SimTrack track;
+        initSimTrack(&track, sweep.tracks[t]);
+        getTrackGrid(&track);
+        Autopilot pilot; Car car;
+        initCar(&car, &track);
+        initAutopilot(&pilot, &track, &car);
+    }
+
+    // --- Run ---
+    double wallStart = getPlatformTimeSeconds();
+    int workers = runTaskPool((int)raceCount, threads, runSweepRace, &sweep);
+    double wallSeconds = getPlatformTimeSeconds() - wallStart;
+
+    printf("Driver:         %s\n", sweep.driver->name);
+    printf("Configurations: %d x %d track(s), %d runs of %d laps each\n",
+           sweep.configCount, sweep.trackCount, sweep.runs, sweep.laps);
+    printf("Races:          %lld on %d worker(s) in %.3f s\n", raceCount, workers, wallSeconds);
+    printf("Lap times in seconds (dnf = runs that hit the %.0f s/lap time limit):\n", SWEEP_SECONDS_PER_LAP);
+    int ok = writeReport(&sweep, csvPath, lapsPath);
+
+    free(sweep.lapTimesMs);
+    free(sweep.lapCounts);
+    return ok ? 0 : 1;
+}
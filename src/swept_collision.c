@@ -0,0 +1,124 @@
+#include "swept_collision.h"
+#include "corner_collision.h" // areCarCornersOnTrack
+#include "track_grid.h"       // Wall normals and the clearance shortcut
+#include <math.h>
+
+#define SWEEP_BISECTION_STEPS 10   // Time of impact to 1/1024 of the blocked step
+#define SWEEP_CLEARANCE_MARGIN 0.25f // Grid error allowed for in the clearance shortcut
+
+static int isPoseOnTrack(const SimTrack* track, float x, float z, float s, float c, float hw, float hl) {
+    return areCarCornersOnTrack(track, x, z, s, c, hw, hl);
+}
+
+// Fraction of the move (dx, dz) from (x0, z0) that is clear of the track
+// edge: 1 if all of it is, else the last clear fraction found by bisection
+// (*blockedT is then the first blocked one).
+static float findImpactFraction(const SimTrack* track, float x0, float z0, float dx, float dz,
+                                float s, float c, float hw, float hl, int endOnTrack, float* blockedT) {
+    float length = sqrtf(dx * dx + dz * dz);
+    int steps = (int)ceilf(length / hw);
+    if (steps < 1) steps = 1;
+    *blockedT = 1.0f;
+    if (endOnTrack) {
+        // A move no longer than one step cannot skip over anything the end test misses.
+        if (steps == 1) return 1.0f;
+        // Shortcut: every point the box sweeps over lies within this distance
+        // of the move's midpoint, so if that much road surrounds it there is
+        // nothing to find.
+        const TrackGrid* grid = getTrackGrid(track);
+        float reach = length * 0.5f + sqrtf(hw * hw + hl * hl) + SWEEP_CLEARANCE_MARGIN;
+        if (grid && sampleTrackGrid(grid, x0 + dx * 0.5f, z0 + dz * 0.5f) < -reach) return 1.0f;
+    }
+
+    float clearT = 0.0f;
+    for (int k = 1; k <= steps; ++k) {
+        float t = (float)k / (float)steps;
+        int onTrack = (k == steps) ? endOnTrack : isPoseOnTrack(track, x0 + dx * t, z0 + dz * t, s, c, hw, hl);
+        if (onTrack) { clearT = t; continue; }
+
+        float lo = clearT, hi = t;
+        for (int b = 0; b < SWEEP_BISECTION_STEPS; ++b) {
+            float mid = (lo + hi) * 0.5f;
+            if (isPoseOnTrack(track, x0 + dx * mid, z0 + dz * mid, s, c, hw, hl)) lo = mid;
+            else hi = mid;
+        }
+        *blockedT = hi;
+        return lo;
+    }
+    return 1.0f;
+}
+
+// Outward wall normal where the box at (x, z) pokes off the track, from the
+// distance grid's gradient at the first off-track corner. Returns 0 if there
+// is none to be had (no grid, or a flat spot in the field).
+static int getWallNormal(const SimTrack* track, float x, float z, float s, float c, float hw, float hl, float* nx, float* nz) {
+    const TrackGrid* grid = getTrackGrid(track);
+    if (!grid) return 0;
+    // Corner order as in calculateCarCorners: FL, FR, RL, RR
+    const float lxs[4] = { -hw, hw, -hw, hw };
+    const float lzs[4] = { hl, hl, -hl, -hl };
+    for (int k = 0; k < 4; ++k) {
+        float cx = x + lxs[k] * c + lzs[k] * s;
+        float cz = z - lxs[k] * s + lzs[k] * c;
+        if (isPositionOnTrack(track, cx, cz)) continue;
+        float gx, gz;
+        sampleTrackGridGradient(grid, cx, cz, &gx, &gz);
+        float g = sqrtf(gx * gx + gz * gz);
+        if (g < 1e-6f) return 0;
+        *nx = gx / g;
+        *nz = gz / g;
+        return 1;
+    }
+    return 0;
+}
+
+int sweepCarAgainstTrack(const SimTrack* track, float* x, float* z, float potential_x, float potential_z,
+                         float sin_a, float cos_a, float half_width, float half_length,
+                         float* speed, int endOnTrack) {
+    float x0 = *x, z0 = *z;
+    float dx = potential_x - x0, dz = potential_z - z0;
+    float blockedT;
+    float t = findImpactFraction(track, x0, z0, dx, dz, sin_a, cos_a, half_width, half_length, endOnTrack, &blockedT);
+    if (t >= 1.0f) {
+        *x = potential_x; // Exactly the unswept result when nothing is hit
+        *z = potential_z;
+        return 0;
+    }
+
+    // --- Impact ---
+    float hitX = x0 + dx * t, hitZ = z0 + dz * t;
+    float nx, nz;
+    if ((t <= 0.0f && !isPoseOnTrack(track, x0, z0, sin_a, cos_a, half_width, half_length)) ||
+        !getWallNormal(track, x0 + dx * blockedT, z0 + dz * blockedT, sin_a, cos_a, half_width, half_length, &nx, &nz)) {
+        // Already touching at the start (e.g. turned into the wall while
+        // stopped), or no normal to slide along: stop where the car is.
+        *x = hitX;
+        *z = hitZ;
+        *speed = 0.0f;
+        return 1;
+    }
+
+    // --- Slide ---
+    // Keep the part of the remaining move and of the speed that runs along the wall.
+    float length = sqrtf(dx * dx + dz * dz);
+    float into = (dx * nx + dz * nz) / length; // Cosine between the motion and the wall normal
+    if (into > 0.0f) *speed *= sqrtf(fmaxf(0.0f, 1.0f - into * into));
+    float rx = dx * (1.0f - t), rz = dz * (1.0f - t);
+    float rn = rx * nx + rz * nz;
+    if (rn > 0.0f) { rx -= rn * nx; rz -= rn * nz; }
+
+    float slideEndX = hitX + rx, slideEndZ = hitZ + rz;
+    int slideEndOnTrack = isPoseOnTrack(track, slideEndX, slideEndZ, sin_a, cos_a, half_width, half_length);
+    float slideT = findImpactFraction(track, hitX, hitZ, rx, rz, sin_a, cos_a, half_width, half_length,
+                                      slideEndOnTrack, &blockedT);
+    if (slideT >= 1.0f) {
+        *x = slideEndX;
+        *z = slideEndZ;
+    } else {
+        // Blocked along the wall as well: wedged into a corner.
+        *x = hitX + rx * slideT;
+        *z = hitZ + rz * slideT;
+        *speed = 0.0f;
+    }
+    return 1;
+}
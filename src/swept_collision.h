@@ -0,0 +1,28 @@
+#ifndef SWEPT_COLLISION_H
+#define SWEPT_COLLISION_H
+
+#include "sim.h" // SimTrack
+
+// --- Swept Track Collision ---
+// Moves a car's box from (*x, *z) towards (potential_x, potential_z) and
+// stops it where it first touches the track edge, instead of only testing
+// the end position. The path is checked at steps no longer than half the
+// car's width, so a fast car (or a long physics step) cannot jump over a
+// thin off-track strip. The first blocked step is refined to the time of
+// impact by bisection.
+//
+// After an impact the rest of the move slides along the wall: the part of it
+// pushing into the wall (along the distance grid's gradient at the blocked
+// corner) is removed, and the speed keeps only its component along the wall,
+// so a glancing hit scrapes past while a head-on one still stops the car.
+// Used by updateCar and updateCarBatch when the track's collision_response
+// is TRACK_COLLISION_SWEPT.
+//
+// endOnTrack is the caller's areCarCornersOnTrack result for the end
+// position (the batch update has it for every car already). sin_a/cos_a are
+// the heading's sine and cosine. Returns 1 if the car touched the edge.
+int sweepCarAgainstTrack(const SimTrack* track, float* x, float* z, float potential_x, float potential_z,
+                         float sin_a, float cos_a, float half_width, float half_length,
+                         float* speed, int endOnTrack);
+
+#endif // SWEPT_COLLISION_H
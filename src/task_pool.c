@@ -0,0 +1,97 @@
+#include "task_pool.h"
+#include "platform.h" // Threads and atomics
+#include <stdlib.h>
+
+// Each worker's remaining block is one 64-bit word, front index in the high
+// half and end index in the low half, so the owner (taking the front) and
+// thieves (taking the back) agree on the last task with a single
+// compare-exchange.
+typedef struct {
+    unsigned long long range;
+    char padding[56]; // One worker per cache line
+} TaskQueue;
+
+typedef struct {
+    TaskQueue* queues;
+    int workerCount;
+    TaskFunction function;
+    void* context;
+} TaskPool;
+
+typedef struct {
+    TaskPool* pool;
+    int index;
+} TaskWorker;
+
+#define RANGE_FRONT(range) ((int)((range) >> 32))
+#define RANGE_END(range) ((int)((range) & 0xFFFFFFFFu))
+#define MAKE_RANGE(front, end) (((unsigned long long)(unsigned int)(front) << 32) | (unsigned int)(end))
+
+// Takes a task from the front (owner) or back (thief) of a queue; -1 if empty.
+static int takeTask(TaskQueue* queue, int fromBack) {
+    unsigned long long range = platformAtomicLoad(&queue->range);
+    for (;;) {
+        int front = RANGE_FRONT(range), end = RANGE_END(range);
+        if (front >= end) return -1;
+        unsigned long long next = fromBack ? MAKE_RANGE(front, end - 1) : MAKE_RANGE(front + 1, end);
+        if (platformAtomicCompareExchange(&queue->range, &range, next)) {
+            return fromBack ? end - 1 : front;
+        }
+    }
+}
+
+static void runWorker(void* arg) {
+    TaskWorker* worker = (TaskWorker*)arg;
+    TaskPool* pool = worker->pool;
+    int task;
+    while ((task = takeTask(&pool->queues[worker->index], 0)) >= 0) {
+        pool->function(pool->context, task, worker->index);
+    }
+    // Own block done: steal from the others, starting with the next worker.
+    // Tasks are never added, so once every queue is empty the pool is done.
+    for (int offset = 1; offset < pool->workerCount; ++offset) {
+        TaskQueue* victim = &pool->queues[(worker->index + offset) % pool->workerCount];
+        while ((task = takeTask(victim, 1)) >= 0) {
+            pool->function(pool->context, task, worker->index);
+        }
+    }
+}
+
+int runTaskPool(int taskCount, int workerCount, TaskFunction function, void* context) {
+    if (workerCount <= 0) workerCount = getPlatformCpuCount();
+    if (workerCount > taskCount) workerCount = taskCount > 0 ? taskCount : 1;
+
+    TaskPool pool;
+    pool.queues = (TaskQueue*)calloc((size_t)workerCount, sizeof(TaskQueue));
+    TaskWorker* workers = (TaskWorker*)malloc((size_t)workerCount * sizeof(TaskWorker));
+    PlatformThread* threads = (PlatformThread*)calloc((size_t)workerCount, sizeof(PlatformThread));
+    if (!pool.queues || !workers || !threads) {
+        // Run everything on the calling thread instead.
+        free(pool.queues); free(workers); free(threads);
+        for (int i = 0; i < taskCount; ++i) function(context, i, 0);
+        return 1;
+    }
+    pool.workerCount = workerCount;
+    pool.function = function;
+    pool.context = context;
+    for (int w = 0; w < workerCount; ++w) {
+        int front = (int)((long long)taskCount * w / workerCount);
+        int end = (int)((long long)taskCount * (w + 1) / workerCount);
+        pool.queues[w].range = MAKE_RANGE(front, end);
+        workers[w].pool = &pool;
+        workers[w].index = w;
+    }
+
+    // Workers that fail to start just leave their block to be stolen.
+    int started = 1;
+    for (int w = 1; w < workerCount; ++w) {
+        if (startPlatformThread(&threads[w], runWorker, &workers[w])) started++;
+    }
+    runWorker(&workers[0]);
+    for (int w = 1; w < workerCount; ++w) joinPlatformThread(&threads[w]);
+
+    free(threads);
+    free(workers);
+    free(pool.queues);
+    return started;
+}
@@ -0,0 +1,20 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+// --- Work-Stealing Task Pool ---
+// Runs tasks 0..taskCount-1 on a set of worker threads and returns when all
+// are done. Each worker starts with an equal contiguous block of task indices
+// and takes tasks from the front of its own block; a worker whose block is
+// empty steals single tasks from the back of another's. Uneven task costs
+// (e.g. races that crash and run to their time limit) therefore balance out
+// without a shared queue that every worker contends on.
+//
+// The calling thread is worker 0. Tasks must not depend on each other.
+
+typedef void (*TaskFunction)(void* context, int taskIndex, int workerIndex);
+
+// workerCount <= 0 uses one worker per logical processor. Returns the number
+// of workers that ran (falls back to fewer if threads cannot be started).
+int runTaskPool(int taskCount, int workerCount, TaskFunction function, void* context);
+
+#endif // TASK_POOL_H
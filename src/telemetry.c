@@ -0,0 +1,125 @@
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TELEMETRY_RING_MASK (TELEMETRY_RING_RECORDS - 1)
+#define TELEMETRY_WRITER_SLEEP_MS 10 // Writer poll interval when the ring is empty
+
+// --- Writer Thread ---
+// Writes everything between tail and head, in at most two contiguous pieces
+// (the ring wraps), then publishes the new tail to the producer.
+static int flushTelemetryRing(TelemetryLog* log) {
+    unsigned int head = platformAtomicLoad(&log->head);
+    unsigned int tail = log->tail;
+    if (head == tail) return 0;
+    FILE* out = (FILE*)log->file;
+    while (tail != head) {
+        unsigned int start = tail & TELEMETRY_RING_MASK;
+        unsigned int count = head - tail;
+        if (count > TELEMETRY_RING_RECORDS - start) count = TELEMETRY_RING_RECORDS - start;
+        if (!log->write_failed && fwrite(&log->ring[start], sizeof(TelemetryRecord), count, out) != count) {
+            log->write_failed = 1;
+        }
+        if (!log->write_failed) log->written += count;
+        tail += count;
+    }
+    platformAtomicStore(&log->tail, tail);
+    return 1;
+}
+
+static void telemetryWriterMain(void* arg) {
+    TelemetryLog* log = (TelemetryLog*)arg;
+    for (;;) {
+        int stopping = platformAtomicLoad(&log->stopping);
+        if (!flushTelemetryRing(log)) {
+            if (stopping) break; // Drained after the stop request
+            sleepPlatformMs(TELEMETRY_WRITER_SLEEP_MS);
+        }
+    }
+}
+
+// --- Log Lifetime ---
+static void fillTelemetryHeader(TelemetryFileHeader* header, int tickRate) {
+    memset(header, 0, sizeof(*header));
+    header->magic = TELEMETRY_FILE_MAGIC;
+    header->version = TELEMETRY_FILE_VERSION;
+    header->record_size = sizeof(TelemetryRecord);
+    header->tick_rate = tickRate;
+}
+
+int openTelemetryLog(TelemetryLog* log, const char* path, int tickRate) {
+    memset(log, 0, sizeof(*log));
+    log->ring = (TelemetryRecord*)malloc(sizeof(TelemetryRecord) * TELEMETRY_RING_RECORDS);
+    FILE* out = fopen(path, "wb");
+    if (!log->ring || !out) {
+        fprintf(stderr, "Telemetry '%s': could not open\n", path);
+        free(log->ring);
+        if (out) fclose(out);
+        memset(log, 0, sizeof(*log));
+        return 0;
+    }
+
+    // Header with zero counts; rewritten by closeTelemetryLog
+    TelemetryFileHeader header;
+    fillTelemetryHeader(&header, tickRate);
+    log->tick_rate = tickRate;
+    if (fwrite(&header, sizeof(header), 1, out) != 1) log->write_failed = 1;
+    log->file = out;
+
+    if (!startPlatformThread(&log->writer, telemetryWriterMain, log)) {
+        fprintf(stderr, "Telemetry '%s': could not start the writer thread\n", path);
+        fclose(out);
+        free(log->ring);
+        memset(log, 0, sizeof(*log));
+        return 0;
+    }
+    log->open = 1;
+    return 1;
+}
+
+void logTelemetry(TelemetryLog* log, const TelemetryRecord* record) {
+    if (!log->open) return;
+    unsigned int head = log->head;
+    if (head - platformAtomicLoad(&log->tail) >= TELEMETRY_RING_RECORDS) {
+        log->dropped++; // Writer is a whole ring behind
+        return;
+    }
+    log->ring[head & TELEMETRY_RING_MASK] = *record;
+    platformAtomicStore(&log->head, head + 1); // Publish after the record is complete
+}
+
+void closeTelemetryLog(TelemetryLog* log) {
+    if (!log->open) return;
+    platformAtomicStore(&log->stopping, 1);
+    joinPlatformThread(&log->writer);
+
+    // Rewrite the header with the counts now that the writer is done with the file
+    FILE* out = (FILE*)log->file;
+    TelemetryFileHeader header;
+    fillTelemetryHeader(&header, log->tick_rate);
+    header.record_count = log->written;
+    header.dropped_count = log->dropped;
+    int ok = !log->write_failed;
+    if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1) ok = 0;
+    if (fclose(out) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Telemetry: write failed, the log is incomplete\n");
+    if (log->dropped > 0) fprintf(stderr, "Telemetry: %llu records dropped (writer fell behind)\n", log->dropped);
+
+    free(log->ring);
+    memset(log, 0, sizeof(*log));
+}
+
+// --- Records ---
+void makeTelemetryRecord(TelemetryRecord* record, const SimContext* sim, unsigned char controls, int events) {
+    memset(record, 0, sizeof(*record));
+    record->tick = (unsigned int)sim->ticks;
+    record->x = sim->car.x;
+    record->z = sim->car.z;
+    record->angle = sim->car.angle;
+    record->speed = sim->car.speed;
+    record->controls = controls;
+    record->events = (unsigned char)events;
+    record->track = (unsigned char)sim->track.type;
+    record->lap_time_ms = (events & RACE_EVENT_LAP_COMPLETED) ? sim->last_lap_time_ms : sim->current_lap_time_ms;
+}
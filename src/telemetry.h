@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "sim.h"      // SimContext, RACE_EVENT_*
+#include "platform.h" // PlatformThread
+
+// --- Telemetry Log ---
+// Per-tick record of the player's car streamed to a binary file. The tick
+// loop only copies a record into a lock-free single-producer/single-consumer
+// ring buffer; a background thread writes the buffer to disk, so file I/O
+// never stalls a physics tick. If the writer falls behind by a whole buffer,
+// new records are dropped (and counted) rather than blocking the tick.
+//
+// File layout: TelemetryFileHeader, then record_count TelemetryRecords.
+// The header counts are filled in when the log is closed.
+
+#define TELEMETRY_FILE_MAGIC 0x4C543146u // "F1TL" read as a little-endian uint32
+#define TELEMETRY_FILE_VERSION 1
+#define TELEMETRY_RING_RECORDS 65536    // Ring capacity (power of two): ~4.5 minutes at 240 Hz
+
+// Extra event bit (the low bits are the RACE_EVENT_* bits from updateRace)
+#define TELEMETRY_EVENT_RACE_START 0x80 // First tick of a new race (tick counter restarts)
+
+typedef struct {
+    unsigned int tick;      // Tick number within the race
+    float x, z;             // Car position
+    float angle;            // Heading in degrees
+    float speed;
+    unsigned char controls; // CAR_CONTROL_* bits applied on this tick
+    unsigned char events;   // RACE_EVENT_* bits | TELEMETRY_EVENT_*
+    unsigned char track;    // TrackType
+    unsigned char reserved;
+    int lap_time_ms;        // Current lap time, or the finished lap's time on RACE_EVENT_LAP_COMPLETED
+} TelemetryRecord;
+
+typedef struct {
+    unsigned int magic;            // TELEMETRY_FILE_MAGIC
+    unsigned int version;          // TELEMETRY_FILE_VERSION
+    unsigned int record_size;      // sizeof(TelemetryRecord)
+    int tick_rate;                 // Physics ticks per second
+    unsigned long long record_count;   // Records in the file
+    unsigned long long dropped_count;  // Records lost because the ring was full
+} TelemetryFileHeader;
+
+typedef struct {
+    TelemetryRecord* ring;
+    unsigned int head;          // Next slot the producer writes (only the tick thread stores it)
+    unsigned int tail;          // Next slot the writer reads (only the writer thread stores it)
+    int stopping;               // Set by closeTelemetryLog; the writer drains and exits
+    unsigned long long written, dropped;
+    int write_failed;           // Set by the writer if the file could not be written
+    void* file;                 // FILE*, owned by the writer thread while running
+    int tick_rate;
+    PlatformThread writer;
+    int open;
+} TelemetryLog;
+
+int openTelemetryLog(TelemetryLog* log, const char* path, int tickRate); // Returns 1 on success
+void logTelemetry(TelemetryLog* log, const TelemetryRecord* record);     // Never blocks (drops if full)
+void closeTelemetryLog(TelemetryLog* log); // Flushes everything, finalizes the header, joins the writer
+
+// Fills a record from the race's state after an updateRace tick.
+void makeTelemetryRecord(TelemetryRecord* record, const SimContext* sim, unsigned char controls, int events);
+
+#endif // TELEMETRY_H
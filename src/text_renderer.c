@@ -0,0 +1,265 @@
+#include "text_renderer.h"
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Byte offset into the bound buffer, as the pointer argument GL expects
+#define BUFFER_OFFSET(bytes) ((const GLvoid*)(size_t)(bytes))
+
+#define TEXT_FIRST_CHAR 32  // Space
+#define TEXT_LAST_CHAR 126  // '~'
+#define TEXT_CHAR_COUNT (TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1)
+#define GLYPH_PAD 2         // Pixels kept round each glyph's advance for overhanging strokes
+#define STRING_VERTICES (TEXT_MAX_LENGTH * 4)
+
+// --- Atlas ---
+// A glyph's quad relative to the pen position on the baseline, in pixels,
+// and where it lies in the atlas.
+typedef struct {
+    short x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+    short advance;
+} Glyph;
+
+typedef struct {
+    float x, y;
+    float u, v;
+    unsigned char r, g, b, a;
+} TextVertex;
+
+// One string of the frame, as drawn last time into its slot of the vertex buffer
+typedef struct {
+    TextFont font;
+    int x, y;
+    unsigned char color[3];
+    int length;
+    char text[TEXT_MAX_LENGTH + 1];
+} TextString;
+
+static int atlasTried = 0;   // Set once the atlas has been made or has failed for good
+static GLuint atlasTexture = 0;
+static GLuint vertexBuffer = 0; // 0 when drawing from client memory
+static Glyph glyphs[TEXT_FONT_COUNT][TEXT_CHAR_COUNT];
+static TextVertex textVertices[TEXT_MAX_STRINGS * STRING_VERTICES];
+static TextString textStrings[TEXT_MAX_STRINGS];
+static int cachedStrings = 0;   // Slots whose TextString matches their vertices
+static int frameStrings = 0;    // Strings drawn from the atlas this frame
+static int dirtyFirst, dirtyLast; // Slots rebuilt this frame (to upload)
+static TextRenderStats textStats;     // Counted during the frame
+static TextRenderStats lastTextStats; // The previous frame's, for the profiler panel
+
+static void* getFont(TextFont font) {
+    switch (font) {
+        case TEXT_FONT_TITLE: return GLUT_BITMAP_TIMES_ROMAN_24;
+        case TEXT_FONT_SMALL: return GLUT_BITMAP_9_BY_15;
+        default: return GLUT_BITMAP_HELVETICA_18;
+    }
+}
+
+// Draws every glyph once into the bottom left of the back buffer, white on
+// black, and copies that area to the atlas texture. Glyph cells are packed in
+// rows; each cell keeps room below the baseline for descenders.
+static int buildAtlas() {
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
+    gluOrtho2D(0, TEXT_ATLAS_WIDTH, 0, TEXT_ATLAS_HEIGHT);
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+    glViewport(0, 0, TEXT_ATLAS_WIDTH, TEXT_ATLAS_HEIGHT);
+    glDisable(GL_DEPTH_TEST); glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D); glDisable(GL_FOG);
+    glDisable(GL_BLEND); glDisable(GL_ALPHA_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    int fits = 1;
+    int cellX = 0, rowY = 0, cellHeight = 0;
+    for (int f = 0; f < TEXT_FONT_COUNT && fits; ++f) {
+        void* font = getFont((TextFont)f);
+        int height = glutBitmapHeight(font);
+        int descent = height / 3 + 1;
+        if (cellX > 0) { rowY += cellHeight; cellX = 0; } // Each font starts a new row
+        cellHeight = height + descent;
+        for (int c = 0; c < TEXT_CHAR_COUNT; ++c) {
+            int advance = glutBitmapWidth(font, TEXT_FIRST_CHAR + c);
+            int cellWidth = advance + 2 * GLYPH_PAD;
+            if (cellX + cellWidth > TEXT_ATLAS_WIDTH) { cellX = 0; rowY += cellHeight; }
+            if (rowY + cellHeight > TEXT_ATLAS_HEIGHT) { fits = 0; break; }
+            glRasterPos2i(cellX + GLYPH_PAD, rowY + descent);
+            glutBitmapCharacter(font, TEXT_FIRST_CHAR + c);
+
+            Glyph* g = &glyphs[f][c];
+            g->x0 = -GLYPH_PAD;
+            g->x1 = (short)(advance + GLYPH_PAD);
+            g->y0 = (short)-descent;
+            g->y1 = (short)height;
+            g->u0 = (float)cellX / TEXT_ATLAS_WIDTH;
+            g->u1 = (float)(cellX + cellWidth) / TEXT_ATLAS_WIDTH;
+            g->v0 = (float)rowY / TEXT_ATLAS_HEIGHT;
+            g->v1 = (float)(rowY + cellHeight) / TEXT_ATLAS_HEIGHT;
+            g->advance = (short)advance;
+            cellX += cellWidth;
+        }
+    }
+
+    if (fits) {
+        // Intensity: the texel's value is both its colour and its alpha
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_INTENSITY, 0, 0, TEXT_ATLAS_WIDTH, TEXT_ATLAS_HEIGHT, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glMatrixMode(GL_PROJECTION); glPopMatrix();
+    glMatrixMode(GL_MODELVIEW); glPopMatrix();
+    glPopAttrib();
+    return fits;
+}
+
+void prepareTextRenderer() {
+    if (atlasTried) return;
+    // The atlas is copied from the window, so wait until it is big enough.
+    if (glutGet(GLUT_WINDOW_WIDTH) < TEXT_ATLAS_WIDTH || glutGet(GLUT_WINDOW_HEIGHT) < TEXT_ATLAS_HEIGHT) return;
+    atlasTried = 1;
+    if (!buildAtlas()) {
+        fprintf(stderr, "Text atlas does not fit in %dx%d, drawing bitmap text\n", TEXT_ATLAS_WIDTH, TEXT_ATLAS_HEIGHT);
+        return;
+    }
+    if (GLEW_VERSION_1_5) {
+        glGenBuffers(1, &vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(textVertices), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    cachedStrings = 0;
+    textStats.atlas = 1;
+}
+
+void freeTextRenderer() {
+    if (atlasTexture) glDeleteTextures(1, &atlasTexture);
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    atlasTexture = vertexBuffer = 0;
+    cachedStrings = frameStrings = 0;
+    atlasTried = 0;
+    memset(&textStats, 0, sizeof(textStats));
+    memset(&lastTextStats, 0, sizeof(lastTextStats));
+}
+
+void getTextRenderStats(TextRenderStats* stats) {
+    *stats = lastTextStats;
+}
+
+
+// --- Strings ---
+void beginText() {
+    lastTextStats = textStats;
+    frameStrings = 0;
+    dirtyFirst = TEXT_MAX_STRINGS;
+    dirtyLast = -1;
+    textStats.strings = textStats.rebuilt = 0;
+}
+
+// Fills slot i's quads from its TextString; unused quads collapse to nothing.
+static void buildString(int i) {
+    const TextString* s = &textStrings[i];
+    TextVertex* v = &textVertices[i * STRING_VERTICES];
+    memset(v, 0, sizeof(TextVertex) * STRING_VERTICES);
+    int penX = s->x;
+    for (int k = 0; k < s->length; ++k, v += 4) {
+        int c = (unsigned char)s->text[k];
+        if (c < TEXT_FIRST_CHAR || c > TEXT_LAST_CHAR) c = ' ';
+        const Glyph* g = &glyphs[s->font][c - TEXT_FIRST_CHAR];
+        float x0 = (float)(penX + g->x0), x1 = (float)(penX + g->x1);
+        float y0 = (float)(s->y + g->y0), y1 = (float)(s->y + g->y1);
+        v[0].x = x0; v[0].y = y0; v[0].u = g->u0; v[0].v = g->v0;
+        v[1].x = x1; v[1].y = y0; v[1].u = g->u1; v[1].v = g->v0;
+        v[2].x = x1; v[2].y = y1; v[2].u = g->u1; v[2].v = g->v1;
+        v[3].x = x0; v[3].y = y1; v[3].u = g->u0; v[3].v = g->v1;
+        for (int corner = 0; corner < 4; ++corner) {
+            v[corner].r = s->color[0];
+            v[corner].g = s->color[1];
+            v[corner].b = s->color[2];
+            v[corner].a = 255;
+        }
+        penX += g->advance;
+    }
+}
+
+void drawText(TextFont font, int x, int y, const float color[3], const char* text) {
+    textStats.strings++;
+    int length = (int)strlen(text);
+    if (!textStats.atlas || frameStrings >= TEXT_MAX_STRINGS || length > TEXT_MAX_LENGTH) {
+        glColor3fv(color);
+        glRasterPos2i(x, y);
+        for (const char* c = text; *c != '\0'; c++) glutBitmapCharacter(getFont(font), *c);
+        return;
+    }
+
+    int i = frameStrings++;
+    TextString* s = &textStrings[i];
+    unsigned char rgb[3];
+    for (int k = 0; k < 3; ++k) {
+        float c = (color[k] < 0.0f) ? 0.0f : (color[k] > 1.0f) ? 1.0f : color[k];
+        rgb[k] = (unsigned char)(c * 255.0f + 0.5f);
+    }
+    if (i < cachedStrings && s->font == font && s->x == x && s->y == y && memcmp(s->color, rgb, 3) == 0 &&
+        s->length == length && memcmp(s->text, text, (size_t)length) == 0) {
+        return; // Same as last time: the quads in the buffer are still right
+    }
+
+    s->font = font;
+    s->x = x;
+    s->y = y;
+    memcpy(s->color, rgb, 3);
+    s->length = length;
+    memcpy(s->text, text, (size_t)length);
+    s->text[length] = '\0';
+    buildString(i);
+    if (i >= cachedStrings) cachedStrings = i + 1;
+    if (i < dirtyFirst) dirtyFirst = i;
+    if (i > dirtyLast) dirtyLast = i;
+    textStats.rebuilt++;
+}
+
+void endText() {
+    if (!textStats.atlas || frameStrings == 0) return;
+
+    if (vertexBuffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        if (dirtyLast >= dirtyFirst) {
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(sizeof(TextVertex) * STRING_VERTICES * dirtyFirst),
+                            (GLsizeiptr)(sizeof(TextVertex) * STRING_VERTICES * (dirtyLast - dirtyFirst + 1)),
+                            &textVertices[dirtyFirst * STRING_VERTICES]);
+        }
+    }
+    const char* base = vertexBuffer ? (const char*)BUFFER_OFFSET(0) : (const char*)textVertices;
+
+    // Glyph texels are either lit or not, so the alpha test gives the same
+    // pixels as the bitmap fonts without blending.
+    glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.5f);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), base + offsetof(TextVertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), base + offsetof(TextVertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), base + offsetof(TextVertex, r));
+    glDrawArrays(GL_QUADS, 0, frameStrings * STRING_VERTICES);
+
+    glPopClientAttrib();
+    glPopAttrib();
+    if (vertexBuffer) glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
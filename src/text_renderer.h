@@ -0,0 +1,48 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+// --- Cached Text Rendering ---
+// HUD and menu text drawn from a glyph atlas instead of glutBitmapCharacter.
+// The atlas is made once by drawing every printable character of the GLUT
+// bitmap fonts into the back buffer and copying it to a texture, so the text
+// looks exactly as before. Each string becomes textured quads in one vertex
+// buffer shared by the whole frame, drawn with a single call.
+//
+// Strings are matched to the previous frame's by the order they are drawn
+// in: a string whose text, font, position and colour are unchanged keeps its
+// quads, so only changing strings (e.g. the timer digits) are rebuilt and
+// uploaded. Until the atlas exists (or if it cannot be made) text is drawn
+// with glutBitmapCharacter as before.
+
+#define TEXT_ATLAS_WIDTH 256
+#define TEXT_ATLAS_HEIGHT 512
+#define TEXT_MAX_STRINGS 64   // Strings per frame from the atlas (any more are drawn as bitmaps)
+#define TEXT_MAX_LENGTH 48    // Characters per atlas string (longer ones are drawn as bitmaps)
+
+typedef enum {
+    TEXT_FONT_TITLE,  // GLUT_BITMAP_TIMES_ROMAN_24
+    TEXT_FONT_NORMAL, // GLUT_BITMAP_HELVETICA_18
+    TEXT_FONT_SMALL,  // GLUT_BITMAP_9_BY_15
+    TEXT_FONT_COUNT
+} TextFont;
+
+typedef struct {
+    int atlas;    // 1 once text is drawn from the atlas
+    int strings;  // Strings drawn last frame
+    int rebuilt;  // ... of which rebuilt because they changed
+} TextRenderStats;
+
+// Builds the atlas on the first call with a large enough window. Call at the
+// start of a frame, before the clear, as it draws into the back buffer.
+void prepareTextRenderer();
+void freeTextRenderer();
+
+// Text of one frame, drawn in a pixel projection (gluOrtho2D, origin bottom
+// left): beginText, then drawText for each string (x, y is the start of its
+// baseline), then endText to draw them.
+void beginText();
+void drawText(TextFont font, int x, int y, const float color[3], const char* text);
+void endText();
+void getTextRenderStats(TextRenderStats* stats);
+
+#endif // TEXT_RENDERER_H
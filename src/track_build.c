@@ -0,0 +1,327 @@
+#include "track_build.h"
+#include "track_mesh.h"  // Growable indexed mesh
+#include "track_rect.h" // COLLISION_EPSILON (same tolerance as the built-in tracks)
+#include "sim_math.h"  // M_PI
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SPLINE_STEPS 64          // Dense samples per spline span (before resampling by distance)
+#define LINE_WIDTH 0.25f         // Painted edge line width
+#define LINE_Y 0.01f             // Heights used by the built-in tracks to avoid z-fighting
+#define FINISH_Y 0.02f
+#define FINISH_THICKNESS 2.0f
+#define GROUND_Y -0.02f
+#define RAIL_HEIGHT 0.8f         // Guardrail size, as on the rounded track
+#define RAIL_THICKNESS 0.4f
+#define RAIL_MARGIN 0.15f
+
+// --- Centerline ---
+// Evaluates one component of a uniform Catmull-Rom span at t in [0, 1].
+static float catmullRom(float p0, float p1, float p2, float p3, float t) {
+    float t2 = t * t, t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+}
+
+// Samples the closed spline every 'spacing' units of arc length. Returns the
+// sample count (0 on failure); *out is malloc'd and *out_length receives the loop length.
+static int sampleCenterline(const TrackControlPoint* points, int count, float spacing,
+                            TrackSample** out, float* out_length) {
+    int dense_count = count * SPLINE_STEPS;
+    float* dx = (float*)malloc(sizeof(float) * (dense_count + 1));
+    float* dz = (float*)malloc(sizeof(float) * (dense_count + 1));
+    float* dw = (float*)malloc(sizeof(float) * (dense_count + 1));
+    float* dd = (float*)malloc(sizeof(float) * (dense_count + 1));
+    if (!dx || !dz || !dw || !dd) { free(dx); free(dz); free(dw); free(dd); return 0; }
+
+    // Dense pass: fine steps along each span, with the cumulative distance
+    for (int i = 0; i < count; ++i) {
+        const TrackControlPoint* p0 = &points[(i - 1 + count) % count];
+        const TrackControlPoint* p1 = &points[i];
+        const TrackControlPoint* p2 = &points[(i + 1) % count];
+        const TrackControlPoint* p3 = &points[(i + 2) % count];
+        for (int s = 0; s < SPLINE_STEPS; ++s) {
+            float t = (float)s / SPLINE_STEPS;
+            int k = i * SPLINE_STEPS + s;
+            dx[k] = catmullRom(p0->x, p1->x, p2->x, p3->x, t);
+            dz[k] = catmullRom(p0->z, p1->z, p2->z, p3->z, t);
+            dw[k] = p1->width + (p2->width - p1->width) * t; // Linear, so the width never overshoots
+        }
+    }
+    dx[dense_count] = dx[0]; dz[dense_count] = dz[0]; dw[dense_count] = dw[0]; // Close the loop
+    dd[0] = 0.0f;
+    for (int k = 1; k <= dense_count; ++k) {
+        float ex = dx[k] - dx[k - 1], ez = dz[k] - dz[k - 1];
+        dd[k] = dd[k - 1] + sqrtf(ex * ex + ez * ez);
+    }
+    float length = dd[dense_count];
+
+    // Resample at an even spacing that divides the loop length exactly
+    int n = (int)(length / spacing + 0.5f);
+    if (n < 3) n = 3;
+    TrackSample* samples = (TrackSample*)malloc(sizeof(TrackSample) * n);
+    if (!samples) { free(dx); free(dz); free(dw); free(dd); return 0; }
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+        float target = length * (float)i / (float)n;
+        while (k < dense_count - 1 && dd[k + 1] < target) k++;
+        float seg = dd[k + 1] - dd[k];
+        float t = (seg > 0.0f) ? (target - dd[k]) / seg : 0.0f;
+        samples[i].x = dx[k] + (dx[k + 1] - dx[k]) * t;
+        samples[i].z = dz[k] + (dz[k + 1] - dz[k]) * t;
+        samples[i].half_width = 0.5f * (dw[k] + (dw[k + 1] - dw[k]) * t);
+        samples[i].distance = target;
+    }
+
+    free(dx); free(dz); free(dw); free(dd);
+    *out = samples;
+    *out_length = length;
+    return n;
+}
+
+// Unit direction of travel at sample i (central difference around the loop).
+static void sampleTangent(const TrackSample* s, int n, int i, float* tx, float* tz) {
+    const TrackSample* prev = &s[(i - 1 + n) % n];
+    const TrackSample* next = &s[(i + 1) % n];
+    float x = next->x - prev->x, z = next->z - prev->z;
+    float len = sqrtf(x * x + z * z);
+    if (len < 1e-6f) { *tx = 0.0f; *tz = 1.0f; return; }
+    *tx = x / len; *tz = z / len;
+}
+
+
+// --- Render Mesh ---
+// Colours match the immediate-mode built-in tracks.
+void buildTrackMesh(TrackMesh* mesh, const TrackSample* s, int n, const TrackFileHeader* h) {
+    static const float grass[3] = { 0.2f, 0.6f, 0.2f };
+    static const float asphalt[3] = { 0.4f, 0.4f, 0.45f };
+    static const float line[3] = { 1.0f, 1.0f, 1.0f };
+    static const float finish[3] = { 0.9f, 0.9f, 0.9f };
+    static const float rail[3] = { 0.8f, 0.1f, 0.1f };
+
+    // Ground plane under the whole track
+    float gx = (h->max_x - h->min_x) * 0.2f + 20.0f, gz = (h->max_z - h->min_z) * 0.2f + 20.0f;
+    unsigned int g0 = addMeshVertex(mesh, h->min_x - gx, GROUND_Y, h->min_z - gz, grass);
+    unsigned int g1 = addMeshVertex(mesh, h->max_x + gx, GROUND_Y, h->min_z - gz, grass);
+    unsigned int g2 = addMeshVertex(mesh, h->max_x + gx, GROUND_Y, h->max_z + gz, grass);
+    unsigned int g3 = addMeshVertex(mesh, h->min_x - gx, GROUND_Y, h->max_z + gz, grass);
+    addMeshQuad(mesh, g0, g1, g2, g3, 0.0f, 1.0f, 0.0f);
+
+    // Per-sample rings. Side 0 is the left of the direction of travel, side 1 the right.
+    // Vertices per sample: road edges (2), edge lines (2 per side), rails (4 per side).
+    const int ring = 2 + 4 + 8;
+    unsigned int base = mesh->vertex_count;
+    for (int i = 0; i < n; ++i) {
+        float tx, tz;
+        sampleTangent(s, n, i, &tx, &tz);
+        float lx = -tz, lz = tx; // Left of the direction of travel (see calculateCarCorners)
+        float hw = s[i].half_width;
+        for (int side = 0; side < 2; ++side) {
+            float sx = side ? -lx : lx, sz = side ? -lz : lz;
+            addMeshVertex(mesh, s[i].x + sx * hw, 0.0f, s[i].z + sz * hw, asphalt);
+        }
+        for (int side = 0; side < 2; ++side) {
+            float sx = side ? -lx : lx, sz = side ? -lz : lz;
+            addMeshVertex(mesh, s[i].x + sx * (hw - LINE_WIDTH), LINE_Y, s[i].z + sz * (hw - LINE_WIDTH), line);
+            addMeshVertex(mesh, s[i].x + sx * hw, LINE_Y, s[i].z + sz * hw, line);
+        }
+        for (int side = 0; side < 2; ++side) {
+            float sx = side ? -lx : lx, sz = side ? -lz : lz;
+            float r0 = hw + RAIL_MARGIN, r1 = r0 + RAIL_THICKNESS;
+            addMeshVertex(mesh, s[i].x + sx * r0, 0.0f, s[i].z + sz * r0, rail);
+            addMeshVertex(mesh, s[i].x + sx * r0, RAIL_HEIGHT, s[i].z + sz * r0, rail);
+            addMeshVertex(mesh, s[i].x + sx * r1, RAIL_HEIGHT, s[i].z + sz * r1, rail);
+            addMeshVertex(mesh, s[i].x + sx * r1, 0.0f, s[i].z + sz * r1, rail);
+        }
+    }
+    if (mesh->failed) return;
+
+    for (int i = 0; i < n; ++i) {
+        unsigned int a = base + (unsigned int)(i * ring);
+        unsigned int b = base + (unsigned int)(((i + 1) % n) * ring);
+        float tx, tz;
+        sampleTangent(s, n, i, &tx, &tz);
+        float lx = -tz, lz = tx;
+
+        addMeshQuad(mesh, a + 0, a + 1, b + 1, b + 0, 0.0f, 1.0f, 0.0f); // Road surface
+        for (int side = 0; side < 2; ++side) {
+            unsigned int l = 2 + side * 2;
+            addMeshQuad(mesh, a + l, a + l + 1, b + l + 1, b + l, 0.0f, 1.0f, 0.0f); // Edge line
+        }
+        for (int side = 0; side < 2; ++side) {
+            unsigned int r = 6 + side * 4;
+            float sx = side ? -lx : lx, sz = side ? -lz : lz;
+            addMeshQuad(mesh, a + r + 0, a + r + 1, b + r + 1, b + r + 0, -sx, 0.0f, -sz); // Face towards the road
+            addMeshQuad(mesh, a + r + 1, a + r + 2, b + r + 2, b + r + 1, 0.0f, 1.0f, 0.0f); // Top
+            addMeshQuad(mesh, a + r + 2, a + r + 3, b + r + 3, b + r + 2, sx, 0.0f, sz);    // Outside face
+        }
+    }
+
+    // Finish line across the road at sample 0
+    float fx = h->finish_dir_x, fz = h->finish_dir_z;
+    float lx = -fz, lz = fx, hw = h->finish_half_width, ht = FINISH_THICKNESS / 2.0f;
+    unsigned int f0 = addMeshVertex(mesh, h->finish_x + lx * hw - fx * ht, FINISH_Y, h->finish_z + lz * hw - fz * ht, finish);
+    unsigned int f1 = addMeshVertex(mesh, h->finish_x - lx * hw - fx * ht, FINISH_Y, h->finish_z - lz * hw - fz * ht, finish);
+    unsigned int f2 = addMeshVertex(mesh, h->finish_x - lx * hw + fx * ht, FINISH_Y, h->finish_z - lz * hw + fz * ht, finish);
+    unsigned int f3 = addMeshVertex(mesh, h->finish_x + lx * hw + fx * ht, FINISH_Y, h->finish_z + lz * hw + fz * ht, finish);
+    addMeshQuad(mesh, f0, f1, f2, f3, 0.0f, 1.0f, 0.0f);
+}
+
+
+// --- Collision Grid ---
+// Marks every grid sample within (half width + COLLISION_EPSILON) of the
+// centerline polyline, one segment at a time so the cost follows the road
+// area rather than the bounding box times the segment count.
+static void rasterizeRoad(unsigned char* onTrack, const TrackGrid* g, const TrackSample* s, int n) {
+    for (int i = 0; i < n; ++i) {
+        const TrackSample* a = &s[i];
+        const TrackSample* b = &s[(i + 1) % n];
+        float reach = fmaxf(a->half_width, b->half_width) + COLLISION_EPSILON;
+        int x0 = (int)floorf((fminf(a->x, b->x) - reach - g->min_x) * g->inv_cell_size);
+        int x1 = (int)ceilf((fmaxf(a->x, b->x) + reach - g->min_x) * g->inv_cell_size);
+        int z0 = (int)floorf((fminf(a->z, b->z) - reach - g->min_z) * g->inv_cell_size);
+        int z1 = (int)ceilf((fmaxf(a->z, b->z) + reach - g->min_z) * g->inv_cell_size);
+        if (x0 < 0) x0 = 0;
+        if (z0 < 0) z0 = 0;
+        if (x1 > g->width - 1) x1 = g->width - 1;
+        if (z1 > g->height - 1) z1 = g->height - 1;
+
+        float ex = b->x - a->x, ez = b->z - a->z;
+        float lenSq = ex * ex + ez * ez;
+        for (int z = z0; z <= z1; ++z) {
+            float pz = g->min_z + z * g->cell_size;
+            for (int x = x0; x <= x1; ++x) {
+                float px = g->min_x + x * g->cell_size;
+                float t = (lenSq > 0.0f) ? ((px - a->x) * ex + (pz - a->z) * ez) / lenSq : 0.0f;
+                t = fminf(1.0f, fmaxf(0.0f, t));
+                float qx = a->x + ex * t - px, qz = a->z + ez * t - pz;
+                float r = a->half_width + (b->half_width - a->half_width) * t + COLLISION_EPSILON;
+                if (qx * qx + qz * qz <= r * r) onTrack[(size_t)z * g->width + x] = 1;
+            }
+        }
+    }
+}
+
+
+// --- File Output ---
+static unsigned int alignOffset(size_t offset) {
+    return (unsigned int)((offset + 15) & ~(size_t)15);
+}
+
+static int writeSection(FILE* f, size_t* pos, unsigned int offset, const void* data, size_t size) {
+    static const unsigned char zeros[16] = { 0 };
+    if (fwrite(zeros, 1, offset - *pos, f) != offset - *pos) return 0; // Alignment padding
+    if (size && fwrite(data, 1, size, f) != size) return 0;
+    *pos = offset + size;
+    return 1;
+}
+
+int writeTrackFile(const char* path, const TrackBuildSettings* settings,
+                   const TrackControlPoint* points, int count, TrackFileHeader* summary) {
+    if (count < 3) { fprintf(stderr, "Track needs at least 3 control points\n"); return 0; }
+    float spacing = settings->sample_spacing > 0.0f ? settings->sample_spacing : TRACK_BUILD_DEFAULT_SPACING;
+    float cell = settings->cell_size > 0.0f ? settings->cell_size : TRACK_BUILD_DEFAULT_CELL_SIZE;
+
+    TrackSample* samples = NULL;
+    float length = 0.0f;
+    int n = sampleCenterline(points, count, spacing, &samples, &length);
+    if (!n) { fprintf(stderr, "Out of memory sampling the centerline\n"); return 0; }
+
+    TrackFileHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = TRACK_FILE_MAGIC;
+    h.version = TRACK_FILE_VERSION;
+    memcpy(h.name, settings->name, TRACK_FILE_NAME_LENGTH - 1); // h is zeroed, so the name stays terminated
+    h.sample_count = (unsigned int)n;
+    h.length = length;
+
+    // Road bounds
+    h.min_x = h.min_z = 1e30f;
+    h.max_x = h.max_z = -1e30f;
+    for (int i = 0; i < n; ++i) {
+        float hw = samples[i].half_width;
+        h.min_x = fminf(h.min_x, samples[i].x - hw); h.max_x = fmaxf(h.max_x, samples[i].x + hw);
+        h.min_z = fminf(h.min_z, samples[i].z - hw); h.max_z = fmaxf(h.max_z, samples[i].z + hw);
+    }
+
+    // Start behind the finish line, facing along the track
+    int back = (int)(TRACK_BUILD_START_DISTANCE / (h.length / n) + 0.5f) % n;
+    int start = (n - back) % n;
+    float tx, tz;
+    sampleTangent(samples, n, start, &tx, &tz);
+    h.start_x = samples[start].x;
+    h.start_z = samples[start].z;
+    h.start_angle = (float)(atan2(tx, tz) * 180.0 / M_PI); // 0 = +Z, 90 = +X
+    sampleTangent(samples, n, 0, &h.finish_dir_x, &h.finish_dir_z);
+    h.finish_x = samples[0].x;
+    h.finish_z = samples[0].z;
+    h.finish_half_width = samples[0].half_width;
+
+    // Collision grid
+    TrackGrid grid;
+    memset(&grid, 0, sizeof(grid));
+    grid.min_x = h.min_x - TRACK_GRID_MARGIN;
+    grid.min_z = h.min_z - TRACK_GRID_MARGIN;
+    grid.cell_size = cell;
+    grid.inv_cell_size = 1.0f / cell;
+    grid.width = (int)ceilf((h.max_x + TRACK_GRID_MARGIN - grid.min_x) / cell) + 1;
+    grid.height = (int)ceilf((h.max_z + TRACK_GRID_MARGIN - grid.min_z) / cell) + 1;
+    unsigned char* onTrack = (unsigned char*)calloc((size_t)grid.width * grid.height, 1);
+    if (!onTrack) { free(samples); fprintf(stderr, "Out of memory for a %dx%d grid\n", grid.width, grid.height); return 0; }
+    rasterizeRoad(onTrack, &grid, samples, n);
+    int gridOk = buildTrackGridFromOccupancy(&grid, grid.min_x, grid.min_z, cell, grid.width, grid.height, onTrack);
+    free(onTrack);
+    if (!gridOk) { free(samples); fprintf(stderr, "Out of memory building the distance grid\n"); return 0; }
+    h.grid_min_x = grid.min_x;
+    h.grid_min_z = grid.min_z;
+    h.grid_cell_size = grid.cell_size;
+    h.grid_width = grid.width;
+    h.grid_height = grid.height;
+
+    // Render mesh
+    TrackMesh mesh;
+    initTrackMesh(&mesh);
+    buildTrackMesh(&mesh, samples, n, &h);
+    if (mesh.failed) {
+        fprintf(stderr, "Out of memory building the track mesh\n");
+        free(samples); freeTrackGrid(&grid); freeTrackMesh(&mesh);
+        return 0;
+    }
+    h.vertex_count = mesh.vertex_count;
+    h.index_count = mesh.index_count;
+
+    // Section layout
+    size_t gridBytes = sizeof(float) * (size_t)grid.width * grid.height;
+    h.samples_offset = alignOffset(sizeof(TrackFileHeader));
+    h.vertices_offset = alignOffset(h.samples_offset + sizeof(TrackSample) * (size_t)n);
+    h.indices_offset = alignOffset(h.vertices_offset + sizeof(TrackVertex) * (size_t)mesh.vertex_count);
+    h.grid_offset = alignOffset(h.indices_offset + sizeof(unsigned int) * (size_t)mesh.index_count);
+    if ((size_t)h.grid_offset + gridBytes > 0xFFFFFFF0u) {
+        fprintf(stderr, "Track file would exceed 4 GB, use a larger cell size\n");
+        free(samples); freeTrackGrid(&grid); freeTrackMesh(&mesh);
+        return 0;
+    }
+    h.file_size = (unsigned int)(h.grid_offset + gridBytes);
+
+    int ok = 0;
+    FILE* f = fopen(path, "wb");
+    if (f) {
+        size_t pos = 0;
+        ok = writeSection(f, &pos, 0, &h, sizeof(h)) &&
+             writeSection(f, &pos, h.samples_offset, samples, sizeof(TrackSample) * (size_t)n) &&
+             writeSection(f, &pos, h.vertices_offset, mesh.vertices, sizeof(TrackVertex) * (size_t)mesh.vertex_count) &&
+             writeSection(f, &pos, h.indices_offset, mesh.indices, sizeof(unsigned int) * (size_t)mesh.index_count) &&
+             writeSection(f, &pos, h.grid_offset, grid.distance, gridBytes);
+        ok = (fclose(f) == 0) && ok;
+    }
+    if (!ok) fprintf(stderr, "Could not write track file '%s'\n", path);
+    else if (summary) *summary = h;
+
+    free(samples);
+    freeTrackGrid(&grid);
+    freeTrackMesh(&mesh);
+    return ok;
+}
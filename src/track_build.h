@@ -0,0 +1,38 @@
+#ifndef TRACK_BUILD_H
+#define TRACK_BUILD_H
+
+#include "track_file.h" // TrackFileHeader, TRACK_FILE_NAME_LENGTH
+
+// --- Track Builder ---
+// Turns a list of control points into a binary track file (see track_file.h).
+// The centerline is a closed Catmull-Rom spline through the control points,
+// driven in point order; the first point is on the finish line. Used offline
+// by the trackgen tool so loading a track never rebuilds geometry.
+
+#define TRACK_BUILD_DEFAULT_SPACING 1.0f    // Centerline sample spacing (the autopilot assumes about 1 unit)
+#define TRACK_BUILD_DEFAULT_CELL_SIZE 0.25f // Collision grid cell size
+#define TRACK_BUILD_START_DISTANCE 20.0f    // Car start distance behind the finish line (as on the built-in tracks)
+
+typedef struct {
+    float x, z;   // Centerline position
+    float width;  // Full road width at this point
+} TrackControlPoint;
+
+typedef struct {
+    char name[TRACK_FILE_NAME_LENGTH]; // Display name
+    float sample_spacing;              // <= 0 uses TRACK_BUILD_DEFAULT_SPACING
+    float cell_size;                   // <= 0 uses TRACK_BUILD_DEFAULT_CELL_SIZE
+} TrackBuildSettings;
+
+// Builds the track and writes it to 'path'. If 'summary' is not NULL it receives
+// the written header. Returns 1 on success (prints the reason on failure).
+int writeTrackFile(const char* path, const TrackBuildSettings* settings,
+                   const TrackControlPoint* points, int count, TrackFileHeader* summary);
+
+// Builds the render mesh (ground, road, edge lines, guardrails, finish line)
+// along 'count' centerline samples, as stored in the file. The renderer also
+// calls this with every few samples of a loaded track for a coarse copy.
+struct TrackMesh;
+void buildTrackMesh(struct TrackMesh* mesh, const TrackSample* samples, int count, const TrackFileHeader* header);
+
+#endif // TRACK_BUILD_H
@@ -0,0 +1,45 @@
+// Track collision tests for both built-in tracks.
+// Kept apart from the track rendering files so the simulation library can be
+// built without OpenGL (see the 'headless' Makefile target).
+// The bounds are the precomputed RECT_COLLIDE_* / ROUND_COLLIDE_* constants so
+// these scalar tests and the SIMD kernels in corner_collision.c agree exactly.
+#include "track_rect.h"
+#include "track_round.h"
+#include <math.h>
+
+// --- Rectangular Collision Detection ---
+int isPositionOnRectTrack(float x, float z) {
+    // Check if outside the outer rectangle
+    if (x > RECT_COLLIDE_OUTER_X_POS || x < RECT_COLLIDE_OUTER_X_NEG ||
+        z > RECT_COLLIDE_OUTER_Z_POS || z < RECT_COLLIDE_OUTER_Z_NEG) return 0;
+    // Check if inside the inner hole rectangle
+    if (x < RECT_COLLIDE_INNER_X_POS && x > RECT_COLLIDE_INNER_X_NEG &&
+        z < RECT_COLLIDE_INNER_Z_POS && z > RECT_COLLIDE_INNER_Z_NEG) return 0;
+    // Otherwise, it's on the track
+    return 1;
+}
+
+
+// --- Rounded Collision Detection ---
+int isPositionOnRoundTrack(float x, float z) {
+    float absX = fabsf(x);
+    float absZ = fabsf(z);
+
+    // Check Straight Sections
+    if (absX <= ROUND_STRAIGHT_X_LIMIT) {
+         if (absZ >= ROUND_COLLIDE_Z_MIN && absZ <= ROUND_COLLIDE_Z_MAX) return 1;
+    }
+    if (absZ <= ROUND_STRAIGHT_Z_LIMIT) {
+         if (absX >= ROUND_COLLIDE_X_MIN && absX <= ROUND_COLLIDE_X_MAX) return 1;
+    }
+
+    // Check Corner Sections
+    // The four corner zones are mirror images, so work in the +X/+Z quadrant:
+    // the distance from the nearest corner center is (|x| - X limit, |z| - Z limit).
+    if (absX > ROUND_STRAIGHT_X_LIMIT && absZ > ROUND_STRAIGHT_Z_LIMIT) {
+        float dx = absX - ROUND_STRAIGHT_X_LIMIT; float dz = absZ - ROUND_STRAIGHT_Z_LIMIT;
+        float dist_sq = dx * dx + dz * dz;
+        if (dist_sq >= ROUND_COLLIDE_INNER_RADIUS_SQ && dist_sq <= ROUND_COLLIDE_OUTER_RADIUS_SQ) return 1;
+    }
+    return 0; // Off track
+}
@@ -0,0 +1,70 @@
+#include "track_file.h"
+#include <stdio.h>
+#include <string.h>
+
+// Checks that a section of 'count' items of 'item_size' bytes at 'offset' lies
+// inside the file and is aligned for float/uint access.
+static int isSectionValid(const PlatformFileMap* map, unsigned int offset, size_t count, size_t item_size) {
+    if (offset % 16 != 0 || offset < sizeof(TrackFileHeader) || offset > map->size) return 0;
+    return count <= (map->size - offset) / item_size;
+}
+
+// --- Loading ---
+int loadTrackFile(TrackData* track, const char* path) {
+    memset(track, 0, sizeof(*track));
+    if (!mapFileReadOnly(path, &track->map)) {
+        fprintf(stderr, "Track file '%s': could not open\n", path);
+        return 0;
+    }
+
+    const unsigned char* base = (const unsigned char*)track->map.data;
+    const TrackFileHeader* h = (const TrackFileHeader*)base;
+    const char* error = NULL;
+    if (track->map.size < sizeof(TrackFileHeader) || h->magic != TRACK_FILE_MAGIC) {
+        error = "not a track file";
+    } else if (h->version != TRACK_FILE_VERSION) {
+        error = "unsupported version";
+    } else if (h->file_size != track->map.size) {
+        error = "truncated";
+    } else if (h->sample_count < 3 || !isSectionValid(&track->map, h->samples_offset, h->sample_count, sizeof(TrackSample)) ||
+               !isSectionValid(&track->map, h->vertices_offset, h->vertex_count, sizeof(TrackVertex)) ||
+               !isSectionValid(&track->map, h->indices_offset, h->index_count, sizeof(unsigned int)) ||
+               h->grid_width < 2 || h->grid_height < 2 || !(h->grid_cell_size > 0.0f) ||
+               !isSectionValid(&track->map, h->grid_offset, (size_t)h->grid_width * h->grid_height, sizeof(float))) {
+        error = "bad section table";
+    }
+    if (error) {
+        fprintf(stderr, "Track file '%s': %s\n", path, error);
+        unmapFile(&track->map);
+        return 0;
+    }
+
+    // The renderer trusts the indices, so check them once here.
+    const unsigned int* indices = (const unsigned int*)(base + h->indices_offset);
+    for (unsigned int i = 0; i < h->index_count; ++i) {
+        if (indices[i] >= h->vertex_count) {
+            fprintf(stderr, "Track file '%s': mesh index out of range\n", path);
+            unmapFile(&track->map);
+            return 0;
+        }
+    }
+
+    track->header = h;
+    track->samples = (const TrackSample*)(base + h->samples_offset);
+    track->vertices = (const TrackVertex*)(base + h->vertices_offset);
+    track->indices = indices;
+
+    track->grid.min_x = h->grid_min_x;
+    track->grid.min_z = h->grid_min_z;
+    track->grid.cell_size = h->grid_cell_size;
+    track->grid.inv_cell_size = 1.0f / h->grid_cell_size;
+    track->grid.width = h->grid_width;
+    track->grid.height = h->grid_height;
+    track->grid.distance = (float*)(base + h->grid_offset); // Read-only mapping, only ever sampled
+    return 1;
+}
+
+void unloadTrackFile(TrackData* track) {
+    unmapFile(&track->map);
+    memset(track, 0, sizeof(*track));
+}
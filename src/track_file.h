@@ -0,0 +1,82 @@
+#ifndef TRACK_FILE_H
+#define TRACK_FILE_H
+
+#include "platform.h"   // PlatformFileMap
+#include "track_grid.h" // TrackGrid
+
+// --- Binary Track Files (.trk) ---
+// A track built offline by trackgen (see track_build.c) and loaded by mapping
+// the file read-only. Everything the game and the simulation need is stored
+// ready to use, so loading does no parsing or geometry work and every process
+// that loads the same file shares one copy of it:
+//   - the centerline, sampled at a fixed spacing in driving order, with the
+//     road half width at each sample (sample 0 sits on the finish line)
+//   - the finish line and the car start position
+//   - the render mesh (indexed triangles with per-vertex colour)
+//   - the signed distance grid used for collision (see track_grid.h)
+// Layout: TrackFileHeader, then each section at the byte offset given in the
+// header (16-byte aligned). Values are stored little-endian, as written by
+// the x86 machines that build and run this project.
+
+#define TRACK_FILE_MAGIC 0x4B543146u // "F1TK" read as a little-endian uint32
+#define TRACK_FILE_VERSION 1
+#define TRACK_FILE_NAME_LENGTH 32
+
+// One centerline sample
+typedef struct {
+    float x, z;        // Position on the centerline
+    float half_width;  // Half the road width here (without the collision tolerance)
+    float distance;    // Distance along the centerline from sample 0
+} TrackSample;
+
+// One render mesh vertex
+typedef struct {
+    float x, y, z;
+    float r, g, b;
+} TrackVertex;
+
+typedef struct {
+    unsigned int magic;            // TRACK_FILE_MAGIC
+    unsigned int version;          // TRACK_FILE_VERSION
+    unsigned int file_size;        // Total size in bytes (checked at load)
+    char name[TRACK_FILE_NAME_LENGTH]; // Display name, NUL terminated
+
+    // Centerline
+    unsigned int sample_count;
+    unsigned int samples_offset;   // TrackSample[sample_count]
+    float length;                  // Centerline length (closed loop)
+    float min_x, min_z, max_x, max_z; // Bounds of the road surface
+
+    // Start and finish. Crossing the line means moving along finish_dir_x/z
+    // within finish_half_width of the line's center.
+    float start_x, start_z, start_angle; // Car start (angle in degrees, car convention)
+    float finish_x, finish_z;
+    float finish_dir_x, finish_dir_z;
+    float finish_half_width;
+
+    // Render mesh (GL_TRIANGLES)
+    unsigned int vertex_count;
+    unsigned int vertices_offset;  // TrackVertex[vertex_count]
+    unsigned int index_count;
+    unsigned int indices_offset;   // unsigned int[index_count]
+
+    // Collision grid (see TrackGrid)
+    float grid_min_x, grid_min_z, grid_cell_size;
+    int grid_width, grid_height;
+    unsigned int grid_offset;      // float[grid_width * grid_height]
+} TrackFileHeader;
+
+// A loaded track. All pointers point into the read-only file mapping.
+typedef struct TrackData {
+    const TrackFileHeader* header;
+    const TrackSample* samples;
+    const TrackVertex* vertices;
+    const unsigned int* indices;
+    TrackGrid grid;                // distance points into the mapping (never written)
+    PlatformFileMap map;
+} TrackData;
+
+int loadTrackFile(TrackData* track, const char* path); // Returns 1 on success (prints the reason on failure)
+void unloadTrackFile(TrackData* track);
+
+#endif // TRACK_FILE_H
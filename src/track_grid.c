@@ -0,0 +1,196 @@
+#include "track_grid.h"
+#include "track_file.h"   // Grids of custom tracks live in the track file
+#include "track_rect.h"
+#include "track_round.h"
+#include "platform.h"     // runPlatformOnce for the shared grids
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define EDT_INF 1.0e20f
+
+// --- 1D Squared Euclidean Distance Transform ---
+// Felzenszwalb & Huttenlocher: d[q] = min over p of (q - p)^2 + f[p], in O(n).
+// v/zb are scratch arrays of n and n + 1 entries.
+static void distanceTransform1D(const float* f, float* d, int n, int* v, float* zb) {
+    int k = 0;
+    v[0] = 0;
+    zb[0] = -EDT_INF;
+    zb[1] = EDT_INF;
+    for (int q = 1; q < n; ++q) {
+        if (f[q] >= EDT_INF) continue; // No feature here, it can never be the nearest
+        if (f[v[k]] >= EDT_INF) { v[k] = q; continue; } // Replace an empty start
+        float s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        while (k > 0 && s <= zb[k]) {
+            k--;
+            s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        }
+        k++;
+        v[k] = q;
+        zb[k] = s;
+        zb[k + 1] = EDT_INF;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (zb[k + 1] < q) k++;
+        float dq = (float)(q - v[k]);
+        d[q] = (f[v[k]] >= EDT_INF) ? EDT_INF : dq * dq + f[v[k]];
+    }
+}
+
+// --- 2D Squared Distance Transform ---
+// field holds 0 at feature samples and EDT_INF elsewhere; on return it holds the
+// squared distance (in samples) to the nearest feature.
+static int distanceTransform2D(float* field, int width, int height) {
+    int n = (width > height) ? width : height;
+    float* f = (float*)calloc(n, sizeof(float));
+    float* d = (float*)malloc(sizeof(float) * n);
+    int* v = (int*)malloc(sizeof(int) * n);
+    float* zb = (float*)malloc(sizeof(float) * (n + 1));
+    if (!f || !d || !v || !zb) { free(f); free(d); free(v); free(zb); return 0; }
+
+    // Columns (along Z)
+    for (int x = 0; x < width; ++x) {
+        for (int z = 0; z < height; ++z) f[z] = field[z * width + x];
+        distanceTransform1D(f, d, height, v, zb);
+        for (int z = 0; z < height; ++z) field[z * width + x] = d[z];
+    }
+    // Rows (along X)
+    for (int z = 0; z < height; ++z) {
+        distanceTransform1D(field + z * width, d, width, v, zb);
+        memcpy(field + z * width, d, sizeof(float) * width);
+    }
+
+    free(f); free(d); free(v); free(zb);
+    return 1;
+}
+
+
+// --- Grid Construction ---
+int buildTrackGridFromOccupancy(TrackGrid* grid, float min_x, float min_z, float cell_size,
+                                int width, int height, const unsigned char* onTrack) {
+    memset(grid, 0, sizeof(*grid));
+    size_t count = (size_t)width * height;
+    float* inside = (float*)malloc(sizeof(float) * count);  // Distance from off-track samples to the track
+    float* outside = (float*)malloc(sizeof(float) * count); // Distance from on-track samples to the edge
+    if (!inside || !outside) { free(inside); free(outside); return 0; }
+
+    for (size_t i = 0; i < count; ++i) {
+        inside[i] = onTrack[i] ? 0.0f : EDT_INF;
+        outside[i] = onTrack[i] ? EDT_INF : 0.0f;
+    }
+    if (!distanceTransform2D(inside, width, height) || !distanceTransform2D(outside, width, height)) {
+        free(inside); free(outside);
+        return 0;
+    }
+
+    // Combine into a signed distance. The edge lies between an on-track and an
+    // off-track sample, so shift by half a cell to put zero on the edge.
+    float half = 0.5f * cell_size;
+    for (size_t i = 0; i < count; ++i) {
+        if (onTrack[i]) inside[i] = -(sqrtf(outside[i]) * cell_size - half);
+        else inside[i] = sqrtf(inside[i]) * cell_size - half;
+    }
+    free(outside);
+
+    grid->min_x = min_x;
+    grid->min_z = min_z;
+    grid->cell_size = cell_size;
+    grid->inv_cell_size = 1.0f / cell_size;
+    grid->width = width;
+    grid->height = height;
+    grid->distance = inside;
+    return 1;
+}
+
+int buildTrackGridFromTest(TrackGrid* grid, float min_x, float min_z, float max_x, float max_z,
+                           float cell_size, TrackPointTest test) {
+    if (cell_size <= 0.0f) cell_size = TRACK_GRID_DEFAULT_CELL_SIZE;
+    int width = (int)ceilf((max_x - min_x) / cell_size) + 1;
+    int height = (int)ceilf((max_z - min_z) / cell_size) + 1;
+
+    unsigned char* onTrack = (unsigned char*)malloc((size_t)width * height);
+    if (!onTrack) { memset(grid, 0, sizeof(*grid)); return 0; }
+
+    // Rasterize the occupancy at every sample point
+    for (int z = 0; z < height; ++z) {
+        float wz = min_z + z * cell_size;
+        for (int x = 0; x < width; ++x) {
+            onTrack[(size_t)z * width + x] = (unsigned char)(test(min_x + x * cell_size, wz) != 0);
+        }
+    }
+
+    int ok = buildTrackGridFromOccupancy(grid, min_x, min_z, cell_size, width, height, onTrack);
+    free(onTrack);
+    return ok;
+}
+
+int buildTrackGrid(TrackGrid* grid, TrackType track, float cell_size) {
+    if (track == TRACK_RECT) {
+        return buildTrackGridFromTest(grid,
+                                      RECT_COLLIDE_OUTER_X_NEG - TRACK_GRID_MARGIN, RECT_COLLIDE_OUTER_Z_NEG - TRACK_GRID_MARGIN,
+                                      RECT_COLLIDE_OUTER_X_POS + TRACK_GRID_MARGIN, RECT_COLLIDE_OUTER_Z_POS + TRACK_GRID_MARGIN,
+                                      cell_size, isPositionOnRectTrack);
+    } else { // TRACK_ROUNDED
+        return buildTrackGridFromTest(grid,
+                                      -ROUND_COLLIDE_X_MAX - TRACK_GRID_MARGIN, -ROUND_COLLIDE_Z_MAX - TRACK_GRID_MARGIN,
+                                      ROUND_COLLIDE_X_MAX + TRACK_GRID_MARGIN, ROUND_COLLIDE_Z_MAX + TRACK_GRID_MARGIN,
+                                      cell_size, isPositionOnRoundTrack);
+    }
+}
+
+void freeTrackGrid(TrackGrid* grid) {
+    free(grid->distance);
+    memset(grid, 0, sizeof(*grid));
+}
+
+
+// --- Queries ---
+float sampleTrackGrid(const TrackGrid* grid, float x, float z) {
+    float fx = (x - grid->min_x) * grid->inv_cell_size;
+    float fz = (z - grid->min_z) * grid->inv_cell_size;
+    // Points beyond the last sample are treated as far off the track
+    if (!(fx >= 0.0f && fz >= 0.0f && fx <= (float)(grid->width - 1) && fz <= (float)(grid->height - 1))) {
+        return TRACK_GRID_OUTSIDE;
+    }
+    int ix = (int)fx;
+    int iz = (int)fz;
+    if (ix > grid->width - 2) ix = grid->width - 2;
+    if (iz > grid->height - 2) iz = grid->height - 2;
+    float tx = fx - (float)ix;
+    float tz = fz - (float)iz;
+
+    const float* row0 = grid->distance + (size_t)iz * grid->width + ix;
+    const float* row1 = row0 + grid->width;
+    float top = row0[0] + (row0[1] - row0[0]) * tx;
+    float bottom = row1[0] + (row1[1] - row1[0]) * tx;
+    return top + (bottom - top) * tz;
+}
+
+void sampleTrackGridGradient(const TrackGrid* grid, float x, float z, float* gx, float* gz) {
+    float h = grid->cell_size;
+    *gx = (sampleTrackGrid(grid, x + h, z) - sampleTrackGrid(grid, x - h, z)) / (2.0f * h);
+    *gz = (sampleTrackGrid(grid, x, z + h) - sampleTrackGrid(grid, x, z - h)) / (2.0f * h);
+}
+
+int isPositionOnTrackGrid(const TrackGrid* grid, float x, float z) {
+    return sampleTrackGrid(grid, x, z) <= 0.0f;
+}
+
+
+// --- Shared Grids for the Built-in Tracks ---
+static TrackGrid builtInGrids[2];
+static int builtInGridReady[2]; // runPlatformOnce flags
+
+static int buildBuiltInGrid(void* arg) {
+    TrackType track = *(const TrackType*)arg;
+    return buildTrackGrid(&builtInGrids[track == TRACK_RECT ? 0 : 1], track, TRACK_GRID_DEFAULT_CELL_SIZE);
+}
+
+const TrackGrid* getTrackGrid(const SimTrack* track) {
+    if (track->type == TRACK_CUSTOM) return track->data ? &track->data->grid : NULL;
+    int i = (track->type == TRACK_RECT) ? 0 : 1;
+    TrackType type = track->type;
+    if (!runPlatformOnce(&builtInGridReady[i], buildBuiltInGrid, &type)) return NULL;
+    return &builtInGrids[i];
+}
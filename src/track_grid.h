@@ -0,0 +1,53 @@
+#ifndef TRACK_GRID_H
+#define TRACK_GRID_H
+
+#include "sim.h" // SimTrack
+
+// --- Track Distance Grid ---
+// A signed distance field sampled on a regular grid over the track's bounding
+// box. It is built once per track from any on-track test (so new track shapes
+// need no hand-written collision code) and answers queries with a bilinear
+// lookup whose cost does not depend on the track shape.
+// Distances are in world units: negative on the track, positive off it, and
+// roughly zero on the (tolerance-widened) track edge.
+typedef struct {
+    float min_x, min_z;   // World position of sample (0, 0)
+    float cell_size;      // Spacing between samples in world units
+    float inv_cell_size;
+    int width, height;    // Number of samples along X and Z
+    float* distance;      // width * height samples, row-major by Z
+} TrackGrid;
+
+#define TRACK_GRID_DEFAULT_CELL_SIZE 0.1f
+#define TRACK_GRID_MARGIN 2.0f      // Extra border around the track bounds
+#define TRACK_GRID_OUTSIDE 1.0e6f   // Distance reported for points outside the grid
+
+// Point test used to rasterize a track into a grid (returns 1 if on the track)
+typedef int (*TrackPointTest)(float x, float z);
+
+// Builds a grid from a rasterized occupancy mask (width * height samples, 1 = on
+// track, row-major by Z, sample (0, 0) at min_x/min_z). Returns 1 on success.
+int buildTrackGridFromOccupancy(TrackGrid* grid, float min_x, float min_z, float cell_size,
+                                int width, int height, const unsigned char* onTrack);
+// Builds a grid covering [min_x, max_x] x [min_z, max_z] from an on-track test. Returns 1 on success.
+int buildTrackGridFromTest(TrackGrid* grid, float min_x, float min_z, float max_x, float max_z,
+                           float cell_size, TrackPointTest test);
+// Builds a grid for one of the built-in tracks from its analytic collision test.
+int buildTrackGrid(TrackGrid* grid, TrackType track, float cell_size);
+void freeTrackGrid(TrackGrid* grid);
+
+// Bilinearly interpolated signed distance at (x, z).
+float sampleTrackGrid(const TrackGrid* grid, float x, float z);
+// Gradient of the distance field (points away from the track); not normalized.
+void sampleTrackGridGradient(const TrackGrid* grid, float x, float z, float* gx, float* gz);
+// On-track test using the grid (distance <= 0).
+int isPositionOnTrackGrid(const TrackGrid* grid, float x, float z);
+
+// --- Shared Grids for the Built-in Tracks ---
+// Returns the grid for a track, building it on first use (call at track load,
+// before the race starts ticking). Safe to call from several threads: one
+// builds it while the others wait. Returns NULL if it could not be allocated.
+// TRACK_CUSTOM returns the grid stored in the track's file (NULL if none).
+const TrackGrid* getTrackGrid(const SimTrack* track);
+
+#endif // TRACK_GRID_H
@@ -0,0 +1,120 @@
+#include "track_mesh.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void initTrackMesh(TrackMesh* mesh) {
+    memset(mesh, 0, sizeof(*mesh));
+}
+
+void freeTrackMesh(TrackMesh* mesh) {
+    free(mesh->vertices);
+    free(mesh->indices);
+    free(mesh->line_indices);
+    memset(mesh, 0, sizeof(*mesh));
+}
+
+// Makes room for 'extra' more entries in a growable index list.
+static int reserveIndices(TrackMesh* mesh, unsigned int** list, unsigned int count, unsigned int* capacity,
+                          unsigned int extra) {
+    if (mesh->failed) return 0;
+    if (count + extra <= *capacity) return 1;
+    unsigned int grown_capacity = *capacity ? *capacity * 2 : 4096;
+    unsigned int* grown = (unsigned int*)realloc(*list, sizeof(unsigned int) * grown_capacity);
+    if (!grown) { mesh->failed = 1; return 0; }
+    *list = grown;
+    *capacity = grown_capacity;
+    return 1;
+}
+
+// --- Primitives ---
+unsigned int addMeshVertex(TrackMesh* mesh, float x, float y, float z, const float color[3]) {
+    if (mesh->failed) return 0;
+    if (mesh->vertex_count == mesh->vertex_capacity) {
+        unsigned int capacity = mesh->vertex_capacity ? mesh->vertex_capacity * 2 : 1024;
+        TrackVertex* grown = (TrackVertex*)realloc(mesh->vertices, sizeof(TrackVertex) * capacity);
+        if (!grown) { mesh->failed = 1; return 0; }
+        mesh->vertices = grown;
+        mesh->vertex_capacity = capacity;
+    }
+    TrackVertex* v = &mesh->vertices[mesh->vertex_count];
+    v->x = x; v->y = y; v->z = z;
+    v->r = color[0]; v->g = color[1]; v->b = color[2];
+    return mesh->vertex_count++;
+}
+
+void addMeshTriangle(TrackMesh* mesh, unsigned int a, unsigned int b, unsigned int c,
+                     float nx, float ny, float nz) {
+    if (!reserveIndices(mesh, &mesh->indices, mesh->index_count, &mesh->index_capacity, 3)) return;
+    const TrackVertex* va = &mesh->vertices[a];
+    const TrackVertex* vb = &mesh->vertices[b];
+    const TrackVertex* vc = &mesh->vertices[c];
+    float ux = vb->x - va->x, uy = vb->y - va->y, uz = vb->z - va->z;
+    float wx = vc->x - va->x, wy = vc->y - va->y, wz = vc->z - va->z;
+    float cx = uy * wz - uz * wy, cy = uz * wx - ux * wz, cz = ux * wy - uy * wx;
+    int flip = (cx * nx + cy * ny + cz * nz) < 0.0f;
+    mesh->indices[mesh->index_count++] = a;
+    mesh->indices[mesh->index_count++] = flip ? c : b;
+    mesh->indices[mesh->index_count++] = flip ? b : c;
+}
+
+void addMeshQuad(TrackMesh* mesh, unsigned int a, unsigned int b, unsigned int c, unsigned int d,
+                 float nx, float ny, float nz) {
+    addMeshTriangle(mesh, a, b, c, nx, ny, nz);
+    addMeshTriangle(mesh, a, c, d, nx, ny, nz);
+}
+
+void addMeshLine(TrackMesh* mesh, unsigned int a, unsigned int b) {
+    if (!reserveIndices(mesh, &mesh->line_indices, mesh->line_index_count, &mesh->line_index_capacity, 2)) return;
+    mesh->line_indices[mesh->line_index_count++] = a;
+    mesh->line_indices[mesh->line_index_count++] = b;
+}
+
+// --- Shapes ---
+void addMeshFloorRect(TrackMesh* mesh, float x1, float z1, float x2, float z2, float y, const float color[3]) {
+    unsigned int a = addMeshVertex(mesh, x1, y, z1, color);
+    unsigned int b = addMeshVertex(mesh, x2, y, z1, color);
+    unsigned int c = addMeshVertex(mesh, x2, y, z2, color);
+    unsigned int d = addMeshVertex(mesh, x1, y, z2, color);
+    addMeshQuad(mesh, a, b, c, d, 0.0f, 1.0f, 0.0f);
+}
+
+// Same box as the old immediate-mode drawWallRect/drawWallRound helpers.
+void addMeshWall(TrackMesh* mesh, float x1, float z1, float x2, float z2,
+                 float height, float thickness, const float color[3]) {
+    float dx = x2 - x1, dz = z2 - z1;
+    float len = sqrtf(dx * dx + dz * dz);
+    if (len < 0.001f) return;
+    float nx = dx / len, nz = dz / len; // Along the wall
+    float px = -nz, pz = nx;            // Across the wall
+    float ht = thickness / 2.0f;
+
+    unsigned int v[8];
+    for (int top = 0; top < 2; ++top) {
+        float y = top ? height : 0.0f;
+        v[top * 4 + 0] = addMeshVertex(mesh, x1 - px * ht, y, z1 - pz * ht, color);
+        v[top * 4 + 1] = addMeshVertex(mesh, x1 + px * ht, y, z1 + pz * ht, color);
+        v[top * 4 + 2] = addMeshVertex(mesh, x2 + px * ht, y, z2 + pz * ht, color);
+        v[top * 4 + 3] = addMeshVertex(mesh, x2 - px * ht, y, z2 - pz * ht, color);
+    }
+    addMeshQuad(mesh, v[4], v[5], v[6], v[7], 0.0f, 1.0f, 0.0f); // Top
+    addMeshQuad(mesh, v[0], v[3], v[7], v[4], -px, 0.0f, -pz);   // Side
+    addMeshQuad(mesh, v[1], v[5], v[6], v[2], px, 0.0f, pz);     // Other side
+    addMeshQuad(mesh, v[0], v[4], v[5], v[1], -nx, 0.0f, -nz);   // Start end
+    addMeshQuad(mesh, v[3], v[2], v[6], v[7], nx, 0.0f, nz);     // Far end
+}
+
+void addMeshBox(TrackMesh* mesh, float cx, float cy, float cz, float sx, float sy, float sz, const float color[3]) {
+    // Corner i has +x if bit 0 is set, +y if bit 1, +z if bit 2
+    unsigned int v[8];
+    for (int i = 0; i < 8; ++i) {
+        v[i] = addMeshVertex(mesh, cx + ((i & 1) ? sx : -sx) * 0.5f, cy + ((i & 2) ? sy : -sy) * 0.5f,
+                             cz + ((i & 4) ? sz : -sz) * 0.5f, color);
+    }
+    addMeshQuad(mesh, v[0], v[2], v[6], v[4], -1.0f, 0.0f, 0.0f);
+    addMeshQuad(mesh, v[1], v[3], v[7], v[5], 1.0f, 0.0f, 0.0f);
+    addMeshQuad(mesh, v[0], v[1], v[5], v[4], 0.0f, -1.0f, 0.0f);
+    addMeshQuad(mesh, v[2], v[3], v[7], v[6], 0.0f, 1.0f, 0.0f);
+    addMeshQuad(mesh, v[0], v[1], v[3], v[2], 0.0f, 0.0f, -1.0f);
+    addMeshQuad(mesh, v[4], v[5], v[7], v[6], 0.0f, 0.0f, 1.0f);
+}
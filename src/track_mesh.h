@@ -0,0 +1,41 @@
+#ifndef TRACK_MESH_H
+#define TRACK_MESH_H
+
+#include "track_file.h" // TrackVertex
+
+// --- Track Mesh Builder ---
+// Growable indexed mesh used to build track geometry once (at track load or
+// in trackgen) instead of re-issuing it every frame. Triangles are wound so
+// the front face points along the normal passed in, matching
+// glFrontFace(GL_CCW) with back-face culling enabled. Lines are kept in a
+// separate index list for GL_LINES.
+typedef struct TrackMesh {
+    TrackVertex* vertices;
+    unsigned int vertex_count, vertex_capacity;
+    unsigned int* indices;            // GL_TRIANGLES
+    unsigned int index_count, index_capacity;
+    unsigned int* line_indices;       // GL_LINES
+    unsigned int line_index_count, line_index_capacity;
+    int failed;                       // Set if an allocation failed (later calls do nothing)
+} TrackMesh;
+
+void initTrackMesh(TrackMesh* mesh);
+void freeTrackMesh(TrackMesh* mesh);
+
+unsigned int addMeshVertex(TrackMesh* mesh, float x, float y, float z, const float color[3]);
+void addMeshTriangle(TrackMesh* mesh, unsigned int a, unsigned int b, unsigned int c,
+                     float nx, float ny, float nz);
+// Quad a-b-c-d (in order around its edge) facing along (nx, ny, nz)
+void addMeshQuad(TrackMesh* mesh, unsigned int a, unsigned int b, unsigned int c, unsigned int d,
+                 float nx, float ny, float nz);
+void addMeshLine(TrackMesh* mesh, unsigned int a, unsigned int b);
+
+// Flat quad at height y with corners (x1, z1) and (x2, z2), facing up
+void addMeshFloorRect(TrackMesh* mesh, float x1, float z1, float x2, float z2, float y, const float color[3]);
+// Wall box along (x1, z1)-(x2, z2): top and four sides, no bottom
+void addMeshWall(TrackMesh* mesh, float x1, float z1, float x2, float z2,
+                 float height, float thickness, const float color[3]);
+// Closed axis-aligned box centered on (cx, cy, cz) with full extents (sx, sy, sz)
+void addMeshBox(TrackMesh* mesh, float cx, float cy, float cz, float sx, float sy, float sz, const float color[3]);
+
+#endif // TRACK_MESH_H
@@ -0,0 +1,241 @@
+#include "track_progress.h"
+#include "driver.h"      // getCenterlineSamples
+#include "track_file.h"  // Finish line of custom tracks
+#include "track_rect.h"  // FINISH_LINE_Z
+#include "platform.h"    // runPlatformOnce for the shared coordinates
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGRESS_SEARCH_WINDOW 2 // Segments either side of the table's answer checked per query
+
+// --- Helpers ---
+// Squared distance from (x, z) to segment i; *s is the arc length (from point
+// 0) of the nearest point on it.
+static float projectOnSegment(const TrackProgress* p, int i, float x, float z, float* s) {
+    float ax = p->x[i], az = p->z[i];
+    float dx = p->x[i + 1] - ax, dz = p->z[i + 1] - az;
+    float t = ((x - ax) * dx + (z - az) * dz) * p->inv_length_sq[i];
+    t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t; // Not fminf/fmaxf: those are library calls here
+    float ox = ax + dx * t - x, oz = az + dz * t - z;
+    *s = p->distance[i] + (p->distance[i + 1] - p->distance[i]) * t;
+    return ox * ox + oz * oz;
+}
+
+// Arc length (from point 0) of the point nearest (x, z), searching segments
+// first .. last (wrapping once at either end).
+static float findNearestArcLength(const TrackProgress* p, int first, int last, float x, float z) {
+    float best = 1e30f, bestS = 0.0f;
+    for (int k = first; k <= last; ++k) {
+        int i = (k < 0) ? k + p->count : (k >= p->count) ? k - p->count : k;
+        float s;
+        float d = projectOnSegment(p, i, x, z, &s);
+        if (d < best) { best = d; bestS = s; }
+    }
+    return bestS;
+}
+
+static void getFinishLineCenter(const SimTrack* track, float* x, float* z) {
+    if (track->type == TRACK_CUSTOM) {
+        const TrackData* data = track->data;
+        *x = data ? data->header->finish_x : 0.0f;
+        *z = data ? data->header->finish_z : 0.0f;
+        return;
+    }
+    float xStart, xEnd;
+    getFinishLineXSpan(track->type, &xStart, &xEnd);
+    *x = (xStart + xEnd) * 0.5f;
+    *z = FINISH_LINE_Z;
+}
+
+
+// --- Building ---
+int buildTrackProgress(TrackProgress* progress, const SimTrack* track) {
+    memset(progress, 0, sizeof(*progress));
+    int n = getCenterlineSamples(track, NULL, NULL, 0);
+    if (n < 3) return 0;
+
+    // --- Table extent: the centerline's bounds plus the reach ---
+    float* xs = (float*)malloc((size_t)n * 2 * sizeof(float));
+    if (!xs) return 0;
+    float* zs = xs + n;
+    getCenterlineSamples(track, xs, zs, n);
+    float minX = xs[0], maxX = xs[0], minZ = zs[0], maxZ = zs[0];
+    for (int i = 1; i < n; ++i) {
+        minX = fminf(minX, xs[i]); maxX = fmaxf(maxX, xs[i]);
+        minZ = fminf(minZ, zs[i]); maxZ = fmaxf(maxZ, zs[i]);
+    }
+    minX -= TRACK_PROGRESS_REACH; minZ -= TRACK_PROGRESS_REACH;
+    maxX += TRACK_PROGRESS_REACH; maxZ += TRACK_PROGRESS_REACH;
+    float cellSize = TRACK_PROGRESS_CELL_SIZE;
+    int width, height;
+    for (;;) {
+        width = (int)ceilf((maxX - minX) / cellSize) + 1;
+        height = (int)ceilf((maxZ - minZ) / cellSize) + 1;
+        if ((long long)width * height <= TRACK_PROGRESS_MAX_CELLS) break;
+        cellSize *= 2.0f;
+    }
+
+    size_t cells = (size_t)width * height;
+    size_t total = (size_t)(n + 1) * 3 * sizeof(float) + (size_t)n * sizeof(float) + cells * sizeof(int);
+    unsigned char* block = (unsigned char*)malloc(total);
+    float* bestSq = (float*)malloc(cells * sizeof(float)); // Distance to the nearest segment found so far
+    if (!block || !bestSq) { free(block); free(bestSq); free(xs); return 0; }
+
+    unsigned char* q = block;
+    progress->x = (float*)q;            q += (size_t)(n + 1) * sizeof(float);
+    progress->z = (float*)q;            q += (size_t)(n + 1) * sizeof(float);
+    progress->distance = (float*)q;     q += (size_t)(n + 1) * sizeof(float);
+    progress->inv_length_sq = (float*)q; q += (size_t)n * sizeof(float);
+    progress->cell_segment = (int*)q;
+    memcpy(progress->x, xs, (size_t)n * sizeof(float));
+    memcpy(progress->z, zs, (size_t)n * sizeof(float));
+    progress->x[n] = xs[0]; // Closing point, so segment i always ends at point i + 1
+    progress->z[n] = zs[0];
+    free(xs);
+
+    progress->track = track->type;
+    progress->count = n;
+    progress->storage = block;
+    progress->min_x = minX;
+    progress->min_z = minZ;
+    progress->inv_cell_size = 1.0f / cellSize;
+    progress->width = width;
+    progress->height = height;
+
+    // --- Arc length ---
+    progress->distance[0] = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        float dx = progress->x[i + 1] - progress->x[i], dz = progress->z[i + 1] - progress->z[i];
+        float lengthSq = dx * dx + dz * dz;
+        progress->inv_length_sq[i] = (lengthSq > 0.0f) ? 1.0f / lengthSq : 0.0f;
+        progress->distance[i + 1] = progress->distance[i] + sqrtf(lengthSq);
+    }
+    progress->length = progress->distance[n];
+
+    // --- Nearest-segment table ---
+    // Each segment stamps itself into the cells within reach of it, so the
+    // cost grows with the track's length rather than its area times its length.
+    for (size_t c = 0; c < cells; ++c) {
+        progress->cell_segment[c] = -1;
+        bestSq[c] = 1e30f;
+    }
+    for (int i = 0; i < n; ++i) {
+        float lo_x = fminf(progress->x[i], progress->x[i + 1]) - TRACK_PROGRESS_REACH;
+        float hi_x = fmaxf(progress->x[i], progress->x[i + 1]) + TRACK_PROGRESS_REACH;
+        float lo_z = fminf(progress->z[i], progress->z[i + 1]) - TRACK_PROGRESS_REACH;
+        float hi_z = fmaxf(progress->z[i], progress->z[i + 1]) + TRACK_PROGRESS_REACH;
+        int cx0 = (int)((lo_x - minX) / cellSize), cx1 = (int)((hi_x - minX) / cellSize);
+        int cz0 = (int)((lo_z - minZ) / cellSize), cz1 = (int)((hi_z - minZ) / cellSize);
+        if (cx0 < 0) cx0 = 0;
+        if (cz0 < 0) cz0 = 0;
+        if (cx1 > width - 1) cx1 = width - 1;
+        if (cz1 > height - 1) cz1 = height - 1;
+        for (int cz = cz0; cz <= cz1; ++cz) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                // Cell centers, so the answer is right for the middle of the cell
+                float s;
+                float d = projectOnSegment(progress, i, minX + (cx + 0.5f) * cellSize, minZ + (cz + 0.5f) * cellSize, &s);
+                size_t c = (size_t)cz * width + cx;
+                if (d < bestSq[c]) {
+                    bestSq[c] = d;
+                    progress->cell_segment[c] = i;
+                }
+            }
+        }
+    }
+    // Cells beyond the reach (e.g. the infield) take the nearest of their
+    // neighbours' segments, in one sweep each way, so no query falls back to
+    // a full search.
+    for (int pass = 0; pass < 2; ++pass) {
+        int step = pass ? -1 : 1;
+        for (int cz = pass ? height - 1 : 0; cz >= 0 && cz < height; cz += step) {
+            for (int cx = pass ? width - 1 : 0; cx >= 0 && cx < width; cx += step) {
+                size_t c = (size_t)cz * width + cx;
+                int neighbours[2] = { -1, -1 };
+                if (cx - step >= 0 && cx - step < width) neighbours[0] = progress->cell_segment[c - step];
+                if (cz - step >= 0 && cz - step < height) neighbours[1] = progress->cell_segment[c - (size_t)step * width];
+                for (int k = 0; k < 2; ++k) {
+                    if (neighbours[k] < 0 || neighbours[k] == progress->cell_segment[c]) continue;
+                    float s;
+                    float d = projectOnSegment(progress, neighbours[k], minX + (cx + 0.5f) * cellSize,
+                                               minZ + (cz + 0.5f) * cellSize, &s);
+                    if (d < bestSq[c]) {
+                        bestSq[c] = d;
+                        progress->cell_segment[c] = neighbours[k];
+                    }
+                }
+            }
+        }
+    }
+    free(bestSq);
+
+    // --- Finish line ---
+    float fx, fz;
+    getFinishLineCenter(track, &fx, &fz);
+    progress->finish = findNearestArcLength(progress, 0, n - 1, fx, fz);
+    return 1;
+}
+
+void freeTrackProgress(TrackProgress* progress) {
+    free(progress->storage);
+    memset(progress, 0, sizeof(*progress));
+}
+
+
+// --- Queries ---
+float sampleTrackProgress(const TrackProgress* progress, float x, float z) {
+    float fx = (x - progress->min_x) * progress->inv_cell_size;
+    float fz = (z - progress->min_z) * progress->inv_cell_size;
+    int cx = (fx > 0.0f) ? (int)fx : 0;
+    int cz = (fz > 0.0f) ? (int)fz : 0;
+    if (cx > progress->width - 1) cx = progress->width - 1;
+    if (cz > progress->height - 1) cz = progress->height - 1;
+    int segment = progress->cell_segment[(size_t)cz * progress->width + cx];
+
+    float s;
+    if (segment >= 0) {
+        s = findNearestArcLength(progress, segment - PROGRESS_SEARCH_WINDOW, segment + PROGRESS_SEARCH_WINDOW, x, z);
+    } else {
+        // Only if the table could not be filled
+        s = findNearestArcLength(progress, 0, progress->count - 1, x, z);
+    }
+    float d = s - progress->finish;
+    if (d < 0.0f) d += progress->length;
+    if (d >= progress->length) d -= progress->length;
+    return d;
+}
+
+void getTrackProgressPoint(const TrackProgress* progress, float distance, float* x, float* z) {
+    float s = fmodf(distance + progress->finish, progress->length);
+    if (s < 0.0f) s += progress->length;
+    // Last point with distance[i] <= s
+    int lo = 0, hi = progress->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (progress->distance[mid] <= s) lo = mid;
+        else hi = mid - 1;
+    }
+    int j = lo + 1;
+    float segment = progress->distance[lo + 1] - progress->distance[lo];
+    float t = (segment > 0.0f) ? (s - progress->distance[lo]) / segment : 0.0f;
+    *x = progress->x[lo] + (progress->x[j] - progress->x[lo]) * t;
+    *z = progress->z[lo] + (progress->z[j] - progress->z[lo]) * t;
+}
+
+
+// --- Shared Coordinates per Track ---
+static TrackProgress sharedProgress[SIM_TRACK_SLOTS]; // Indexed by getSimTrackSlot
+static int sharedProgressReady[SIM_TRACK_SLOTS];       // runPlatformOnce flags
+
+static int buildSharedProgress(void* arg) {
+    const SimTrack* track = (const SimTrack*)arg;
+    return buildTrackProgress(&sharedProgress[getSimTrackSlot(track)], track);
+}
+
+const TrackProgress* getTrackProgress(const SimTrack* track) {
+    int i = getSimTrackSlot(track);
+    if (i < 0 || i >= SIM_TRACK_SLOTS) return NULL;
+    if (!runPlatformOnce(&sharedProgressReady[i], buildSharedProgress, (void*)track)) return NULL;
+    return &sharedProgress[i];
+}
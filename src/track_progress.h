@@ -0,0 +1,53 @@
+#ifndef TRACK_PROGRESS_H
+#define TRACK_PROGRESS_H
+
+#include "sim.h" // SimTrack
+
+// --- Track Progress ---
+// Arc-length coordinates along a track's centerline: any point maps to the
+// distance driven from the finish line, 0 .. length. Built once per track from
+// the centerline samples (driver.c), together with a coarse lookup table that
+// gives the nearest centerline segment for every cell round the road, so a
+// query is one table read plus a projection onto three segments whatever the
+// track's size. Used for sector timing and by anything that needs to know how
+// far round the lap a car is.
+typedef struct {
+    TrackType track;
+    int count;            // Centerline points (segment i runs from point i to i + 1)
+    float length;         // Length of the closed centerline
+    float finish;         // Arc length of the finish line from point 0
+    float* x;             // count + 1 centerline points, the last repeating the first
+    float* z;
+    float* distance;      // Arc length of each point from point 0
+    float* inv_length_sq; // 1 / squared length of each segment
+
+    // Nearest-segment table
+    float min_x, min_z;   // World position of cell (0, 0)
+    float inv_cell_size;
+    int width, height;    // Cells along X and Z
+    int* cell_segment;    // Nearest segment per cell (exact within TRACK_PROGRESS_REACH of the centerline)
+    void* storage;
+} TrackProgress;
+
+#define TRACK_PROGRESS_CELL_SIZE 1.0f   // Lookup table cell edge in world units
+#define TRACK_PROGRESS_REACH 16.0f      // Distance from the centerline within which the table is exact
+#define TRACK_PROGRESS_MAX_CELLS (1 << 20) // Cells are made larger on tracks that would need more
+
+// Builds the coordinates for a track from its centerline. Returns 1 on success.
+int buildTrackProgress(TrackProgress* progress, const SimTrack* track);
+void freeTrackProgress(TrackProgress* progress);
+
+// Distance driven from the finish line to the centerline point nearest
+// (x, z), in [0, length).
+float sampleTrackProgress(const TrackProgress* progress, float x, float z);
+// Centerline point at a distance from the finish line (wrapped into the lap). O(log n).
+void getTrackProgressPoint(const TrackProgress* progress, float distance, float* x, float* z);
+
+// --- Shared Coordinates per Track ---
+// Returns the coordinates for a track (one table per built-in track and per
+// loaded track file), building them on first use (call at track load, before
+// the race starts ticking; safe from several threads, as with getTrackGrid).
+// Returns NULL if the track has no centerline (custom track with no file).
+const TrackProgress* getTrackProgress(const SimTrack* track);
+
+#endif // TRACK_PROGRESS_H
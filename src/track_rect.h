@@ -22,9 +22,20 @@
 #define FINISH_LINE_Z 0.0f
 #define COLLISION_EPSILON 0.2f
 
+// --- Collision Bounds ---
+// Track edges with the collision tolerance applied, precomputed for the collision tests.
+#define RECT_COLLIDE_OUTER_X_POS (RECT_OUTER_X_POS + COLLISION_EPSILON)
+#define RECT_COLLIDE_OUTER_X_NEG (RECT_OUTER_X_NEG - COLLISION_EPSILON)
+#define RECT_COLLIDE_OUTER_Z_POS (RECT_OUTER_Z_POS + COLLISION_EPSILON)
+#define RECT_COLLIDE_OUTER_Z_NEG (RECT_OUTER_Z_NEG - COLLISION_EPSILON)
+#define RECT_COLLIDE_INNER_X_POS (RECT_INNER_X_POS - COLLISION_EPSILON)
+#define RECT_COLLIDE_INNER_X_NEG (RECT_INNER_X_NEG + COLLISION_EPSILON)
+#define RECT_COLLIDE_INNER_Z_POS (RECT_INNER_Z_POS - COLLISION_EPSILON)
+#define RECT_COLLIDE_INNER_Z_NEG (RECT_INNER_Z_NEG + COLLISION_EPSILON)
+
 // --- Function Declarations ---
-void renderRectTrack();
-void renderRectGuardrails();
+struct TrackMesh;
+void buildRectTrackMesh(struct TrackMesh* mesh); // Surface, markings and guardrails (see track_mesh.h)
 int isPositionOnRectTrack(float x, float z);
 
 #endif // TRACK_RECT_H
\ No newline at end of file
@@ -0,0 +1,614 @@
+#include "track_renderer.h"
+#include "track_mesh.h"  // Mesh builder for the built-in tracks
+#include "track_file.h"  // Prebuilt mesh of custom tracks
+#include "track_build.h" // buildTrackMesh, for the coarse copy of custom tracks
+#include "track_rect.h"
+#include "track_round.h"
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Byte offset into the bound buffer, as the pointer argument GL expects
+#define BUFFER_OFFSET(bytes) ((const GLvoid*)(size_t)(bytes))
+
+#define TRACK_LOD_COUNT 2                                 // 0: full detail, 1: coarse
+#define TRACK_LOD_CORNER_SEGMENTS (CORNER_SEGMENTS / 4)  // Round track corners in the coarse mesh
+#define TRACK_LOD_MATCH_DISTANCE 1.0f                     // Furthest a primitive lies from the coarse one replacing it
+#define TILE_HIDDEN 0xFF                                  // tileView entry of a tile outside the frustum
+
+// --- Tiles ---
+typedef struct {
+    GLsizei first, count; // In indices from the start of the index data
+} IndexRange;
+
+typedef struct {
+    float min_x, min_y, min_z, max_x, max_y, max_z; // Bounds of the tile's geometry (both levels of detail)
+    IndexRange triangles[TRACK_LOD_COUNT];
+    IndexRange lines[TRACK_LOD_COUNT];
+} TrackTile;
+
+// One level of detail as built (before it is tiled)
+typedef struct {
+    const TrackVertex* vertices;
+    unsigned int vertex_count;
+    const unsigned int* indices;
+    unsigned int index_count;
+    const unsigned int* line_indices;
+    unsigned int line_index_count;
+} TrackLod;
+
+// --- Renderer State ---
+static int trackLoaded = 0;
+static GLuint vertexBuffer = 0;      // 0 when drawing from client memory
+static GLuint indexBuffer = 0;       // Triangle indices followed by line indices
+static TrackVertex* vertexData = NULL;  // Vertices of every level of detail (freed once uploaded)
+static unsigned int* indexData = NULL;  // Triangles, then lines; each by level of detail, then by tile
+static TrackTile* tiles = NULL;      // Tile 0 holds the primitives larger than a tile
+static unsigned char* tileView = NULL; // Per frame: level of detail to draw each tile with, or TILE_HIDDEN
+static int tileCount = 0;
+static int tilesX = 0, tilesZ = 0;
+static float tileMinX = 0.0f, tileMinZ = 0.0f;
+static GLsizei lineIndexStart = 0, lineIndexEnd = 0; // Line indices within indexData
+static TrackRenderStats renderStats;
+
+// --- Tiling ---
+static IndexRange* getTileRange(TrackTile* tile, int lod, int lines) {
+    return lines ? &tile->lines[lod] : &tile->triangles[lod];
+}
+
+typedef struct {
+    float min_x, min_y, min_z, max_x, max_y, max_z;
+} PrimitiveBounds;
+
+static void getPrimitiveBounds(const TrackVertex* vertices, const unsigned int* indices, int corners,
+                               PrimitiveBounds* b) {
+    const TrackVertex* v = &vertices[indices[0]];
+    b->min_x = b->max_x = v->x;
+    b->min_y = b->max_y = v->y;
+    b->min_z = b->max_z = v->z;
+    for (int k = 1; k < corners; ++k) {
+        v = &vertices[indices[k]];
+        if (v->x < b->min_x) b->min_x = v->x;
+        if (v->x > b->max_x) b->max_x = v->x;
+        if (v->y < b->min_y) b->min_y = v->y;
+        if (v->y > b->max_y) b->max_y = v->y;
+        if (v->z < b->min_z) b->min_z = v->z;
+        if (v->z > b->max_z) b->max_z = v->z;
+    }
+}
+
+static void mergeBounds(PrimitiveBounds* b, const PrimitiveBounds* other) {
+    if (other->min_x < b->min_x) b->min_x = other->min_x;
+    if (other->max_x > b->max_x) b->max_x = other->max_x;
+    if (other->min_y < b->min_y) b->min_y = other->min_y;
+    if (other->max_y > b->max_y) b->max_y = other->max_y;
+    if (other->min_z < b->min_z) b->min_z = other->min_z;
+    if (other->max_z > b->max_z) b->max_z = other->max_z;
+}
+
+// Grid cell holding a point, clamped to the grid.
+static void getTileCell(float x, float z, int* cx, int* cz) {
+    int ix = (int)((x - tileMinX) / TRACK_TILE_SIZE);
+    int iz = (int)((z - tileMinZ) / TRACK_TILE_SIZE);
+    *cx = (ix < 0) ? 0 : (ix > tilesX - 1) ? tilesX - 1 : ix;
+    *cz = (iz < 0) ? 0 : (iz > tilesZ - 1) ? tilesZ - 1 : iz;
+}
+
+// Tile for geometry with these bounds: by its center, or tile 0 if larger than a tile.
+static int getCenterTile(const PrimitiveBounds* b) {
+    if (b->max_x - b->min_x > TRACK_TILE_SIZE || b->max_z - b->min_z > TRACK_TILE_SIZE) return 0;
+    int cx, cz;
+    getTileCell((b->min_x + b->max_x) * 0.5f, (b->min_z + b->max_z) * 0.5f, &cx, &cz);
+    return 1 + cz * tilesX + cx;
+}
+
+// Whether triangles p and p + 1 are the two halves of an addMeshQuad.
+static int isQuadPair(const unsigned int* indices, unsigned int p, unsigned int primitives) {
+    const unsigned int* t = indices + (size_t)p * 3;
+    return p + 1 < primitives && t[3] == t[0] && t[4] == t[2];
+}
+
+// Tiles a mesh's primitives (triangles: corners 3, lines: corners 2) by their
+// center. The two triangles of a quad go into one tile together.
+static void tileByCenter(const TrackVertex* vertices, const unsigned int* indices, unsigned int primitives,
+                         int corners, int* tileOf) {
+    for (unsigned int p = 0; p < primitives; ++p) {
+        PrimitiveBounds b;
+        getPrimitiveBounds(vertices, indices + (size_t)p * corners, corners, &b);
+        if (corners == 3 && isQuadPair(indices, p, primitives)) {
+            PrimitiveBounds second;
+            getPrimitiveBounds(vertices, indices + (size_t)(p + 1) * 3, 3, &second);
+            mergeBounds(&b, &second);
+            tileOf[p] = tileOf[p + 1] = getCenterTile(&b);
+            ++p;
+        } else {
+            tileOf[p] = getCenterTile(&b);
+        }
+    }
+}
+
+static float dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+// Squared distance from a point to a segment or triangle (closest point as in
+// Ericson, Real-Time Collision Detection, 5.1.2 and 5.1.5).
+static float getPrimitiveDistanceSq(const TrackVertex* vertices, const unsigned int* indices, int corners,
+                                    const float p[3]) {
+    const TrackVertex* va = &vertices[indices[0]];
+    const TrackVertex* vb = &vertices[indices[1]];
+    float a[3] = { va->x, va->y, va->z };
+    float ab[3] = { vb->x - a[0], vb->y - a[1], vb->z - a[2] };
+    float ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+    float q[3];
+    if (corners == 2) {
+        float len = dot3(ab, ab);
+        float t = (len > 0.0f) ? dot3(ap, ab) / len : 0.0f;
+        t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+        for (int i = 0; i < 3; ++i) q[i] = a[i] + ab[i] * t;
+    } else {
+        const TrackVertex* vc = &vertices[indices[2]];
+        float b[3] = { vb->x, vb->y, vb->z }, c[3] = { vc->x, vc->y, vc->z };
+        float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+        float cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+        float d1 = dot3(ab, ap), d2 = dot3(ac, ap);
+        float d3 = dot3(ab, bp), d4 = dot3(ac, bp);
+        float d5 = dot3(ab, cp), d6 = dot3(ac, cp);
+        float vcw = d1 * d4 - d3 * d2, vbw = d5 * d2 - d1 * d6, vaw = d3 * d6 - d5 * d4;
+        float v, w;
+        if (d1 <= 0.0f && d2 <= 0.0f) { v = 0.0f; w = 0.0f; }                 // Vertex a
+        else if (d3 >= 0.0f && d4 <= d3) { v = 1.0f; w = 0.0f; }             // Vertex b
+        else if (d6 >= 0.0f && d5 <= d6) { v = 0.0f; w = 1.0f; }             // Vertex c
+        else if (vcw <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { v = d1 / (d1 - d3); w = 0.0f; } // Edge ab
+        else if (vbw <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { v = 0.0f; w = d2 / (d2 - d6); } // Edge ac
+        else if (vaw <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {        // Edge bc
+            w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            v = 1.0f - w;
+        } else {                                                             // Inside
+            float denom = 1.0f / (vaw + vbw + vcw);
+            v = vbw * denom;
+            w = vcw * denom;
+        }
+        for (int i = 0; i < 3; ++i) q[i] = a[i] + ab[i] * v + ac[i] * w;
+    }
+    float dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static int isSameColor(const TrackVertex* a, const TrackVertex* b) {
+    return a->r == b->r && a->g == b->g && a->b == b->b;
+}
+
+// Tiles the full-detail primitives by the coarse ones they are replaced by: each
+// goes into the tile of the nearest coarse primitive of its colour, so a tile's
+// two levels of detail cover the same stretch of track and neighbouring tiles
+// can draw different levels without gaps or overlaps between them. Primitives
+// with no coarse counterpart within TRACK_LOD_MATCH_DISTANCE are tiled by their
+// center. Returns 0 if out of memory.
+static int tileByCoarse(const TrackLod* fine, const TrackLod* coarse, int corners,
+                        const int* coarseTileOf, int* tileOf) {
+    int lines = (corners == 2);
+    const unsigned int* fineIndices = lines ? fine->line_indices : fine->indices;
+    const unsigned int* coarseIndices = lines ? coarse->line_indices : coarse->indices;
+    unsigned int finePrimitives = (lines ? fine->line_index_count : fine->index_count) / (unsigned int)corners;
+    unsigned int coarsePrimitives = (lines ? coarse->line_index_count : coarse->index_count) / (unsigned int)corners;
+    if (coarsePrimitives == 0) {
+        tileByCenter(fine->vertices, fineIndices, finePrimitives, corners, tileOf);
+        return 1;
+    }
+
+    // Bucket the coarse primitives by every grid cell their bounds (padded by
+    // the match distance) overlap.
+    int cells = tilesX * tilesZ;
+    int* cellRange = (int*)malloc((size_t)coarsePrimitives * 4 * sizeof(int)); // x0, z0, x1, z1 per primitive
+    int* cellStart = (int*)calloc((size_t)cells + 1, sizeof(int));
+    int* cellFill = (int*)calloc((size_t)cells, sizeof(int));
+    int* cellItems = NULL;
+    int ok = cellRange && cellStart && cellFill;
+    for (unsigned int p = 0; ok && p < coarsePrimitives; ++p) {
+        int* r = cellRange + (size_t)p * 4;
+        PrimitiveBounds b;
+        getPrimitiveBounds(coarse->vertices, coarseIndices + (size_t)p * corners, corners, &b);
+        getTileCell(b.min_x - TRACK_LOD_MATCH_DISTANCE, b.min_z - TRACK_LOD_MATCH_DISTANCE, &r[0], &r[1]);
+        getTileCell(b.max_x + TRACK_LOD_MATCH_DISTANCE, b.max_z + TRACK_LOD_MATCH_DISTANCE, &r[2], &r[3]);
+        for (int z = r[1]; z <= r[3]; ++z) {
+            for (int x = r[0]; x <= r[2]; ++x) cellStart[z * tilesX + x + 1]++;
+        }
+    }
+    if (ok) {
+        for (int c = 0; c < cells; ++c) cellStart[c + 1] += cellStart[c];
+        cellItems = (int*)malloc(((size_t)cellStart[cells] + 1) * sizeof(int));
+        ok = (cellItems != NULL);
+    }
+    for (unsigned int p = 0; ok && p < coarsePrimitives; ++p) {
+        const int* r = cellRange + (size_t)p * 4;
+        for (int z = r[1]; z <= r[3]; ++z) {
+            for (int x = r[0]; x <= r[2]; ++x) {
+                int c = z * tilesX + x;
+                cellItems[cellStart[c] + cellFill[c]++] = (int)p;
+            }
+        }
+    }
+    if (!ok) {
+        free(cellRange);
+        free(cellStart);
+        free(cellFill);
+        free(cellItems);
+        return 0;
+    }
+
+    for (unsigned int p = 0; p < finePrimitives; ++p) {
+        const unsigned int* prim = fineIndices + (size_t)p * corners;
+        float center[3] = { 0.0f, 0.0f, 0.0f };
+        for (int k = 0; k < corners; ++k) {
+            center[0] += fine->vertices[prim[k]].x / corners;
+            center[1] += fine->vertices[prim[k]].y / corners;
+            center[2] += fine->vertices[prim[k]].z / corners;
+        }
+        int cx, cz;
+        getTileCell(center[0], center[2], &cx, &cz);
+        int c = cz * tilesX + cx;
+        int best = -1;
+        float bestDistSq = TRACK_LOD_MATCH_DISTANCE * TRACK_LOD_MATCH_DISTANCE;
+        for (int i = cellStart[c]; i < cellStart[c + 1]; ++i) {
+            const unsigned int* other = coarseIndices + (size_t)cellItems[i] * corners;
+            if (!isSameColor(&fine->vertices[prim[0]], &coarse->vertices[other[0]])) continue;
+            float d = getPrimitiveDistanceSq(coarse->vertices, other, corners, center);
+            if (d <= bestDistSq) { bestDistSq = d; best = cellItems[i]; }
+        }
+        if (best >= 0) {
+            tileOf[p] = coarseTileOf[best];
+        } else {
+            PrimitiveBounds b;
+            getPrimitiveBounds(fine->vertices, prim, corners, &b);
+            tileOf[p] = getCenterTile(&b);
+        }
+    }
+    free(cellRange);
+    free(cellStart);
+    free(cellFill);
+    free(cellItems);
+    return 1;
+}
+
+// Appends one level of detail's triangles (corners 3) or lines (corners 2) to
+// indexData at *cursor grouped by tile (tileOf, one per primitive), offset by
+// vertexBase, and records each tile's range. Grows each tile's bounds to fit.
+static void appendByTile(const TrackVertex* vertices, const unsigned int* indices, unsigned int indexCount,
+                         int corners, const int* tileOf, unsigned int vertexBase, int lod, GLsizei* cursor) {
+    int lines = (corners == 2);
+    unsigned int primitives = indexCount / (unsigned int)corners;
+
+    for (int t = 0; t < tileCount; ++t) getTileRange(&tiles[t], lod, lines)->count = 0;
+    for (unsigned int p = 0; p < primitives; ++p) {
+        TrackTile* tile = &tiles[tileOf[p]];
+        PrimitiveBounds b;
+        getPrimitiveBounds(vertices, indices + (size_t)p * corners, corners, &b);
+        if (b.min_x < tile->min_x) tile->min_x = b.min_x;
+        if (b.max_x > tile->max_x) tile->max_x = b.max_x;
+        if (b.min_y < tile->min_y) tile->min_y = b.min_y;
+        if (b.max_y > tile->max_y) tile->max_y = b.max_y;
+        if (b.min_z < tile->min_z) tile->min_z = b.min_z;
+        if (b.max_z > tile->max_z) tile->max_z = b.max_z;
+        getTileRange(tile, lod, lines)->count += corners;
+    }
+    GLsizei next = *cursor;
+    for (int t = 0; t < tileCount; ++t) {
+        IndexRange* range = getTileRange(&tiles[t], lod, lines);
+        range->first = next;
+        next += range->count;
+        range->count = 0; // Refilled below
+    }
+    for (unsigned int p = 0; p < primitives; ++p) {
+        IndexRange* range = getTileRange(&tiles[tileOf[p]], lod, lines);
+        unsigned int* out = indexData + range->first + range->count;
+        for (int k = 0; k < corners; ++k) out[k] = indices[(size_t)p * corners + k] + vertexBase;
+        range->count += corners;
+    }
+    *cursor = next;
+}
+
+// Tiles and appends every level's triangles (corners 3) or lines (corners 2):
+// the coarse level by center, the full-detail level by the coarse primitives
+// it replaces. Returns 0 if out of memory.
+static int appendLods(const TrackLod* lods, int lodCount, int corners, const unsigned int* vertexBase,
+                      GLsizei* cursor) {
+    int lines = (corners == 2);
+    int* tileOf[TRACK_LOD_COUNT] = { NULL, NULL };
+    int ok = 1;
+    for (int l = 0; ok && l < lodCount; ++l) {
+        unsigned int count = lines ? lods[l].line_index_count : lods[l].index_count;
+        tileOf[l] = (int*)malloc(((size_t)count / corners + 1) * sizeof(int));
+        ok = (tileOf[l] != NULL);
+    }
+    if (ok && lodCount > 1) {
+        tileByCenter(lods[1].vertices, lines ? lods[1].line_indices : lods[1].indices,
+                     (lines ? lods[1].line_index_count : lods[1].index_count) / (unsigned int)corners,
+                     corners, tileOf[1]);
+        ok = tileByCoarse(&lods[0], &lods[1], corners, tileOf[1], tileOf[0]);
+    } else if (ok) {
+        tileByCenter(lods[0].vertices, lines ? lods[0].line_indices : lods[0].indices,
+                     (lines ? lods[0].line_index_count : lods[0].index_count) / (unsigned int)corners,
+                     corners, tileOf[0]);
+    }
+    for (int l = 0; ok && l < lodCount; ++l) {
+        appendByTile(lods[l].vertices, lines ? lods[l].line_indices : lods[l].indices,
+                     lines ? lods[l].line_index_count : lods[l].index_count,
+                     corners, tileOf[l], vertexBase[l], l, cursor);
+    }
+    for (int l = 0; l < TRACK_LOD_COUNT; ++l) free(tileOf[l]);
+    return ok;
+}
+
+// Sets up the tile grid over the bounds of the full-detail geometry.
+static int initTiles(const TrackLod* lod) {
+    float min_x = lod->vertices[0].x, max_x = min_x, min_z = lod->vertices[0].z, max_z = min_z;
+    for (unsigned int i = 1; i < lod->vertex_count; ++i) {
+        const TrackVertex* v = &lod->vertices[i];
+        if (v->x < min_x) min_x = v->x;
+        if (v->x > max_x) max_x = v->x;
+        if (v->z < min_z) min_z = v->z;
+        if (v->z > max_z) max_z = v->z;
+    }
+    tileMinX = min_x;
+    tileMinZ = min_z;
+    tilesX = (int)((max_x - min_x) / TRACK_TILE_SIZE) + 1;
+    tilesZ = (int)((max_z - min_z) / TRACK_TILE_SIZE) + 1;
+    tileCount = 1 + tilesX * tilesZ;
+    tiles = (TrackTile*)calloc((size_t)tileCount, sizeof(TrackTile));
+    tileView = (unsigned char*)malloc((size_t)tileCount);
+    if (!tiles || !tileView) return 0;
+    for (int t = 0; t < tileCount; ++t) {
+        tiles[t].min_x = tiles[t].min_y = tiles[t].min_z = 1e30f;
+        tiles[t].max_x = tiles[t].max_y = tiles[t].max_z = -1e30f;
+    }
+    return 1;
+}
+
+
+// --- Loading ---
+int loadTrackRenderer(const SimTrack* track) {
+    freeTrackRenderer();
+
+    // Gather the geometry: built now for the built-in tracks, read from the file
+    // for custom ones. Level 1 is the coarse copy (none for the rectangular
+    // track, which has no curves to simplify).
+    TrackMesh meshes[TRACK_LOD_COUNT];
+    TrackLod lods[TRACK_LOD_COUNT];
+    memset(lods, 0, sizeof(lods));
+    for (int l = 0; l < TRACK_LOD_COUNT; ++l) initTrackMesh(&meshes[l]);
+    if (track->type == TRACK_CUSTOM) {
+        const TrackData* data = track->data;
+        if (!data) return 0;
+        lods[0].vertices = data->vertices;
+        lods[0].vertex_count = data->header->vertex_count;
+        lods[0].indices = data->indices;
+        lods[0].index_count = data->header->index_count;
+        int n = (int)data->header->sample_count / TRACK_LOD_SAMPLE_STEP;
+        if (n >= 3) {
+            TrackSample* coarse = (TrackSample*)malloc((size_t)n * sizeof(TrackSample));
+            if (coarse) {
+                for (int i = 0; i < n; ++i) coarse[i] = data->samples[i * TRACK_LOD_SAMPLE_STEP];
+                buildTrackMesh(&meshes[1], coarse, n, data->header);
+                free(coarse);
+            } else {
+                meshes[1].failed = 1;
+            }
+        }
+    } else {
+        if (track->type == TRACK_RECT) {
+            buildRectTrackMesh(&meshes[0]);
+        } else {
+            buildRoundTrackMesh(&meshes[0], CORNER_SEGMENTS);
+            buildRoundTrackMesh(&meshes[1], TRACK_LOD_CORNER_SEGMENTS);
+        }
+    }
+    for (int l = 0; l < TRACK_LOD_COUNT; ++l) {
+        if (meshes[l].vertex_count == 0) continue;
+        lods[l].vertices = meshes[l].vertices;
+        lods[l].vertex_count = meshes[l].vertex_count;
+        lods[l].indices = meshes[l].indices;
+        lods[l].index_count = meshes[l].index_count;
+        lods[l].line_indices = meshes[l].line_indices;
+        lods[l].line_index_count = meshes[l].line_index_count;
+    }
+    int lodCount = (lods[1].vertex_count > 0) ? 2 : 1;
+
+    // Both levels go into one vertex array and one index array, the indices
+    // sorted into tiles.
+    unsigned int vertexCount = 0, indexCount = 0;
+    for (int l = 0; l < lodCount; ++l) {
+        vertexCount += lods[l].vertex_count;
+        indexCount += lods[l].index_count + lods[l].line_index_count;
+    }
+    int ok = !meshes[0].failed && !meshes[1].failed && lods[0].vertex_count > 0;
+    if (ok) {
+        vertexData = (TrackVertex*)malloc((size_t)vertexCount * sizeof(TrackVertex));
+        indexData = (unsigned int*)malloc(((size_t)indexCount + 1) * sizeof(unsigned int));
+        ok = vertexData && indexData && initTiles(&lods[0]);
+    }
+    GLsizei cursor = 0;
+    unsigned int vertexBase[TRACK_LOD_COUNT] = { 0, 0 };
+    for (int l = 0; ok && l < lodCount; ++l) {
+        vertexBase[l] = (l > 0) ? vertexBase[l - 1] + lods[l - 1].vertex_count : 0;
+        memcpy(vertexData + vertexBase[l], lods[l].vertices, (size_t)lods[l].vertex_count * sizeof(TrackVertex));
+    }
+    if (ok) ok = appendLods(lods, lodCount, 3, vertexBase, &cursor);
+    lineIndexStart = cursor;
+    if (ok) ok = appendLods(lods, lodCount, 2, vertexBase, &cursor);
+    lineIndexEnd = cursor;
+    unsigned int triangleCount = (unsigned int)lineIndexStart / 3, lineCount = (unsigned int)(lineIndexEnd - lineIndexStart) / 2;
+    for (int l = 0; l < TRACK_LOD_COUNT; ++l) freeTrackMesh(&meshes[l]);
+    if (!ok) {
+        fprintf(stderr, "Out of memory building the track mesh\n");
+        freeTrackRenderer();
+        return 0;
+    }
+    // Without a coarse copy every tile draws its full-detail geometry.
+    for (int t = 0; lodCount == 1 && t < tileCount; ++t) {
+        tiles[t].triangles[1] = tiles[t].triangles[0];
+        tiles[t].lines[1] = tiles[t].lines[0];
+    }
+    renderStats.tiles = 0;
+    for (int t = 0; t < tileCount; ++t) {
+        if (tiles[t].triangles[0].count > 0 || tiles[t].lines[0].count > 0) renderStats.tiles++;
+    }
+
+    // Upload to buffer objects when available (GL 1.5+). The client copies
+    // are then no longer needed.
+    if (GLEW_VERSION_1_5) {
+        glGenBuffers(1, &vertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)sizeof(TrackVertex) * vertexCount, vertexData, GL_STATIC_DRAW);
+        glGenBuffers(1, &indexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)sizeof(unsigned int) * cursor, indexData, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        free(vertexData);
+        free(indexData);
+        vertexData = NULL;
+        indexData = NULL;
+    }
+
+    trackLoaded = 1;
+    printf("Track geometry: %u vertices, %u triangles, %u lines over %d levels of detail in %d tiles (%s)\n",
+           vertexCount, triangleCount, lineCount, lodCount, renderStats.tiles,
+           vertexBuffer ? "vertex buffers" : "client arrays");
+    return 1;
+}
+
+void freeTrackRenderer() {
+    if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+    if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+    vertexBuffer = indexBuffer = 0;
+    free(vertexData);
+    free(indexData);
+    free(tiles);
+    free(tileView);
+    vertexData = NULL;
+    indexData = NULL;
+    tiles = NULL;
+    tileView = NULL;
+    tileCount = tilesX = tilesZ = 0;
+    lineIndexStart = lineIndexEnd = 0;
+    memset(&renderStats, 0, sizeof(renderStats));
+    trackLoaded = 0;
+}
+
+void getTrackRenderStats(TrackRenderStats* stats) {
+    *stats = renderStats;
+}
+
+
+// --- Culling ---
+// Clip planes (left, right, bottom, top, near, far) of projection * modelview,
+// facing inwards, and the camera position in world space.
+static void getViewFrustum(float planes[6][4], float eye[3]) {
+    GLfloat p[16], m[16], c[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, p);
+    glGetFloatv(GL_MODELVIEW_MATRIX, m);
+    for (int col = 0; col < 4; ++col) { // Column-major, as GL stores them
+        for (int row = 0; row < 4; ++row) {
+            c[col * 4 + row] = p[row] * m[col * 4] + p[4 + row] * m[col * 4 + 1] +
+                               p[8 + row] * m[col * 4 + 2] + p[12 + row] * m[col * 4 + 3];
+        }
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int j = 0; j < 4; ++j) {
+            planes[axis * 2][j] = c[j * 4 + 3] + c[j * 4 + axis];
+            planes[axis * 2 + 1][j] = c[j * 4 + 3] - c[j * 4 + axis];
+        }
+    }
+    // The modelview is a rotation and a translation (gluLookAt): eye = -R^T t
+    for (int i = 0; i < 3; ++i) eye[i] = -(m[i * 4] * m[12] + m[i * 4 + 1] * m[13] + m[i * 4 + 2] * m[14]);
+}
+
+static int isTileOutside(const TrackTile* tile, float planes[6][4]) {
+    for (int k = 0; k < 6; ++k) {
+        // Corner of the box furthest along the plane's normal
+        float x = (planes[k][0] > 0.0f) ? tile->max_x : tile->min_x;
+        float y = (planes[k][1] > 0.0f) ? tile->max_y : tile->min_y;
+        float z = (planes[k][2] > 0.0f) ? tile->max_z : tile->min_z;
+        if (planes[k][0] * x + planes[k][1] * y + planes[k][2] * z + planes[k][3] < 0.0f) return 1;
+    }
+    return 0;
+}
+
+static float getTileDistanceSq(const TrackTile* tile, const float eye[3]) {
+    float dx = (eye[0] < tile->min_x) ? tile->min_x - eye[0] : (eye[0] > tile->max_x) ? eye[0] - tile->max_x : 0.0f;
+    float dy = (eye[1] < tile->min_y) ? tile->min_y - eye[1] : (eye[1] > tile->max_y) ? eye[1] - tile->max_y : 0.0f;
+    float dz = (eye[2] < tile->min_z) ? tile->min_z - eye[2] : (eye[2] > tile->max_z) ? eye[2] - tile->max_z : 0.0f;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+
+// --- Drawing ---
+// Draws the visible tiles' triangles or lines, one call per run of tiles whose
+// ranges follow on from each other in the index data.
+static int drawVisibleTiles(GLenum mode, int lines) {
+    int calls = 0;
+    GLsizei first = 0, count = 0;
+    for (int t = 0; t <= tileCount; ++t) {
+        const IndexRange* range = NULL;
+        if (t < tileCount) {
+            if (tileView[t] == TILE_HIDDEN) continue;
+            range = getTileRange(&tiles[t], tileView[t], lines);
+            if (range->count == 0) continue;
+            if (count > 0 && range->first == first + count) { count += range->count; continue; }
+        }
+        if (count > 0) {
+            const GLvoid* offset = vertexBuffer ? BUFFER_OFFSET(sizeof(unsigned int) * (size_t)first)
+                                                : (const GLvoid*)(indexData + first);
+            glDrawElements(mode, count, GL_UNSIGNED_INT, offset);
+            ++calls;
+        }
+        if (range) { first = range->first; count = range->count; }
+    }
+    return calls;
+}
+
+void renderTrack() {
+    if (!trackLoaded) return;
+
+    // Pick each tile's level of detail, or hide it, for the current camera.
+    float planes[6][4], eye[3];
+    getViewFrustum(planes, eye);
+    renderStats.drawn = renderStats.coarse = 0;
+    for (int t = 0; t < tileCount; ++t) {
+        const TrackTile* tile = &tiles[t];
+        if (tile->max_x < tile->min_x || isTileOutside(tile, planes)) { tileView[t] = TILE_HIDDEN; continue; }
+        int coarse = getTileDistanceSq(tile, eye) > TRACK_LOD_DISTANCE * TRACK_LOD_DISTANCE;
+        tileView[t] = (unsigned char)coarse;
+        renderStats.drawn++;
+        renderStats.coarse += coarse;
+    }
+
+    // Vertex/colour pointers are offsets into the buffer, or plain pointers without one.
+    const char* vertexBase = vertexBuffer ? (const char*)BUFFER_OFFSET(0) : (const char*)vertexData;
+    if (vertexBuffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(TrackVertex), vertexBase + offsetof(TrackVertex, x));
+    glColorPointer(3, GL_FLOAT, sizeof(TrackVertex), vertexBase + offsetof(TrackVertex, r));
+
+    renderStats.draw_calls = drawVisibleTiles(GL_TRIANGLES, 0);
+    if (lineIndexEnd > lineIndexStart) {
+        glLineWidth(2.0f);
+        renderStats.draw_calls += drawVisibleTiles(GL_LINES, 1);
+        glLineWidth(1.0f); // Reset
+    }
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (vertexBuffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef TRACK_RENDERER_H
+#define TRACK_RENDERER_H
+
+#include "sim.h" // SimTrack
+
+// --- Retained-Mode Track Rendering ---
+// The track's geometry (surface, markings, finish line, guardrails) is built
+// once when a race starts and uploaded to vertex/index buffers. Falls back to
+// client side vertex arrays if the GL driver has no buffer objects (pre GL 1.5).
+//
+// Culling: at load the triangles and lines are grouped into square tiles of
+// TRACK_TILE_SIZE by their center, each tile's indices stored together with
+// its bounding box. Each frame only the tiles inside the view frustum of the
+// current projection and modelview matrices are drawn, adjacent tiles merged
+// into one draw call. Primitives larger than a tile (the ground plane, long
+// straight guardrails) go into one shared tile.
+//
+// Level of detail: a second, coarse copy of the track is built with fewer
+// corner segments (built-in round track) or every TRACK_LOD_SAMPLE_STEP'th
+// centerline sample (custom tracks). The coarse copy is tiled by center and
+// each full-detail primitive goes into the tile of the coarse one covering it,
+// so both levels of a tile cover the same stretch of road and neighbouring
+// tiles can differ without gaps. Tiles further than TRACK_LOD_DISTANCE from
+// the camera draw the coarse copy.
+
+#define TRACK_TILE_SIZE 16.0f     // Tile edge in world units
+#define TRACK_LOD_DISTANCE 60.0f  // Camera distance beyond which a tile uses the coarse mesh
+#define TRACK_LOD_SAMPLE_STEP 4   // Custom tracks: centerline samples per coarse mesh ring
+
+typedef struct {
+    int tiles;       // Tiles holding geometry
+    int drawn;       // Tiles inside the view last frame
+    int coarse;      // ... of which drawn with the coarse mesh
+    int draw_calls;  // glDrawElements calls last frame
+} TrackRenderStats;
+
+int loadTrackRenderer(const SimTrack* track); // Builds and uploads the geometry; returns 1 on success
+void renderTrack();                    // Draws the loaded track with the current matrices (does nothing if none)
+void freeTrackRenderer();              // Releases buffers and geometry
+void getTrackRenderStats(TrackRenderStats* stats);
+
+#endif // TRACK_RENDERER_H
@@ -1,11 +1,6 @@
 #ifndef TRACK_ROUND_H
 #define TRACK_ROUND_H
 
-// Define M_PI if not used elsewhere before this include
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 // --- Rounded Corner Track Dimensions ---
 #define ROUND_TRACK_MAIN_WIDTH 80.0f
 #define ROUND_TRACK_MAIN_LENGTH 120.0f
@@ -34,9 +29,23 @@
 #define FINISH_LINE_Z 0.0f
 #define COLLISION_EPSILON 0.2f
 
+// --- Collision Bounds ---
+// Straight and corner limits with the collision tolerance applied, precomputed for the collision tests.
+#define ROUND_COLLIDE_HALF_ROAD_WIDTH (ROUND_HALF_ROAD_WIDTH + COLLISION_EPSILON)
+#define ROUND_COLLIDE_Z_MIN (ROUND_TRACK_MAIN_LENGTH / 2.0f - ROUND_COLLIDE_HALF_ROAD_WIDTH) // |z| range of top/bottom straights
+#define ROUND_COLLIDE_Z_MAX (ROUND_TRACK_MAIN_LENGTH / 2.0f + ROUND_COLLIDE_HALF_ROAD_WIDTH)
+#define ROUND_COLLIDE_X_MIN (ROUND_TRACK_MAIN_WIDTH / 2.0f - ROUND_COLLIDE_HALF_ROAD_WIDTH)  // |x| range of left/right straights
+#define ROUND_COLLIDE_X_MAX (ROUND_TRACK_MAIN_WIDTH / 2.0f + ROUND_COLLIDE_HALF_ROAD_WIDTH)
+#define ROUND_COLLIDE_INNER_RADIUS ((ROUND_INNER_CORNER_RADIUS - COLLISION_EPSILON) > 0.0f ? (ROUND_INNER_CORNER_RADIUS - COLLISION_EPSILON) : 0.0f)
+#define ROUND_COLLIDE_OUTER_RADIUS (ROUND_OUTER_CORNER_RADIUS + COLLISION_EPSILON)
+#define ROUND_COLLIDE_INNER_RADIUS_SQ (ROUND_COLLIDE_INNER_RADIUS * ROUND_COLLIDE_INNER_RADIUS)
+#define ROUND_COLLIDE_OUTER_RADIUS_SQ (ROUND_COLLIDE_OUTER_RADIUS * ROUND_COLLIDE_OUTER_RADIUS)
+
 // --- Function Declarations ---
-void renderRoundTrack();
-void renderRoundGuardrails();
+struct TrackMesh;
+// Surface, markings and guardrails (see track_mesh.h), with corner_segments
+// segments per corner (CORNER_SEGMENTS for full detail)
+void buildRoundTrackMesh(struct TrackMesh* mesh, int corner_segments);
 int isPositionOnRoundTrack(float x, float z);
 
 #endif // TRACK_ROUND_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Track generator.
+// Reads a text track description and writes the binary track file that the
+// game and the headless runner load with --track / the Custom Circuit menu entry.
+//
+// Input format (one statement per line, '#' starts a comment):
+//   name <display name>       Track name shown in menus and reports
+//   spacing <units>           Centerline sample spacing (default 1.0)
+//   cell <units>              Collision grid cell size (default 0.25)
+//   point <x> <z> <width>     Centerline control point and road width there;
+//                             the first point is on the finish line and the
+//                             track is driven in point order
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "track_build.h"
+
+#define LINE_LENGTH 256
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s INPUT.txt OUTPUT.trk\n", prog);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "r");
+    if (!in) { fprintf(stderr, "Could not open '%s'\n", argv[1]); return 1; }
+
+    TrackBuildSettings settings;
+    memset(&settings, 0, sizeof(settings));
+    strncpy(settings.name, "Custom Circuit", TRACK_FILE_NAME_LENGTH - 1);
+    TrackControlPoint* points = NULL;
+    int count = 0, capacity = 0;
+
+    // --- Parse Input ---
+    char line[LINE_LENGTH];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char keyword[32];
+        int consumed = 0;
+        if (sscanf(line, "%31s %n", keyword, &consumed) != 1) continue; // Blank line
+
+        char* rest = line + consumed;
+        int ok = 1;
+        if (strcmp(keyword, "name") == 0) {
+            rest[strcspn(rest, "\r\n")] = '\0';
+            memset(settings.name, 0, sizeof(settings.name));
+            strncpy(settings.name, rest, TRACK_FILE_NAME_LENGTH - 1);
+        } else if (strcmp(keyword, "spacing") == 0) {
+            ok = (sscanf(rest, "%f", &settings.sample_spacing) == 1);
+        } else if (strcmp(keyword, "cell") == 0) {
+            ok = (sscanf(rest, "%f", &settings.cell_size) == 1);
+        } else if (strcmp(keyword, "point") == 0) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                TrackControlPoint* grown = (TrackControlPoint*)realloc(points, sizeof(TrackControlPoint) * capacity);
+                if (!grown) { fprintf(stderr, "Out of memory\n"); fclose(in); free(points); return 1; }
+                points = grown;
+            }
+            TrackControlPoint* p = &points[count];
+            ok = (sscanf(rest, "%f %f %f", &p->x, &p->z, &p->width) == 3 && p->width > 0.0f);
+            if (ok) count++;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%d: could not parse '%s'\n", argv[1], lineNumber, keyword);
+            fclose(in); free(points);
+            return 1;
+        }
+    }
+    fclose(in);
+
+    // --- Build and Write ---
+    TrackFileHeader summary;
+    int ok = writeTrackFile(argv[2], &settings, points, count, &summary);
+    free(points);
+    if (!ok) return 1;
+
+    printf("Wrote %s: \"%s\"\n", argv[2], summary.name);
+    printf("  Centerline: %.1f units, %u samples from %d control points\n", summary.length, summary.sample_count, count);
+    printf("  Mesh:       %u vertices, %u triangles\n", summary.vertex_count, summary.index_count / 3);
+    printf("  Grid:       %d x %d cells of %.2f units\n", summary.grid_width, summary.grid_height, summary.grid_cell_size);
+    printf("  File size:  %u bytes\n", summary.file_size);
+    return 0;
+}